@@ -0,0 +1,1689 @@
+#include "../headers/network/ConnectionPool.h"
+#include "../headers/network/DelimiterSearch.h"
+#include "../headers/network/FrameCodec.h"
+#include "../headers/network/IoContext.h"
+#include "../headers/network/SharedMemorySocket.h"
+#include "../headers/network/SocketTuning.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../headers/network/TCPSocket.h"
+#include "../headers/network/UDPSocket.h"
+#include "../headers/network/UnixDatagramSocket.h"
+#include "../headers/network/UnixStreamSocket.h"
+#include "../server_for_test/CoroutineServer.h"
+#include "../server_for_test/SimpleServer.h"
+#include "../server_for_test/UnixServer.h"
+#include "../server_for_test/SharedMemoryServer.h"
+#include "../needed_files/Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <ctime>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace NetworkBench {
+    const std::string loopback = "127.0.0.1";
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Result {
+        std::string name;
+        size_t completed;
+        size_t failed;
+        double seconds;
+    };
+
+    // Sections that could not set up their sockets or servers; main()
+    // exits non-zero when there are any
+    int setup_failures = 0;
+
+    void setupFailed(const std::string &what)
+    {
+        Utils::log("Bench: " + what + ", section skipped");
+        ++setup_failures;
+    }
+
+    void printResult(const Result &result)
+    {
+        double rate = result.seconds > 0 ? result.completed / result.seconds : 0.0;
+        std::cout << "[BENCH] " << result.name
+                  << ": completed=" << result.completed
+                  << " failed=" << result.failed
+                  << " seconds=" << result.seconds
+                  << " conn/s=" << rate << std::endl;
+    }
+
+    double threadCpuSeconds()
+    {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    // Nearest-rank percentile of an ascending sample
+    double percentile(const std::vector<double> &sorted, double fraction)
+    {
+        if (sorted.empty())
+            return 0.0;
+        size_t index = static_cast<size_t>(fraction * (sorted.size() - 1));
+        return sorted[index];
+    }
+
+    // One full request cycle the way the tests do it: connect, send, read echo
+    bool echoOnce(int port, const std::string &message, IoEngine engine = IoEngine::Syscall)
+    {
+        TCPSocket client(loopback, port);
+        client.setIoEngine(engine);
+        if (!client.open())
+            return false;
+        bool ok = client.send(message) && !client.receive().empty();
+        client.close();
+        return ok;
+    }
+
+    // Runs `clients` concurrent client threads doing `rounds` echo cycles each,
+    // while `slow_clients` extra connections stall `stall_ms` before sending.
+    Result runEchoLoad(const std::string &name, int port, int clients, int rounds,
+                       int slow_clients, int stall_ms, IoEngine engine = IoEngine::Syscall)
+    {
+        std::atomic<size_t> completed{0};
+        std::atomic<size_t> failed{0};
+        std::vector<std::thread> threads;
+
+        auto start = Clock::now();
+
+        for (int i = 0; i < slow_clients; ++i)
+        {
+            threads.emplace_back([&, port]() {
+                TCPSocket client(loopback, port);
+                if (!client.open())
+                {
+                    failed++;
+                    return;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(stall_ms));
+                bool ok = client.send("slow") && !client.receive().empty();
+                ok ? completed++ : failed++;
+            });
+        }
+
+        // Let the slow clients get accepted first, as they would under real load
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+        for (int i = 0; i < clients; ++i)
+        {
+            threads.emplace_back([&, port, i]() {
+                for (int r = 0; r < rounds; ++r)
+                {
+                    std::string message = "client " + std::to_string(i) + " round " + std::to_string(r);
+                    echoOnce(port, message, engine) ? completed++ : failed++;
+                }
+            });
+        }
+
+        for (auto &thread : threads)
+            thread.join();
+
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        return Result{name, completed.load(), failed.load(), elapsed.count()};
+    }
+}
+
+namespace ServerBench {
+    using namespace NetworkBench;
+
+    // The pre-reactor SimpleServer loop, kept here as the baseline:
+    // accept one connection, serve it synchronously, then accept the next.
+    class SerialEchoServer {
+    private:
+        int port_;
+        int server_fd_;
+        std::atomic<bool> running_;
+        std::thread server_thread_;
+
+        void serverLoop()
+        {
+            while (running_)
+            {
+                int client_fd = accept(server_fd_, nullptr, nullptr);
+                if (client_fd < 0)
+                    break;
+
+                char buffer[1024];
+                ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+                if (bytes_read > 0)
+                {
+                    std::string response = "Echo: " + std::string(buffer, bytes_read);
+                    send(client_fd, response.c_str(), response.length(), MSG_NOSIGNAL);
+                }
+                ::close(client_fd);
+            }
+        }
+
+    public:
+        explicit SerialEchoServer(int port) : port_(port), server_fd_(-1), running_(false) {}
+        ~SerialEchoServer() { stop(); }
+
+        bool start()
+        {
+            server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+            int opt = 1;
+            setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = INADDR_ANY;
+            address.sin_port = htons(port_);
+            if (bind(server_fd_, (sockaddr *)&address, sizeof(address)) < 0 ||
+                listen(server_fd_, 3) < 0)
+            {
+                ::close(server_fd_);
+                return false;
+            }
+
+            running_ = true;
+            server_thread_ = std::thread(&SerialEchoServer::serverLoop, this);
+            return true;
+        }
+
+        void stop()
+        {
+            if (!running_)
+                return;
+            running_ = false;
+            // Unblock accept()
+            shutdown(server_fd_, SHUT_RDWR);
+            server_thread_.join();
+            ::close(server_fd_);
+        }
+    };
+
+    void compareEventLoopWithSerial(int port, int clients, int rounds, int slow_clients, int stall_ms)
+    {
+        std::vector<Result> results;
+
+        {
+            SerialEchoServer server(port);
+            if (!server.start())
+            {
+                setupFailed("failed to start serial server");
+                return;
+            }
+            results.push_back(runEchoLoad("serial accept loop", port, clients, rounds,
+                                          slow_clients, stall_ms));
+        }
+
+        {
+            SimpleServer server(port + 1);
+            if (!server.start())
+            {
+                setupFailed("failed to start SimpleServer");
+                return;
+            }
+            results.push_back(runEchoLoad("epoll event loop", port + 1, clients, rounds,
+                                          slow_clients, stall_ms));
+
+            BufferPool::Stats pool = server.getBufferPoolStats();
+            std::cout << "receive buffer pool: " << pool.hits << " hits, " << pool.misses
+                      << " misses, " << pool.slabs << " slabs" << std::endl;
+            server.stop();
+        }
+
+        for (const auto &result : results)
+            printResult(result);
+    }
+}
+
+namespace IoEngineBench {
+    using namespace NetworkBench;
+
+    // Same echo load with both server and clients on each I/O engine
+    void compareIoEngines(int port, int clients, int rounds)
+    {
+        std::vector<Result> results;
+        const IoEngine engines[] = {IoEngine::Syscall, IoEngine::IoUring};
+        const char *names[] = {"syscall engine", "io_uring engine"};
+
+        for (int i = 0; i < 2; ++i)
+        {
+            SimpleServer server(port + i);
+            server.setIoEngine(engines[i]);
+            if (!server.start())
+            {
+                setupFailed("failed to start SimpleServer");
+                return;
+            }
+            results.push_back(runEchoLoad(names[i], port + i, clients, rounds, 0, 0, engines[i]));
+            server.stop();
+        }
+
+        for (const auto &result : results)
+            printResult(result);
+    }
+}
+
+namespace ScalingBench {
+    using namespace NetworkBench;
+
+    // Echo throughput of SimpleServer with 1..max_shards SO_REUSEPORT shards.
+    // The echo server answers one request per connection, so connections/s
+    // and requests/s coincide here.
+    void runShardScaling(int port, int max_shards, int clients, int rounds)
+    {
+        for (int shards = 1; shards <= max_shards; ++shards)
+        {
+            SimpleServer server(port + shards);
+            server.setShardCount(shards);
+            server.setCpuPinning(true);
+            if (!server.start())
+            {
+                setupFailed("failed to start sharded SimpleServer");
+                return;
+            }
+
+            Result result = runEchoLoad("shards=" + std::to_string(shards), port + shards,
+                                        clients, rounds, 0, 0);
+            server.stop();
+
+            double rate = result.seconds > 0 ? result.completed / result.seconds : 0.0;
+            std::cout << "[BENCH] scaling shards=" << shards
+                      << " completed=" << result.completed
+                      << " failed=" << result.failed
+                      << " conn/s=" << rate
+                      << " req/s=" << rate << std::endl;
+        }
+    }
+}
+
+namespace UdpBench {
+    using namespace NetworkBench;
+
+    // Echo packet rate of SimpleUDPServer. Each client fires bursts of
+    // `burst` datagrams and collects the echoes; in single-datagram mode
+    // both sides move one datagram per syscall, in batch mode both use
+    // sendmmsg/recvmmsg with batches of `burst`.
+    void compareBatchSizes(int port, int clients, int rounds, int burst)
+    {
+        const int batch_sizes[] = {1, burst};
+
+        for (int i = 0; i < 2; ++i)
+        {
+            const int batch = batch_sizes[i];
+            SimpleUDPServer server(port + i);
+            server.setBatchSize(batch);
+            if (!server.start())
+            {
+                setupFailed("failed to start SimpleUDPServer");
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+            std::atomic<size_t> echoed{0};
+            std::atomic<size_t> lost{0};
+            std::vector<std::thread> threads;
+            auto start = Clock::now();
+
+            for (int c = 0; c < clients; ++c)
+            {
+                threads.emplace_back([&, c]() {
+                    UDPSocket client(loopback, port + i);
+                    if (!client.open())
+                    {
+                        lost += static_cast<size_t>(rounds) * burst;
+                        return;
+                    }
+                    client.setReceiveTimeout(1);
+
+                    std::vector<std::string> messages;
+                    for (int m = 0; m < burst; ++m)
+                        messages.push_back("client " + std::to_string(c) + " datagram " + std::to_string(m));
+                    std::vector<char> replies(static_cast<size_t>(burst) * 1100);
+                    std::vector<UDPDatagram> out(burst), in(burst);
+                    for (int m = 0; m < burst; ++m)
+                    {
+                        out[m] = UDPDatagram{&messages[m][0], messages[m].size(), 0, {}};
+                        in[m] = UDPDatagram{&replies[m * 1100], 1100, 0, {}};
+                    }
+
+                    for (int r = 0; r < rounds; ++r)
+                    {
+                        int got = 0;
+                        if (batch == 1)
+                        {
+                            for (int m = 0; m < burst; ++m)
+                                client.send(messages[m]);
+                            while (got < burst && client.receive(in[0].data, in[0].size) > 0)
+                                ++got;
+                        }
+                        else
+                        {
+                            client.sendBatch(out.data(), burst);
+                            int n;
+                            while (got < burst && (n = client.receiveBatch(in.data(), burst - got)) > 0)
+                                got += n;
+                        }
+                        echoed += got;
+                        lost += burst - got;
+                    }
+                });
+            }
+
+            for (auto &thread : threads)
+                thread.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            server.stop();
+
+            double pps = elapsed.count() > 0 ? echoed / elapsed.count() : 0.0;
+            std::cout << "[BENCH] udp batch=" << batch
+                      << " echoed=" << echoed.load()
+                      << " lost=" << lost.load()
+                      << " seconds=" << elapsed.count()
+                      << " pps=" << pps << std::endl;
+        }
+    }
+}
+
+namespace GsoBench {
+    using namespace NetworkBench;
+
+    // Streams `packets` datagrams of `segment_size` bytes over loopback and
+    // reports sender and receiver CPU time per packet, first one datagram
+    // per syscall, then with UDP GSO on the sender and GRO on the receiver.
+    void compareSegmentation(int packets, uint16_t segment_size)
+    {
+        const char *names[] = {"per-datagram", "gso/gro"};
+        std::vector<char> payload(static_cast<size_t>(packets) * segment_size, 'g');
+
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            bool offload = mode == 1;
+
+            // The receiver is a UDPSocket bound to an ephemeral loopback port
+            UDPSocket receiver(loopback, 9);
+            sockaddr_in local{};
+            socklen_t local_len = sizeof(local);
+            local.sin_family = AF_INET;
+            local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            int rcvbuf = 8 * 1024 * 1024;
+            if (!receiver.open() ||
+                bind(receiver.getSocketFd(), (sockaddr *)&local, sizeof(local)) < 0 ||
+                getsockname(receiver.getSocketFd(), (sockaddr *)&local, &local_len) < 0)
+            {
+                setupFailed("failed to set up GSO receiver");
+                return;
+            }
+            receiver.setSocketOption(SOL_SOCKET, SO_RCVBUFFORCE, &rcvbuf, sizeof(rcvbuf));
+            receiver.setReceiveTimeout(1);
+            if (offload)
+                receiver.setGroEnabled(true);
+
+            std::atomic<size_t> received{0};
+            double receiver_cpu = 0;
+            std::thread sink([&]() {
+                std::vector<char> buffer(65536);
+                UDPDatagram segments[64];
+                double begin = threadCpuSeconds();
+                while (true)
+                {
+                    int n = offload ? receiver.receiveSegments(buffer.data(), buffer.size(), segments, 64)
+                                    : (receiver.receive(buffer.data(), buffer.size()) > 0 ? 1 : -1);
+                    if (n <= 0)
+                        break;
+                    received += n;
+                }
+                // The final receive timed out; its wait costs no CPU
+                receiver_cpu = threadCpuSeconds() - begin;
+            });
+
+            UDPSocket sender(loopback, ntohs(local.sin_port));
+            sender.open();
+            double begin = threadCpuSeconds();
+            const size_t burst = 64 * static_cast<size_t>(segment_size);
+            for (size_t offset = 0; offset < payload.size(); offset += burst)
+            {
+                size_t length = std::min(burst, payload.size() - offset);
+                if (offload)
+                {
+                    sender.sendSegmented(payload.data() + offset, length, segment_size);
+                }
+                else
+                {
+                    for (size_t p = 0; p < length; p += segment_size)
+                        sender.send(payload.data() + offset + p, std::min<size_t>(segment_size, length - p));
+                }
+                // Pace the bursts so the receiver is measured, not the drops
+                std::this_thread::yield();
+            }
+            double sender_cpu = threadCpuSeconds() - begin;
+            sink.join();
+
+            size_t delivered = received.load();
+            std::cout << "[BENCH] udp " << names[mode]
+                      << " segment=" << segment_size
+                      << " sent=" << packets
+                      << " received=" << delivered
+                      << " sender ns/pkt=" << sender_cpu * 1e9 / packets
+                      << " receiver ns/pkt=" << (delivered ? receiver_cpu * 1e9 / delivered : 0.0)
+                      << std::endl;
+        }
+    }
+}
+
+namespace DelimiterBench {
+    using namespace NetworkBench;
+
+    // Raw kernel throughput over a buffer whose only delimiter is at the end
+    void compareKernels(size_t megabytes)
+    {
+        const std::string delimiters[] = {"\n", "\r\n\r\n"};
+        const DelimiterSearch::Kernel kernels[] = {DelimiterSearch::Kernel::Scalar,
+                                                   DelimiterSearch::Kernel::SSE2,
+                                                   DelimiterSearch::Kernel::AVX2};
+
+        for (const auto &delimiter : delimiters)
+        {
+            // Text with plenty of first-byte hits ('\r') but no full match
+            std::string data(megabytes * 1024 * 1024, 'x');
+            for (size_t i = 0; i < data.size(); i += 61)
+                data[i] = delimiter.size() > 1 ? '\r' : 'y';
+            data.replace(data.size() - delimiter.size(), delimiter.size(), delimiter);
+
+            for (auto kernel : kernels)
+            {
+                if (!DelimiterSearch::isSupported(kernel))
+                    continue;
+
+                auto start = Clock::now();
+                size_t found = DelimiterSearch::find(kernel, data.data(), data.size(),
+                                                     delimiter.data(), delimiter.size());
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+
+                std::cout << "[BENCH] delimiter scan " << DelimiterSearch::kernelName(kernel)
+                          << " delimiter_len=" << delimiter.size()
+                          << " found=" << (found == data.size() - delimiter.size())
+                          << " GB/s=" << data.size() / elapsed.count() / 1e9 << std::endl;
+            }
+        }
+    }
+
+    // The pre-ReadBuffer receiveUntil: 1 KB reads, full re-scan per read,
+    // everything after the delimiter dropped
+    std::string legacyReceiveUntil(int fd, const std::string &delimiter, size_t max_size)
+    {
+        std::string result;
+        char buffer[1024];
+        while (result.size() < max_size)
+        {
+            ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (n <= 0)
+                break;
+            result.append(buffer, n);
+            size_t pos = result.find(delimiter);
+            if (pos != std::string::npos)
+                return result.substr(0, pos + delimiter.length());
+        }
+        return result;
+    }
+
+    // Serves `payload` to the first client on `port`, then closes
+    std::thread serveOnce(int port, const std::string &payload)
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        int opt = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        bind(listener, (sockaddr *)&address, sizeof(address));
+        listen(listener, 1);
+
+        return std::thread([listener, &payload]() {
+            int client = accept(listener, nullptr, nullptr);
+            size_t sent = 0;
+            while (client >= 0 && sent < payload.size())
+            {
+                ssize_t n = send(client, payload.data() + sent, payload.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0)
+                    break;
+                sent += n;
+            }
+            ::close(client);
+            ::close(listener);
+        });
+    }
+
+    // Multi-megabyte delimited streams over loopback: many small records,
+    // then one large record, read with the legacy loop and with receiveUntil
+    void runDelimitedStreams(int port, size_t megabytes)
+    {
+        const std::string delimiter = "\r\n\r\n";
+        const size_t total = megabytes * 1024 * 1024;
+
+        std::string records;
+        while (records.size() < total)
+            records += std::string(4096 - delimiter.size(), 'r') + delimiter;
+        std::string large = std::string(total - delimiter.size(), 'L') + delimiter;
+
+        struct Case {
+            const char *name;
+            const std::string *payload;
+        };
+        const Case cases[] = {{"4KB records", &records}, {"single large record", &large}};
+
+        for (const auto &c : cases)
+        {
+            for (int legacy = 1; legacy >= 0; --legacy)
+            {
+                std::thread server = serveOnce(port, *c.payload);
+                TCPSocket client(loopback, port);
+                if (!client.open())
+                {
+                    setupFailed("failed to connect to the delimited stream server");
+                    server.join();
+                    return;
+                }
+
+                size_t bytes = 0;
+                size_t messages = 0;
+                auto start = Clock::now();
+                while (true)
+                {
+                    std::string message = legacy ? legacyReceiveUntil(client.getSocketFd(), delimiter, total * 2)
+                                                 : client.receiveUntil(delimiter, total * 2);
+                    if (message.empty())
+                        break;
+                    bytes += message.size();
+                    ++messages;
+                }
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+                client.close();
+                server.join();
+
+                std::cout << "[BENCH] receiveUntil " << c.name << (legacy ? " legacy" : " buffered")
+                          << " messages=" << messages
+                          << " bytes=" << bytes
+                          << " MB/s=" << bytes / elapsed.count() / 1e6 << std::endl;
+            }
+        }
+    }
+}
+
+namespace FrameBench {
+    using namespace NetworkBench;
+
+    // Sends `frames` small frames over loopback, one send per frame and then
+    // `batch` frames per send; the receiver parses them out of 64 KB reads
+    void compareBatching(int port, size_t frames, size_t frame_size, size_t batch)
+    {
+        const size_t batch_sizes[] = {1, batch};
+        const std::string payload(frame_size, 'f');
+
+        for (size_t per_send : batch_sizes)
+        {
+            int listener = socket(AF_INET, SOCK_STREAM, 0);
+            int opt = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(port);
+            if (bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, 1) < 0)
+            {
+                setupFailed("failed to start frame receiver");
+                ::close(listener);
+                return;
+            }
+
+            size_t parsed = 0;
+            size_t reads = 0;
+            std::thread receiver([&]() {
+                int client = accept(listener, nullptr, nullptr);
+                FrameParser parser;
+                while (client >= 0)
+                {
+                    char *space = parser.prepare(65536);
+                    ssize_t n = recv(client, space, parser.writable(), 0);
+                    if (n <= 0)
+                        break;
+                    parser.commit(n);
+                    ++reads;
+
+                    FrameView frame;
+                    while (parser.next(frame))
+                        ++parsed;
+                }
+                ::close(client);
+            });
+
+            TCPSocket sender(loopback, port);
+            auto start = Clock::now();
+            if (sender.open())
+            {
+                FrameEncoder encoder;
+                for (size_t i = 0; i < frames; ++i)
+                {
+                    encoder.add(payload);
+                    if (encoder.pendingFrames() == per_send)
+                        encoder.flush(sender);
+                }
+                encoder.flush(sender);
+                sender.close();
+            }
+            receiver.join();
+            ::close(listener);
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+
+            std::cout << "[BENCH] frames per send=" << per_send
+                      << " frame_size=" << frame_size
+                      << " parsed=" << parsed
+                      << " reads=" << reads
+                      << " frames/s=" << parsed / elapsed.count() << std::endl;
+        }
+    }
+}
+
+namespace PoolBench {
+    using namespace NetworkBench;
+
+    // Per-request latency with a fresh connection per request versus
+    // connections borrowed from a ConnectionPool
+    void comparePooling(int port, int clients, int rounds)
+    {
+        SimpleServer server(port);
+        server.setPersistentConnections(true);
+        if (!server.start())
+        {
+            setupFailed("failed to start pool server");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        ConnectionPool::Options options;
+        options.max_per_destination = static_cast<size_t>(clients);
+        ConnectionPool pool(options);
+
+        for (int pooled = 0; pooled <= 1; ++pooled)
+        {
+            std::vector<std::vector<double>> latencies(clients);
+            std::atomic<size_t> failed{0};
+            std::vector<std::thread> threads;
+            auto start = Clock::now();
+
+            for (int i = 0; i < clients; ++i)
+            {
+                threads.emplace_back([&, i]() {
+                    for (int r = 0; r < rounds; ++r)
+                    {
+                        std::string message = "client " + std::to_string(i) + " round " + std::to_string(r);
+                        auto begin = Clock::now();
+                        bool ok;
+                        if (pooled)
+                        {
+                            PooledConnection conn = pool.acquire(loopback, port);
+                            ok = conn && conn->send(message) && !conn->receive().empty();
+                            if (!ok && conn)
+                                conn.discard();
+                        }
+                        else
+                        {
+                            ok = echoOnce(port, message);
+                        }
+                        std::chrono::duration<double, std::micro> took = Clock::now() - begin;
+                        ok ? latencies[i].push_back(took.count()) : (void)failed++;
+                    }
+                });
+            }
+            for (auto &thread : threads)
+                thread.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+
+            std::vector<double> all;
+            for (auto &samples : latencies)
+                all.insert(all.end(), samples.begin(), samples.end());
+            std::sort(all.begin(), all.end());
+
+            std::cout << "[BENCH] " << (pooled ? "pooled" : "connect-per-request")
+                      << ": requests=" << all.size()
+                      << " failed=" << failed.load()
+                      << " req/s=" << all.size() / elapsed.count()
+                      << " p50_us=" << percentile(all, 0.50)
+                      << " p99_us=" << percentile(all, 0.99);
+            if (pooled)
+                std::cout << " hit_rate=" << pool.getStats().hitRate();
+            std::cout << std::endl;
+        }
+
+        pool.clear();
+        server.stop();
+    }
+}
+
+namespace ConnectBench {
+    using namespace NetworkBench;
+
+    // Time to open `connections` sockets one blocking connect() at a time
+    // versus all in flight at once with TCPSocket::openAll()
+    void compareBulkOpen(int port, int connections)
+    {
+        SimpleServer server(port);
+        if (!server.start())
+        {
+            setupFailed("failed to start connect server");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        for (int parallel = 0; parallel <= 1; ++parallel)
+        {
+            std::vector<std::unique_ptr<TCPSocket>> sockets;
+            std::vector<TCPSocket *> targets;
+            for (int i = 0; i < connections; ++i)
+            {
+                sockets.push_back(std::make_unique<TCPSocket>(loopback, port));
+                targets.push_back(sockets.back().get());
+            }
+
+            auto start = Clock::now();
+            size_t opened = 0;
+            if (parallel)
+            {
+                opened = TCPSocket::openAll(targets, 5000);
+            }
+            else
+            {
+                for (TCPSocket *socket : targets)
+                    opened += socket->open() ? 1 : 0;
+            }
+            std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+
+            std::cout << "[BENCH] " << (parallel ? "openAll" : "sequential open")
+                      << ": connections=" << connections
+                      << " opened=" << opened
+                      << " ms=" << elapsed.count() << std::endl;
+        }
+
+        server.stop();
+    }
+}
+
+namespace SweepBench {
+    using namespace NetworkBench;
+
+    struct SweepResult {
+        std::string transport;
+        size_t message_size;
+        int clients;
+        size_t messages;
+        size_t failed;
+        double seconds;
+        uint64_t syscalls;
+        std::vector<double> latencies_us; // sorted
+    };
+
+    // Persistent connection per client: `messages` echo round trips of
+    // `size` bytes, timing each and counting the library's syscalls
+    void runClient(bool tcp, int port, size_t size, size_t messages,
+                   std::vector<double> &latencies, size_t &failed, uint64_t &syscalls)
+    {
+        const std::string payload(size, 'm');
+        const size_t reply_size = size + 6; // "Echo: " + payload
+        std::vector<char> reply(reply_size);
+
+        std::unique_ptr<ISocket> socket;
+        if (tcp)
+            socket = std::make_unique<TCPSocket>(loopback, port);
+        else
+            socket = std::make_unique<UDPSocket>(loopback, port);
+        if (!socket->open())
+        {
+            failed += messages;
+            return;
+        }
+        if (tcp)
+            static_cast<TCPSocket *>(socket.get())->setReceiveTimeout(2);
+        else
+            static_cast<UDPSocket *>(socket.get())->setReceiveTimeout(1);
+
+        uint64_t start_syscalls = SyscallCounter::get();
+        for (size_t i = 0; i < messages; ++i)
+        {
+            auto begin = Clock::now();
+            bool ok = socket->send(payload.data(), payload.size());
+            if (ok && tcp)
+                ok = static_cast<TCPSocket *>(socket.get())->receiveExact(reply.data(), reply_size);
+            else if (ok)
+                ok = socket->receive(reply.data(), reply_size) == static_cast<ssize_t>(reply_size);
+            std::chrono::duration<double, std::micro> took = Clock::now() - begin;
+
+            if (ok)
+                latencies.push_back(took.count());
+            else
+                ++failed;
+        }
+        syscalls = SyscallCounter::get() - start_syscalls;
+        socket->close();
+    }
+
+    SweepResult runCase(bool tcp, int port, size_t size, int clients, size_t messages)
+    {
+        std::vector<std::vector<double>> latencies(clients);
+        std::vector<size_t> failed(clients, 0);
+        std::vector<uint64_t> syscalls(clients, 0);
+        std::vector<std::thread> threads;
+        size_t per_client = messages / clients;
+
+        auto start = Clock::now();
+        for (int i = 0; i < clients; ++i)
+        {
+            latencies[i].reserve(per_client);
+            threads.emplace_back(runClient, tcp, port, size, per_client, std::ref(latencies[i]),
+                                 std::ref(failed[i]), std::ref(syscalls[i]));
+        }
+        for (auto &thread : threads)
+            thread.join();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+
+        SweepResult result{tcp ? "tcp" : "udp", size, clients, 0, 0, elapsed.count(), 0, {}};
+        for (int i = 0; i < clients; ++i)
+        {
+            result.latencies_us.insert(result.latencies_us.end(), latencies[i].begin(), latencies[i].end());
+            result.failed += failed[i];
+            result.syscalls += syscalls[i];
+        }
+        result.messages = result.latencies_us.size();
+        std::sort(result.latencies_us.begin(), result.latencies_us.end());
+        return result;
+    }
+
+    std::string toJson(const std::vector<SweepResult> &results)
+    {
+        std::ostringstream json;
+        json << std::fixed << std::setprecision(3);
+        json << "{\n  \"benchmark\": \"loopback_echo_sweep\",\n  \"results\": [";
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const SweepResult &r = results[i];
+            double seconds = r.seconds > 0 ? r.seconds : 1e-9;
+            size_t attempted = r.messages + r.failed;
+            // Request and reply bytes, the reply carrying the 6-byte prefix
+            double bytes = static_cast<double>(r.messages) * (2 * r.message_size + 6);
+            json << (i ? "," : "") << "\n    {"
+                 << "\"transport\": \"" << r.transport << "\", "
+                 << "\"message_size\": " << r.message_size << ", "
+                 << "\"clients\": " << r.clients << ", "
+                 << "\"messages\": " << r.messages << ", "
+                 << "\"failed\": " << r.failed << ", "
+                 << "\"seconds\": " << r.seconds << ", "
+                 << "\"msgs_per_sec\": " << r.messages / seconds << ", "
+                 << "\"mb_per_sec\": " << bytes / seconds / (1024.0 * 1024.0) << ", "
+                 << "\"syscalls_per_msg\": " << (attempted ? static_cast<double>(r.syscalls) / attempted : 0.0) << ", "
+                 << "\"p50_us\": " << percentile(r.latencies_us, 0.50) << ", "
+                 << "\"p99_us\": " << percentile(r.latencies_us, 0.99) << ", "
+                 << "\"p999_us\": " << percentile(r.latencies_us, 0.999) << "}";
+        }
+        json << "\n  ]\n}\n";
+        return json.str();
+    }
+
+    // Sweeps message size and client count for TCP and UDP echo over
+    // loopback. The JSON report goes to `json_path`, or stdout when empty.
+    void runSweep(int port, size_t messages, const std::string &json_path)
+    {
+        const size_t sizes[] = {16, 256, 1000}; // the servers cap requests at 1023 bytes
+        const int concurrency[] = {1, 4, 16};
+
+        SimpleServer tcp_server(port);
+        tcp_server.setPersistentConnections(true);
+        SimpleUDPServer udp_server(port);
+        if (!tcp_server.start() || !udp_server.start())
+        {
+            setupFailed("failed to start sweep servers");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        std::vector<SweepResult> results;
+        for (bool tcp : {true, false})
+        {
+            for (size_t size : sizes)
+            {
+                for (int clients : concurrency)
+                {
+                    results.push_back(runCase(tcp, port, size, clients, messages));
+                    const SweepResult &r = results.back();
+                    std::cout << "[BENCH] sweep " << r.transport << " size=" << size << " clients=" << clients
+                              << " msgs/s=" << r.messages / r.seconds
+                              << " p99_us=" << percentile(r.latencies_us, 0.99)
+                              << " failed=" << r.failed << std::endl;
+                }
+            }
+        }
+
+        tcp_server.stop();
+        udp_server.stop();
+
+        std::string json = toJson(results);
+        if (json_path.empty())
+        {
+            std::cout << json;
+            return;
+        }
+        std::ofstream out(json_path);
+        out << json;
+        if (out)
+            Utils::log("Bench: sweep report written to " + json_path);
+        else
+            Utils::log("Bench: failed to write " + json_path);
+    }
+}
+
+namespace FileBench {
+    using namespace NetworkBench;
+
+    int listenOn(int port)
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        int opt = 1;
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(port);
+        if (bind(listener, (sockaddr *)&address, sizeof(address)) < 0 || listen(listener, 4) < 0)
+        {
+            ::close(listener);
+            return -1;
+        }
+        return listener;
+    }
+
+    // Reads `fd` to end of stream, then closes it
+    std::thread drain(int fd, std::atomic<size_t> &bytes)
+    {
+        return std::thread([fd, &bytes]() {
+            std::vector<char> buffer(256 * 1024);
+            ssize_t n;
+            while ((n = ::recv(fd, buffer.data(), buffer.size(), 0)) > 0)
+                bytes += n;
+            ::close(fd);
+        });
+    }
+
+    void report(const char *name, size_t bytes, double cpu_seconds, double seconds)
+    {
+        std::cout << "[BENCH] " << name
+                  << " bytes=" << bytes
+                  << " MB/s=" << bytes / seconds / 1e6
+                  << " sender cpu ms=" << cpu_seconds * 1e3
+                  << " cpu ns/KB=" << (bytes ? cpu_seconds * 1e9 * 1024 / bytes : 0.0) << std::endl;
+    }
+
+    // Serves a `megabytes` file `rounds` times over loopback: read into a
+    // std::string and send() versus sendFile(); then proxies the same volume
+    // between two connections with recv()/send() versus spliceTo(). CPU is
+    // the sending (or proxying) thread's own.
+    void compareSendFile(int port, size_t megabytes, int rounds)
+    {
+        const size_t size = megabytes * 1024 * 1024;
+        char path[] = "/tmp/network_bench_file_XXXXXX";
+        int file_fd = mkstemp(path);
+        if (file_fd < 0)
+        {
+            setupFailed("failed to create file");
+            return;
+        }
+        unlink(path);
+        std::string chunk(1024 * 1024, 'f');
+        for (size_t i = 0; i < megabytes; ++i)
+            ::write(file_fd, chunk.data(), chunk.size());
+
+        for (int zero_copy = 0; zero_copy <= 1; ++zero_copy)
+        {
+            int listener = listenOn(port);
+            TCPSocket client(loopback, port);
+            if (listener < 0 || !client.open())
+            {
+                setupFailed("failed to set up file transfer");
+                ::close(listener);
+                ::close(file_fd);
+                return;
+            }
+            std::atomic<size_t> received{0};
+            std::thread sink = drain(accept(listener, nullptr, nullptr), received);
+
+            auto start = Clock::now();
+            double begin = threadCpuSeconds();
+            for (int r = 0; r < rounds; ++r)
+            {
+                if (zero_copy)
+                {
+                    client.sendFile(file_fd, 0, size);
+                }
+                else
+                {
+                    std::string data(size, '\0');
+                    ::pread(file_fd, &data[0], size, 0);
+                    client.send(data);
+                }
+            }
+            double cpu = threadCpuSeconds() - begin;
+            client.close();
+            sink.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            ::close(listener);
+            report(zero_copy ? "file sendFile" : "file read+send", received.load(), cpu, elapsed.count());
+        }
+        ::close(file_fd);
+
+        for (int zero_copy = 0; zero_copy <= 1; ++zero_copy)
+        {
+            int listener = listenOn(port);
+            TCPSocket upstream(loopback, port);
+            TCPSocket downstream(loopback, port);
+            if (listener < 0 || !upstream.open())
+            {
+                setupFailed("failed to set up relay");
+                ::close(listener);
+                return;
+            }
+            int source = accept(listener, nullptr, nullptr);
+            downstream.open();
+            std::atomic<size_t> received{0};
+            std::thread sink = drain(accept(listener, nullptr, nullptr), received);
+            std::thread feeder([&]() {
+                const size_t total = size * rounds;
+                size_t sent = 0;
+                while (sent < total)
+                {
+                    ssize_t n = ::send(source, chunk.data(), std::min(chunk.size(), total - sent), MSG_NOSIGNAL);
+                    if (n <= 0)
+                        break;
+                    sent += n;
+                }
+                ::close(source);
+            });
+
+            auto start = Clock::now();
+            double begin = threadCpuSeconds();
+            if (zero_copy)
+            {
+                while (upstream.spliceTo(downstream, size) > 0)
+                    ;
+            }
+            else
+            {
+                std::vector<char> buffer(256 * 1024);
+                ssize_t n;
+                while ((n = upstream.receive(buffer.data(), buffer.size())) > 0)
+                    downstream.send(buffer.data(), n);
+            }
+            double cpu = threadCpuSeconds() - begin;
+            feeder.join();
+            downstream.close();
+            sink.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            upstream.close();
+            ::close(listener);
+            report(zero_copy ? "relay spliceTo" : "relay recv+send", received.load(), cpu, elapsed.count());
+        }
+    }
+}
+
+namespace ZeroCopyBench {
+    using namespace NetworkBench;
+
+    // Streams `megabytes` over loopback at several payload sizes with the
+    // copying send() and with MSG_ZEROCOPY (threshold 0), reporting the
+    // sender's CPU per KB to show where zero copy starts to pay off.
+    // Loopback receivers force a deferred copy, so real NICs gain more.
+    void compareSizes(int port, size_t megabytes)
+    {
+        const size_t sizes[] = {4 * 1024, 16 * 1024, 64 * 1024, 256 * 1024, 1024 * 1024};
+        const size_t total = megabytes * 1024 * 1024;
+
+        for (size_t size : sizes)
+        {
+            auto payload = std::make_shared<const std::string>(size, 'z');
+            for (int zero_copy = 0; zero_copy <= 1; ++zero_copy)
+            {
+                int listener = FileBench::listenOn(port);
+                TCPSocket client(loopback, port);
+                if (listener < 0 || (zero_copy && !client.setZeroCopy(true, 0)) || !client.open())
+                {
+                    setupFailed("failed to set up zero-copy sender");
+                    ::close(listener);
+                    return;
+                }
+                std::atomic<size_t> received{0};
+                std::thread sink = FileBench::drain(accept(listener, nullptr, nullptr), received);
+
+                auto start = Clock::now();
+                double begin = threadCpuSeconds();
+                for (size_t sent = 0; sent < total; sent += size)
+                {
+                    if (zero_copy)
+                        client.sendZeroCopy(payload);
+                    else
+                        client.send(payload->data(), size);
+                }
+                client.waitZeroCopy(5000);
+                double cpu = threadCpuSeconds() - begin;
+                TCPSocket::ZeroCopyStats stats = client.getZeroCopyStats();
+                client.close();
+                sink.join();
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+                ::close(listener);
+
+                std::cout << "[BENCH] " << (zero_copy ? "zerocopy" : "copy")
+                          << " payload=" << size
+                          << " MB/s=" << received.load() / elapsed.count() / 1e6
+                          << " sender cpu ns/KB=" << cpu * 1e9 * 1024 / total
+                          << " deferred copies=" << stats.deferred_copies << std::endl;
+            }
+        }
+    }
+}
+
+namespace TuningBench {
+    using namespace NetworkBench;
+
+    // Runs each tuning preset on both ends: small-message round trips on
+    // one persistent connection (latency), then a one-way stream of 64KB
+    // sends (throughput)
+    void comparePresets(int port, int round_trips, size_t megabytes)
+    {
+        struct Preset {
+            const char *name;
+            SocketTuning tuning;
+        };
+        const Preset presets[] = {{"defaults", SocketTuning()},
+                                  {"low-latency", SocketTuning::lowLatency()},
+                                  {"bulk-throughput", SocketTuning::bulkThroughput()}};
+        const std::string message(64, 'l');
+        const size_t reply_size = message.size() + 6;
+
+        for (const Preset &preset : presets)
+        {
+            SimpleServer server(port);
+            server.setPersistentConnections(true);
+            server.setTuning(preset.tuning);
+            if (!server.start())
+            {
+                setupFailed("failed to start tuning server");
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            TCPSocket client(loopback, port);
+            client.setTuning(preset.tuning);
+            std::vector<double> latencies;
+            if (client.open())
+            {
+                client.setReceiveTimeout(3);
+                for (int i = 0; i < round_trips; ++i)
+                {
+                    auto start = Clock::now();
+                    if (!client.send(message) || client.receiveExact(reply_size).size() != reply_size)
+                        break;
+                    latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+                }
+                client.close();
+            }
+            server.stop();
+            std::sort(latencies.begin(), latencies.end());
+
+            // Stream to a draining listener tuned the same way
+            int listener = FileBench::listenOn(port + 1);
+            preset.tuning.apply(listener);
+            TCPSocket sender(loopback, port + 1);
+            sender.setTuning(preset.tuning);
+            std::atomic<size_t> received{0};
+            double seconds = 0;
+            if (listener >= 0 && sender.open())
+            {
+                std::thread sink = FileBench::drain(accept(listener, nullptr, nullptr), received);
+                std::string chunk(64 * 1024, 'b');
+                auto start = Clock::now();
+                for (size_t sent = 0; sent < megabytes * 1024 * 1024; sent += chunk.size())
+                    sender.send(chunk);
+                sender.close();
+                sink.join();
+                seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            }
+            ::close(listener);
+
+            std::cout << "[BENCH] tuning " << preset.name
+                      << " round trips=" << latencies.size()
+                      << " p50 us=" << percentile(latencies, 0.50)
+                      << " p99 us=" << percentile(latencies, 0.99)
+                      << " stream MB/s=" << (seconds > 0 ? received.load() / seconds / 1e6 : 0.0) << std::endl;
+        }
+    }
+}
+
+namespace CoroutineBench {
+    using namespace NetworkBench;
+
+    Task<void> clientSession(IoContext &io, int port, int round_trips, std::atomic<size_t> &completed)
+    {
+        const std::string message(64, 'c');
+        TCPSocket client(loopback, port);
+        bool opened = co_await client.asyncOpen(io);
+        if (!opened)
+            co_return;
+        char reply[128];
+        for (int i = 0; i < round_trips; ++i)
+        {
+            bool sent = co_await client.asyncSend(io, message.data(), message.size());
+            ssize_t n = sent ? co_await client.asyncReceive(io, reply, sizeof(reply)) : -1;
+            if (n <= 0)
+                co_return;
+            ++completed;
+        }
+    }
+
+    // `sessions` concurrent persistent connections doing `round_trips`
+    // echoes each: one blocking thread per session versus every session as
+    // a coroutine on one thread. The server is the coroutine echo server.
+    void compareClientModels(int port, int round_trips)
+    {
+        CoroutineEchoServer server(port);
+        server.setPersistentConnections(true);
+        if (!server.start())
+        {
+            setupFailed("failed to start coroutine server");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        const int session_counts[] = {100, 1000, 8000};
+        const std::string message(64, 't');
+        for (int sessions : session_counts)
+        {
+            for (int coroutines = 0; coroutines <= 1; ++coroutines)
+            {
+                // Thousands of threads cost more than the bench measures
+                if (!coroutines && sessions > 1000)
+                    continue;
+
+                std::atomic<size_t> completed{0};
+                auto start = Clock::now();
+                if (coroutines)
+                {
+                    IoContext io;
+                    io.init();
+                    for (int i = 0; i < sessions; ++i)
+                        io.spawn(clientSession(io, port, round_trips, completed));
+                    io.runUntilIdle();
+                }
+                else
+                {
+                    std::vector<std::thread> threads;
+                    for (int i = 0; i < sessions; ++i)
+                    {
+                        threads.emplace_back([&]() {
+                            TCPSocket client(loopback, port);
+                            if (!client.open())
+                                return;
+                            char reply[128];
+                            for (int r = 0; r < round_trips; ++r)
+                            {
+                                if (!client.send(message) || client.receive(reply, sizeof(reply)) <= 0)
+                                    return;
+                                ++completed;
+                            }
+                        });
+                    }
+                    for (auto &thread : threads)
+                        thread.join();
+                }
+                std::chrono::duration<double> elapsed = Clock::now() - start;
+
+                std::cout << "[BENCH] " << (coroutines ? "coroutines (1 thread)" : "thread per session")
+                          << ": sessions=" << sessions
+                          << " round trips=" << completed.load()
+                          << " of " << static_cast<size_t>(sessions) * round_trips
+                          << " req/s=" << completed.load() / elapsed.count() << std::endl;
+            }
+        }
+
+        server.stop();
+    }
+}
+
+namespace WorkerBench {
+    using namespace NetworkBench;
+
+    // Requests starting with "heavy" burn `heavy_us` of CPU, the rest none
+    std::string burnHandler(std::string_view request, int heavy_us)
+    {
+        if (request.substr(0, 5) == "heavy")
+        {
+            auto until = Clock::now() + std::chrono::microseconds(heavy_us);
+            while (Clock::now() < until)
+            {
+            }
+        }
+        return "Echo: " + std::string(request);
+    }
+
+    // One I/O thread serving a few connections that send CPU-heavy requests
+    // and many that send trivial ones, with the work done inline on the I/O
+    // thread versus on a work-stealing pool. Reports the light requests'
+    // latency, which inline handling makes wait behind the heavy ones.
+    void compareDispatch(int port, int light_clients, int heavy_clients, int rounds, int heavy_us)
+    {
+        int workers = std::max(2, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int pooled = 0; pooled <= 1; ++pooled)
+        {
+            SimpleServer server(port + pooled);
+            server.setPersistentConnections(true);
+            server.setRequestHandler([heavy_us](std::string_view request) { return burnHandler(request, heavy_us); });
+            if (pooled)
+                server.setWorkerThreads(workers);
+            if (!server.start())
+            {
+                setupFailed("failed to start SimpleServer");
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            std::atomic<bool> light_done{false};
+            std::atomic<size_t> heavy_completed{0};
+            std::vector<std::vector<double>> latencies(light_clients);
+            std::vector<std::thread> threads;
+
+            // Heavy clients keep the server busy until the light ones finish
+            for (int i = 0; i < heavy_clients; ++i)
+            {
+                threads.emplace_back([&, i]() {
+                    TCPSocket client(loopback, port + pooled);
+                    if (!client.open())
+                        return;
+                    while (!light_done)
+                    {
+                        if (!client.send("heavy " + std::to_string(i)) || client.receive().empty())
+                            return;
+                        heavy_completed++;
+                    }
+                });
+            }
+
+            auto start = Clock::now();
+            std::vector<std::thread> light;
+            for (int i = 0; i < light_clients; ++i)
+            {
+                light.emplace_back([&, i]() {
+                    TCPSocket client(loopback, port + pooled);
+                    if (!client.open())
+                        return;
+                    for (int r = 0; r < rounds; ++r)
+                    {
+                        auto sent = Clock::now();
+                        if (!client.send("light " + std::to_string(i)) || client.receive().empty())
+                            return;
+                        std::chrono::duration<double, std::micro> waited = Clock::now() - sent;
+                        latencies[i].push_back(waited.count());
+                    }
+                });
+            }
+            for (auto &thread : light)
+                thread.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            light_done = true;
+            for (auto &thread : threads)
+                thread.join();
+
+            WorkStealingPool::Stats stats = server.getWorkerStats();
+            server.stop();
+
+            std::vector<double> all;
+            for (auto &samples : latencies)
+                all.insert(all.end(), samples.begin(), samples.end());
+            std::sort(all.begin(), all.end());
+
+            std::cout << "[BENCH] dispatch " << (pooled ? "workers=" + std::to_string(workers) : std::string("inline"))
+                      << ": light req/s=" << all.size() / elapsed.count()
+                      << " light p50 us=" << percentile(all, 0.50)
+                      << " p99 us=" << percentile(all, 0.99)
+                      << " heavy completed=" << heavy_completed.load()
+                      << " stolen=" << stats.stolen << std::endl;
+        }
+    }
+}
+
+namespace ReuseBench {
+    using namespace NetworkBench;
+
+    // `clients` threads each exchange `messages` 64-byte echoes: on a new
+    // connection per message, then framed over one persistent connection
+    // with one request in flight, then pipelined `depth` at a time
+    void compareReuse(int port, int clients, int messages, int depth)
+    {
+        const std::string message(64, 'r');
+
+        SimpleServer oneShot(port);
+        SimpleServer framed(port + 1);
+        framed.setFraming(FramePrefix::Varint);
+        if (!oneShot.start() || !framed.start())
+        {
+            setupFailed("failed to start SimpleServer");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        const int depths[] = {0, 1, depth};
+        for (int in_flight : depths)
+        {
+            std::atomic<size_t> completed{0};
+            std::vector<std::thread> threads;
+            auto start = Clock::now();
+            for (int i = 0; i < clients; ++i)
+            {
+                threads.emplace_back([&]() {
+                    if (in_flight == 0)
+                    {
+                        for (int m = 0; m < messages; ++m)
+                        {
+                            if (!echoOnce(port, message))
+                                return;
+                            completed++;
+                        }
+                        return;
+                    }
+
+                    TCPSocket client(loopback, port + 1);
+                    if (!client.open())
+                        return;
+                    FrameParser parser;
+                    for (int sent = 0; sent < messages; sent += in_flight)
+                    {
+                        FrameEncoder encoder;
+                        int batch = std::min(in_flight, messages - sent);
+                        for (int b = 0; b < batch; ++b)
+                            encoder.add(message);
+                        if (!encoder.flush(client))
+                            return;
+
+                        int received = 0;
+                        FrameView frame;
+                        while (received < batch)
+                        {
+                            while (received < batch && parser.next(frame))
+                                ++received;
+                            if (received < batch && parser.readFrom(client) <= 0)
+                                return;
+                        }
+                        completed += batch;
+                    }
+                });
+            }
+            for (auto &thread : threads)
+                thread.join();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+
+            std::string mode = in_flight == 0 ? "connection per message"
+                                              : "persistent, " + std::to_string(in_flight) + " in flight";
+            std::cout << "[BENCH] " << mode
+                      << ": messages=" << completed.load()
+                      << " of " << static_cast<size_t>(clients) * messages
+                      << " msgs/s=" << completed.load() / elapsed.count() << std::endl;
+        }
+
+        oneShot.stop();
+        framed.stop();
+    }
+}
+
+namespace UnixBench {
+    using namespace NetworkBench;
+
+    // Ping-pong round trips of one `size`-byte echo at a time over an open
+    // client socket
+    void measureRoundTrips(const std::string &name, ISocket &client, int round_trips, size_t size)
+    {
+        const std::string message(size, 'u');
+        const size_t expected = size + 6; // "Echo: " + message
+        std::vector<char> reply(expected);
+        std::vector<double> samples;
+        samples.reserve(round_trips);
+
+        auto start = Clock::now();
+        for (int i = 0; i < round_trips; ++i)
+        {
+            auto sent = Clock::now();
+            if (!client.send(message))
+                break;
+            size_t received = 0;
+            while (received < expected)
+            {
+                ssize_t n = client.receive(reply.data() + received, expected - received);
+                if (n <= 0)
+                    break;
+                received += n;
+            }
+            if (received < expected)
+                break;
+            std::chrono::duration<double, std::micro> waited = Clock::now() - sent;
+            samples.push_back(waited.count());
+        }
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        std::sort(samples.begin(), samples.end());
+
+        std::cout << "[BENCH] " << name
+                  << ": round trips=" << samples.size()
+                  << " per s=" << samples.size() / elapsed.count()
+                  << " p50 us=" << percentile(samples, 0.50)
+                  << " p99 us=" << percentile(samples, 0.99) << std::endl;
+    }
+
+    // Same-host round-trip latency of AF_UNIX stream and datagram sockets
+    // against loopback TCP and UDP, all against single-threaded echo servers
+    void compareLatency(int port, int round_trips, size_t size)
+    {
+        const std::string stream_path = "@network_bench_stream_" + std::to_string(port);
+        const std::string datagram_path = "@network_bench_dgram_" + std::to_string(port);
+
+        SimpleServer tcp_server(port);
+        tcp_server.setPersistentConnections(true);
+        SimpleUDPServer udp_server(port);
+        SimpleUnixServer stream_server(stream_path);
+        stream_server.setPersistentConnections(true);
+        SimpleUnixDatagramServer datagram_server(datagram_path);
+        if (!tcp_server.start() || !udp_server.start() || !stream_server.start() || !datagram_server.start())
+        {
+            setupFailed("failed to start the echo servers");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+        TCPSocket tcp(loopback, port);
+        SocketTuning no_delay;
+        no_delay.no_delay = 1;
+        tcp.setTuning(no_delay);
+        if (tcp.open())
+            measureRoundTrips("latency loopback TCP", tcp, round_trips, size);
+
+        UnixStreamSocket stream(stream_path);
+        if (stream.open())
+            UnixBench::measureRoundTrips("latency Unix stream", stream, round_trips, size);
+
+        UDPSocket udp(loopback, port);
+        if (udp.open())
+            measureRoundTrips("latency loopback UDP", udp, round_trips, size);
+
+        UnixDatagramSocket datagram(datagram_path);
+        if (datagram.open())
+            measureRoundTrips("latency Unix datagram", datagram, round_trips, size);
+
+        tcp.close();
+        stream.close();
+        udp.close();
+        datagram.close();
+        tcp_server.stop();
+        udp_server.stop();
+        stream_server.stop();
+        datagram_server.stop();
+    }
+}
+
+namespace SharedMemoryBench {
+    using namespace NetworkBench;
+
+    // Round-trip latency over shared memory rings with each wakeup
+    // mechanism, with and without spinning, next to a Unix stream socket.
+    // Spinning only helps when client and server threads run on separate
+    // cores; on a single CPU it burns the peer's time slice instead.
+    void compareLatency(int port, int round_trips, size_t size)
+    {
+        const std::string stream_path = "@network_bench_shm_stream_" + std::to_string(port);
+        const std::string shm_path = "@network_bench_shm_" + std::to_string(port);
+        const std::string spin_path = "@network_bench_shm_spin_" + std::to_string(port);
+        const auto spin = std::chrono::microseconds(50);
+
+        SimpleUnixServer stream_server(stream_path);
+        stream_server.setPersistentConnections(true);
+        SimpleSharedMemoryServer shm_server(shm_path);
+        SimpleSharedMemoryServer spin_server(spin_path);
+        spin_server.setSpinTime(spin);
+        if (!stream_server.start() || !shm_server.start() || !spin_server.start())
+        {
+            setupFailed("failed to start the echo servers");
+            return;
+        }
+
+        UnixStreamSocket stream(stream_path);
+        if (stream.open())
+            UnixBench::measureRoundTrips("latency Unix stream", stream, round_trips, size);
+
+        SharedMemorySocket futex(shm_path);
+        if (futex.open())
+            UnixBench::measureRoundTrips("latency shared memory futex", futex, round_trips, size);
+
+        SharedMemorySocket event(shm_path);
+        event.setWakeup(ShmWakeup::EventFd);
+        if (event.open())
+            UnixBench::measureRoundTrips("latency shared memory eventfd", event, round_trips, size);
+
+        SharedMemorySocket spinning(spin_path);
+        spinning.setSpinTime(spin);
+        if (spinning.open())
+            UnixBench::measureRoundTrips("latency shared memory futex + 50us spin", spinning, round_trips, size);
+
+        stream.close();
+        futex.close();
+        event.close();
+        spinning.close();
+        stream_server.stop();
+        shm_server.stop();
+        spin_server.stop();
+    }
+}
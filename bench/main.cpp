@@ -0,0 +1,78 @@
+#include "../needed_files/Utils.h"
+#include "NetworkBench.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+
+// Usage: network_bench [base_port] [clients] [rounds] [slow_clients] [stall_ms] [max_shards] [json_report]
+// The size/concurrency sweep is written as JSON to json_report (stdout if omitted).
+// The sections listen on fixed ports from base_port up to base_port + 20 +
+// max_shards; the default keeps them below the ephemeral range, where the
+// thousands of client connections the sections open cannot take them.
+// Exits 1 when a section could not start.
+namespace {
+
+    // Warns when the fixed ports fall inside ip_local_port_range
+    void checkPortRange(int first, int last)
+    {
+        std::ifstream in("/proc/sys/net/ipv4/ip_local_port_range");
+        int low = 0;
+        int high = 0;
+        if (!(in >> low >> high) || last < low || first > high)
+            return;
+        Utils::log("Bench: warning: ports " + std::to_string(first) + "-" + std::to_string(last) +
+                   " overlap the ephemeral range " + std::to_string(low) + "-" + std::to_string(high) +
+                   "; a section may fail to bind");
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    int port = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int clients = argc > 2 ? std::atoi(argv[2]) : 64;
+    int rounds = argc > 3 ? std::atoi(argv[3]) : 20;
+    int slow_clients = argc > 4 ? std::atoi(argv[4]) : 4;
+    int stall_ms = argc > 5 ? std::atoi(argv[5]) : 200;
+    int max_shards = argc > 6 ? std::atoi(argv[6]) : static_cast<int>(std::thread::hardware_concurrency());
+    std::string json_report = argc > 7 ? argv[7] : "";
+
+    Utils::log("Network Benchmark");
+    Utils::log("============================");
+    checkPortRange(port, port + 20 + max_shards);
+
+    ServerBench::compareEventLoopWithSerial(port, clients, rounds, slow_clients, stall_ms);
+    IoEngineBench::compareIoEngines(port + 2, clients, rounds);
+    ScalingBench::runShardScaling(port + 4, max_shards > 0 ? max_shards : 1, clients, rounds);
+    // UDP ports do not collide with the TCP ones above
+    UdpBench::compareBatchSizes(port, clients, rounds, UDPSocket::kMaxBatch / 2);
+    GsoBench::compareSegmentation(200000, 1400);
+    DelimiterBench::compareKernels(64);
+    DelimiterBench::runDelimitedStreams(port + 5 + max_shards, 8);
+    FrameBench::compareBatching(port + 6 + max_shards, 200000, 64, 256);
+    PoolBench::comparePooling(port + 7 + max_shards, clients, rounds);
+    ConnectBench::compareBulkOpen(port + 8 + max_shards, 500);
+    SweepBench::runSweep(port + 9 + max_shards, 50000, json_report);
+    FileBench::compareSendFile(port + 10 + max_shards, 64, 8);
+    ZeroCopyBench::compareSizes(port + 11 + max_shards, 256);
+    // Uses two ports
+    TuningBench::comparePresets(port + 12 + max_shards, 20000, 512);
+    // Uses two ports
+    WorkerBench::compareDispatch(port + 15 + max_shards, 16, 4, 200, 1000);
+    // Uses two ports
+    ReuseBench::compareReuse(port + 17 + max_shards, clients, 2000, 32);
+    UnixBench::compareLatency(port + 19 + max_shards, 20000, 64);
+    SharedMemoryBench::compareLatency(port + 20 + max_shards, 20000, 64);
+    // Last: its thousands of short-lived connections use up ephemeral ports
+    // that the fixed ports of a later section could fall among
+    CoroutineBench::compareClientModels(port + 14 + max_shards, 20);
+
+    if (NetworkBench::setup_failures > 0)
+    {
+        Utils::log("Bench: " + std::to_string(NetworkBench::setup_failures) + " section(s) failed to start");
+        return 1;
+    }
+    return 0;
+}
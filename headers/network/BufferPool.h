@@ -0,0 +1,121 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+class BufferPool;
+
+// Header placed in front of every block; padded to a full cache line so the
+// payload that follows starts cache-line aligned
+struct alignas(64) BufferBlock {
+    BufferPool *pool;
+    std::atomic<uint32_t> refs;
+    BufferBlock *next;
+};
+
+// Refcounted handle to a pooled block. Copies share the block; the block goes
+// back to its pool when the last handle is destroyed, from any thread.
+class PooledBuffer
+{
+private:
+    BufferBlock *block_;
+
+    friend class BufferPool;
+    explicit PooledBuffer(BufferBlock *block) : block_(block) {}
+
+public:
+    PooledBuffer() : block_(nullptr) {}
+    PooledBuffer(const PooledBuffer &other);
+    PooledBuffer(PooledBuffer &&other) noexcept : block_(other.block_) { other.block_ = nullptr; }
+    PooledBuffer &operator=(const PooledBuffer &other);
+    PooledBuffer &operator=(PooledBuffer &&other) noexcept;
+    ~PooledBuffer();
+
+    char *data() const { return block_ ? reinterpret_cast<char *>(block_ + 1) : nullptr; }
+    size_t capacity() const;
+    uint32_t useCount() const { return block_ ? block_->refs.load(std::memory_order_relaxed) : 0; }
+    explicit operator bool() const { return block_ != nullptr; }
+    void reset();
+};
+
+// Slab allocator handing out fixed-size, cache-line-aligned blocks.
+//
+// Slabs are carved from mmap'ed memory (optionally huge-page backed) and
+// never returned to the OS while the pool lives. A pool is owned by one
+// thread; blocks released on other threads go to a lock-free remote list
+// that the owner reclaims when its local free list runs dry.
+class BufferPool
+{
+public:
+    static const size_t kCacheLine = 64;
+    static const size_t kDefaultBlockSize = 4096;
+
+    struct Stats {
+        uint64_t hits;           // acquire() served from a free list
+        uint64_t misses;         // acquire() had to carve a new slab
+        uint64_t remote_frees;   // blocks released by another thread
+        size_t slabs;
+        size_t blocks_in_use;
+        bool huge_pages;
+    };
+
+private:
+    struct Slab {
+        void *memory;
+        size_t size;
+    };
+
+    size_t block_size_;
+    size_t stride_;
+    size_t blocks_per_slab_;
+    bool want_huge_pages_;
+    std::atomic<bool> huge_pages_;
+    std::thread::id owner_;
+
+    BufferBlock *free_list_;
+    std::atomic<BufferBlock *> remote_free_;
+    std::vector<Slab> slabs_;
+    std::atomic<size_t> slab_count_;
+
+    std::atomic<uint64_t> hits_;
+    std::atomic<uint64_t> misses_;
+    std::atomic<uint64_t> remote_frees_;
+    // One reference per outstanding block plus one for the owner; a
+    // thread-local pool is freed when its thread has exited and the last
+    // block comes back
+    std::atomic<size_t> users_;
+    // The owner's reference was dropped by retire()
+    std::atomic<bool> retired_;
+
+    // Owns a thread's local() pool and retires it on thread exit
+    struct LocalHolder;
+
+    bool grow();
+    void release(BufferBlock *block);
+    void retire();
+
+    friend class PooledBuffer;
+
+public:
+    explicit BufferPool(size_t block_size = kDefaultBlockSize, size_t blocks_per_slab = 64,
+                        bool huge_pages = false);
+    ~BufferPool();
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // Returns an empty handle only if the system is out of memory
+    PooledBuffer acquire();
+
+    size_t getBlockSize() const;
+    // Safe to call from any thread
+    Stats getStats() const;
+
+    // The calling thread's pool of kDefaultBlockSize blocks
+    static BufferPool &local();
+    // Huge-page backing for thread-local pools created after this call
+    static void setLocalHugePages(bool enable);
+};
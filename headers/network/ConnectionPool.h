@@ -0,0 +1,127 @@
+#pragma once
+
+#include "TCPSocket.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class ConnectionPool;
+
+// Connected socket borrowed from a ConnectionPool. It goes back to the pool
+// when the lease is destroyed or release()d; call discard() instead when the
+// connection is in an unknown state (failed send, partial response, ...).
+// A lease must not outlive its pool.
+class PooledConnection
+{
+private:
+    ConnectionPool *pool_;
+    std::string key_;
+    std::unique_ptr<TCPSocket> socket_;
+
+    friend class ConnectionPool;
+    PooledConnection(ConnectionPool *pool, const std::string &key, std::unique_ptr<TCPSocket> socket);
+
+public:
+    PooledConnection() : pool_(nullptr) {}
+    PooledConnection(PooledConnection &&other) noexcept;
+    PooledConnection &operator=(PooledConnection &&other) noexcept;
+    ~PooledConnection();
+
+    PooledConnection(const PooledConnection &) = delete;
+    PooledConnection &operator=(const PooledConnection &) = delete;
+
+    TCPSocket *get() const { return socket_.get(); }
+    TCPSocket *operator->() const { return socket_.get(); }
+    TCPSocket &operator*() const { return *socket_; }
+    explicit operator bool() const { return socket_ != nullptr; }
+
+    void release();
+    void discard();
+};
+
+// Thread-safe pool of connected TCPSockets keyed by address:port.
+//
+// acquire() hands out the most recently returned idle connection after a
+// non-blocking health check, or opens a new one. At most
+// max_per_destination connections (idle + leased) exist per destination;
+// further acquire() calls wait up to acquire_timeout_ms for a lease to come
+// back. A background thread closes connections idle for longer than
+// idle_timeout_ms.
+class ConnectionPool
+{
+public:
+    struct Options {
+        size_t max_per_destination = 8;
+        int idle_timeout_ms = 30000;
+        int eviction_interval_ms = 1000; // 0 disables the eviction thread
+        int acquire_timeout_ms = 5000;
+        int connect_timeout_ms = 3000; // < 0 uses a blocking connect()
+    };
+
+    struct Stats {
+        uint64_t hits;          // acquire() served by an idle connection
+        uint64_t misses;        // acquire() had to open a connection
+        uint64_t failed_opens;
+        uint64_t failed_checks; // idle connections found dead on acquire()
+        uint64_t evictions;     // idle connections closed by the timer
+        uint64_t timeouts;      // acquire() gave up waiting for a free slot
+        size_t idle;
+        size_t leased;
+
+        double hitRate() const;
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct IdleConnection {
+        std::unique_ptr<TCPSocket> socket;
+        Clock::time_point since;
+    };
+
+    struct Destination {
+        // Oldest first; acquire() takes from the back
+        std::vector<IdleConnection> idle;
+        size_t leased = 0;
+    };
+
+    Options options_;
+    mutable std::mutex mutex_;
+    std::condition_variable slot_freed_;
+    std::condition_variable evictor_wakeup_;
+    std::unordered_map<std::string, Destination> destinations_;
+    bool stopping_;
+    std::thread evictor_;
+    Stats stats_;
+
+    friend class PooledConnection;
+    void giveBack(const std::string &key, std::unique_ptr<TCPSocket> socket, bool reusable);
+    void evictorLoop();
+    size_t evictIdle(Clock::time_point now);
+
+public:
+    ConnectionPool();
+    explicit ConnectionPool(const Options &options);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool &) = delete;
+    ConnectionPool &operator=(const ConnectionPool &) = delete;
+
+    // Returns an empty lease when the connection cannot be opened or no slot
+    // frees up within acquire_timeout_ms
+    PooledConnection acquire(const std::string &address, int port);
+
+    // Closes idle connections past their timeout; returns how many
+    size_t evictExpired();
+    // Closes every idle connection
+    void clear();
+
+    Stats getStats() const;
+    const Options &getOptions() const;
+};
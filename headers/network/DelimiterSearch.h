@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+
+// Substring search used by receiveUntil().
+//
+// Single-byte delimiters compare 16/32 bytes per step. Longer delimiters
+// first match their first and last byte across a whole vector and only
+// compare the middle bytes of the few candidates that survive. The fastest
+// kernel the CPU supports is picked once at runtime.
+class DelimiterSearch
+{
+public:
+    enum class Kernel {
+        Scalar,
+        SSE2,
+        AVX2
+    };
+
+    static const size_t npos = static_cast<size_t>(-1);
+
+    // Offset of the first occurrence of `delimiter` in `data`, or npos
+    static size_t find(const char *data, size_t size, const char *delimiter, size_t delimiter_size);
+    static size_t find(Kernel kernel, const char *data, size_t size, const char *delimiter,
+                       size_t delimiter_size);
+
+    static Kernel bestKernel();
+    static bool isSupported(Kernel kernel);
+    static const char *kernelName(Kernel kernel);
+};
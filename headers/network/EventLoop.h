@@ -0,0 +1,68 @@
+#pragma once
+
+#include <sys/epoll.h>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Edge-triggered epoll reactor.
+//
+// Every registered fd is switched to non-blocking mode and gets a readiness
+// callback that receives the epoll event mask. Because notifications are
+// edge-triggered, a callback must drain the fd (read/accept/write until
+// EAGAIN) before returning. run() blocks the calling thread until stop() is
+// called from any thread; a stopped loop does not restart. Other threads
+// hand work to the loop thread with post().
+class EventLoop
+{
+public:
+    using Callback = std::function<void(uint32_t events)>;
+
+private:
+    struct Handler {
+        int fd;
+        bool active;
+        Callback callback;
+    };
+
+    int epoll_fd_;
+    int wakeup_fd_;
+    std::atomic<bool> running_;
+    std::atomic<bool> stop_requested_;
+    std::unordered_map<int, std::unique_ptr<Handler>> handlers_;
+    // Handlers removed while dispatching a batch; freed once the batch is done
+    std::vector<std::unique_ptr<Handler>> retired_;
+    std::vector<epoll_event> events_;
+    std::mutex posted_mutex_;
+    std::vector<std::function<void()>> posted_;
+
+    void runPosted();
+
+public:
+    explicit EventLoop(size_t max_events = 256);
+    ~EventLoop();
+
+    EventLoop(const EventLoop &) = delete;
+    EventLoop &operator=(const EventLoop &) = delete;
+
+    bool init();
+
+    // Registration (loop thread only once run() is active)
+    bool add(int fd, uint32_t events, Callback callback);
+    bool modify(int fd, uint32_t events);
+    void remove(int fd);
+
+    // Runs `fn` on the loop thread during run(); safe from any thread.
+    // Functions still queued when the loop is destroyed are dropped.
+    void post(std::function<void()> fn);
+
+    void run();
+    void stop();
+    bool isRunning() const;
+
+    static bool setNonBlocking(int fd);
+};
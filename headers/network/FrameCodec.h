@@ -0,0 +1,90 @@
+#pragma once
+
+#include "ReadBuffer.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/types.h>
+
+class TCPSocket;
+
+// Length prefix placed in front of every frame.
+// Varint is unsigned LEB128 (1 byte up to 127, 2 up to 16383, ...);
+// the fixed widths are big-endian.
+enum class FramePrefix {
+    Varint,
+    Fixed16,
+    Fixed32
+};
+
+// A complete frame's payload, pointing into the parser's buffer
+struct FrameView {
+    const char *data;
+    size_t size;
+};
+
+// Collects frames into one contiguous buffer so that many small frames go
+// out with a single send.
+class FrameEncoder
+{
+private:
+    FramePrefix prefix_;
+    std::string buffer_;
+    size_t frames_;
+
+public:
+    explicit FrameEncoder(FramePrefix prefix = FramePrefix::Varint);
+
+    // Returns false if `size` does not fit the prefix (65535 for Fixed16,
+    // 4 GiB - 1 for Fixed32)
+    bool add(const char *data, size_t size);
+    bool add(const std::string &payload);
+
+    // Sends every pending frame with one send() and clears the batch
+    bool flush(TCPSocket &socket);
+
+    const std::string &buffer() const;
+    size_t pendingFrames() const;
+    void clear();
+
+    // Writes the prefix for `length` to `out` (at least kMaxPrefixSize bytes)
+    // and returns its size, 0 if `length` does not fit
+    static constexpr size_t kMaxPrefixSize = 10;
+    static size_t encodePrefix(FramePrefix prefix, uint64_t length, char *out);
+};
+
+// Incremental frame parser.
+//
+// Socket data is read straight into the parser's buffer (prepare/commit,
+// or readFrom()), and next() hands out complete frames as views into that
+// buffer without copying, so one large read can yield many frames. A view
+// stays valid until the next prepare(), feed() or readFrom().
+class FrameParser
+{
+private:
+    FramePrefix prefix_;
+    size_t max_frame_size_;
+    ReadBuffer buffer_;
+    bool error_;
+
+public:
+    explicit FrameParser(FramePrefix prefix = FramePrefix::Varint, size_t max_frame_size = 16 * 1024 * 1024);
+
+    char *prepare(size_t size);
+    size_t writable() const;
+    void commit(size_t size);
+    // Copying alternative to prepare()/commit()
+    void feed(const char *data, size_t size);
+
+    // Reads once from `socket` into the buffer. Returns the bytes read,
+    // 0 when the peer closed the connection, -1 on error or timeout.
+    ssize_t readFrom(TCPSocket &socket, size_t chunk = 65536);
+
+    // Pops the next complete frame; false when more data is needed or the
+    // stream is corrupt (oversized frame or malformed varint, see hasError())
+    bool next(FrameView &frame);
+
+    bool hasError() const;
+    size_t buffered() const;
+    void reset();
+};
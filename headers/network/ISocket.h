@@ -1,6 +1,9 @@
 #pragma once
 
 #include <string>
+#include <cstddef>
+#include <sys/types.h>
+#include <sys/uio.h>
 
 class ISocket {
 public:
@@ -9,5 +12,23 @@ public:
     virtual void close() = 0;
     virtual bool send(const std::string& data) = 0;
     virtual std::string receive() = 0;
+
+    // Caller-owned buffers, no allocation per call.
+    // send() succeeds only when every byte went out.
+    // receive() returns the byte count, 0 when the peer closed the connection,
+    // or -1 with errno set (EAGAIN/EWOULDBLOCK when no data arrived in time).
+    virtual bool send(const char* data, size_t size) = 0;
+    virtual ssize_t receive(char* buffer, size_t size) = 0;
+
+    // Scatter-gather variants of the calls above (at most IOV_MAX buffers).
+    // sendv() sends the buffers back to back as one message without joining
+    // them first; receivev() fills them in order with a single read.
+    virtual bool sendv(const iovec* iov, int count) = 0;
+    virtual ssize_t receivev(const iovec* iov, int count) = 0;
+
+    // Readiness waits (see SocketSet): the descriptor, -1 while closed, and
+    // bytes already read from it but not yet returned to the caller
+    virtual int getSocketFd() const = 0;
+    virtual size_t getBufferedSize() const = 0;
 };
 
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "EventLoop.h"
+#include "Task.h"
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+// Single-threaded driver for the coroutine socket API (TCPSocket::async*,
+// UDPSocket::async*, TCPAcceptor).
+//
+// Coroutines suspend on fd readiness and are resumed by an EventLoop on the
+// thread inside run(), so one thread can carry any number of sessions with
+// straight-line code. Every async operation tries its syscall first and
+// only waits after EAGAIN, which is what the edge-triggered loop needs.
+// An fd has at most one reader and one writer waiting at a time.
+//
+// Everything except stop() must be called from the run() thread (or before
+// run()). Tasks still suspended when the context is destroyed are destroyed
+// with it, closing the sockets they own.
+class IoContext
+{
+public:
+    // co_await result: true once the fd is ready, false if it was forgotten
+    // (its socket closed) or could not be registered
+    class ReadinessAwaiter
+    {
+    private:
+        IoContext *io_;
+        int fd_;
+        bool write_;
+        bool ready_;
+        std::coroutine_handle<> handle_;
+
+        friend class IoContext;
+
+    public:
+        ReadinessAwaiter(IoContext *io, int fd, bool write)
+            : io_(io), fd_(fd), write_(write), ready_(false), handle_(nullptr) {}
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle);
+        bool await_resume() const noexcept { return ready_; }
+    };
+
+private:
+    struct Waiters {
+        ReadinessAwaiter *reader;
+        ReadinessAwaiter *writer;
+    };
+
+    // Fire-and-forget wrapper that owns a spawned Task while it runs
+    struct Detached;
+
+    EventLoop loop_;
+    std::unordered_map<int, Waiters> fds_;
+    std::unordered_set<void *> roots_;
+    bool stop_when_idle_;
+    bool closing_;
+
+    void dispatch(int fd, uint32_t events);
+    void finished(void *root);
+    static Detached runDetached(IoContext *io, Task<void> task);
+
+public:
+    IoContext();
+    ~IoContext();
+
+    IoContext(const IoContext &) = delete;
+    IoContext &operator=(const IoContext &) = delete;
+
+    bool init();
+
+    // Registration, normally done by the sockets themselves: watch() on
+    // first async use, forget() before the fd is closed. forget() resumes
+    // anything still waiting on the fd with false.
+    bool watch(int fd);
+    void forget(int fd);
+
+    ReadinessAwaiter readable(int fd);
+    ReadinessAwaiter writable(int fd);
+
+    // Starts `task` right away; it runs until its first suspension, and the
+    // context keeps it alive until it finishes
+    void spawn(Task<void> task);
+    size_t getActiveTasks() const;
+
+    // run() returns after stop(); runUntilIdle() also returns once every
+    // spawned task has finished. A context runs once.
+    void run();
+    void runUntilIdle();
+    // Safe from any thread
+    void stop();
+};
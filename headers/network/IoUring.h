@@ -0,0 +1,173 @@
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// I/O engine used by the socket classes and the test servers.
+// IoUring is only a request: it silently stays on the plain syscall path
+// when the running kernel does not provide io_uring.
+enum class IoEngine {
+    Syscall,
+    IoUring
+};
+
+// Minimal io_uring wrapper on top of the raw syscalls (no liburing needed).
+class IoUring
+{
+private:
+    int ring_fd_;
+    unsigned entries_;
+
+    void *sq_ptr_;
+    size_t sq_size_;
+    void *cq_ptr_;
+    size_t cq_size_;
+    io_uring_sqe *sqes_;
+    size_t sqes_size_;
+
+    unsigned *sq_head_;
+    unsigned *sq_tail_;
+    unsigned *sq_mask_;
+    unsigned *sq_array_;
+    unsigned *cq_head_;
+    unsigned *cq_tail_;
+    unsigned *cq_mask_;
+    io_uring_cqe *cqes_;
+
+    // SQEs handed out by getSqe() but not yet passed to the kernel
+    unsigned sqe_tail_;
+    unsigned sqe_head_;
+
+    struct BufferRing {
+        io_uring_buf_ring *ring;
+        size_t ring_size;
+        char *buffers;
+        size_t buffers_size;
+        size_t buffer_size;
+        unsigned entries;
+        uint16_t group_id;
+    };
+    std::vector<BufferRing> buffer_rings_;
+
+public:
+    explicit IoUring(unsigned entries = 64);
+    ~IoUring();
+
+    IoUring(const IoUring &) = delete;
+    IoUring &operator=(const IoUring &) = delete;
+
+    bool init();
+    bool isValid() const;
+
+    // Runtime probes; results are cached per process
+    static bool isSupported();
+    // Multishot accept/recv and provided buffer rings (Linux 6.0+)
+    static bool isMultishotSupported();
+
+    // Submission: returns nullptr when the submission queue is full
+    io_uring_sqe *getSqe();
+    // Like getSqe(), but submits the queued SQEs first when the queue is full
+    io_uring_sqe *acquireSqe();
+    unsigned pendingSubmissions() const;
+    // How many more getSqe() calls succeed before the next submit()
+    unsigned freeSqes() const;
+    // Passes every prepared SQE to the kernel with a single io_uring_enter,
+    // optionally blocking until `wait_nr` completions are available.
+    // Returns the number of SQEs submitted, or -errno.
+    int submit(unsigned wait_nr = 0);
+
+    // Completion: peek the oldest CQE, then mark it consumed
+    io_uring_cqe *peekCompletion();
+    void completionSeen();
+    template <typename Fn>
+    unsigned forEachCompletion(Fn &&fn)
+    {
+        unsigned head = *cq_head_;
+        unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+        unsigned count = 0;
+        while (head != tail) {
+            fn(cqes_[head & *cq_mask_]);
+            ++head;
+            ++count;
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        return count;
+    }
+
+    // Fixed buffers for READ_FIXED/WRITE_FIXED
+    bool registerBuffers(const iovec *iovecs, unsigned count);
+
+    // Provided buffer ring for IOSQE_BUFFER_SELECT (used by multishot recv)
+    bool setupBufferRing(uint16_t group_id, unsigned entries, size_t buffer_size);
+    char *providedBuffer(uint16_t group_id, uint16_t buffer_id);
+    void recycleBuffer(uint16_t group_id, uint16_t buffer_id);
+
+    // SQE preparation helpers
+    static void prepare(io_uring_sqe *sqe, uint8_t opcode, int fd, const void *addr,
+                        unsigned len, uint64_t offset, uint64_t user_data);
+};
+
+// Per-socket io_uring state used by TCPSocket and UDPSocket.
+//
+// Outgoing data is copied into a registered send region and only queued;
+// queued sends are submitted on the next receive(), flush() or when the
+// region fills up, so a request/response round trip costs one
+// io_uring_enter instead of a send() plus a recv(). Stream data is
+// coalesced into a single WRITE_FIXED; datagrams keep their boundaries
+// and each becomes one SENDMSG.
+class IoUringChannel
+{
+private:
+    struct PendingSend {
+        size_t offset;
+        size_t length;
+        size_t sent;
+        bool datagram;
+        bool in_flight;
+        sockaddr_in peer;
+        iovec iov;
+        msghdr msg;
+    };
+
+    IoUring ring_;
+    size_t buffer_size_;
+    std::vector<char> send_region_;
+    std::vector<char> recv_region_;
+    size_t queued_bytes_;
+    unsigned in_flight_;
+    std::vector<PendingSend> pending_;
+    // io_uring_enter failed and in-flight requests could not be waited
+    // for; the channel refuses further I/O and keeps their memory as is
+    bool broken_;
+
+    // Leaves `reserve` SQEs free for the caller
+    void prepareSends(int fd, unsigned reserve = 0);
+    bool handleSendCompletion(const io_uring_cqe &cqe);
+    // After a failed io_uring_enter: waits for the sends in flight and
+    // `others` more completions (a receive and its timeout) before the
+    // memory they use is reset
+    void abandon(unsigned others);
+    void reset();
+
+public:
+    explicit IoUringChannel(size_t buffer_size = 65536);
+
+    bool init();
+
+    bool queueSend(int fd, const char *data, size_t size);
+    bool queueSendTo(int fd, const char *data, size_t size, const sockaddr_in &peer);
+    // Gathers `count` buffers into one datagram
+    bool queueSendTo(int fd, const iovec *iov, int count, const sockaddr_in &peer);
+    bool hasPending() const;
+    bool flush(int fd);
+
+    // Flushes queued sends and receives into `buffer` with one io_uring_enter.
+    // Returns bytes received, 0 on orderly shutdown, -1 on error with errno set
+    // (EAGAIN when `timeout_ms` > 0 expires first).
+    ssize_t receive(int fd, char *buffer, size_t size, long timeout_ms);
+};
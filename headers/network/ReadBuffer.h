@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Bytes read from a socket but not yet handed to the caller.
+//
+// Data lives in [begin, end) of a growable array; consumed space at the
+// front is reclaimed by sliding the remainder down only when a prepare()
+// would otherwise have to grow the array.
+class ReadBuffer
+{
+private:
+    std::vector<char> data_;
+    size_t begin_;
+    size_t end_;
+
+public:
+    ReadBuffer();
+
+    const char *data() const { return data_.data() + begin_; }
+    size_t size() const { return end_ - begin_; }
+    bool empty() const { return begin_ == end_; }
+
+    // Writable space for at least `size` bytes behind the buffered data;
+    // commit() then appends the bytes actually written there
+    char *prepare(size_t size);
+    // Writable space currently available behind the buffered data
+    size_t writable() const { return data_.size() - end_; }
+    void commit(size_t size);
+
+    void consume(size_t size);
+    // Copies up to `size` buffered bytes to `dest` and consumes them
+    size_t read(char *dest, size_t size);
+    // Removes and returns the first `size` buffered bytes
+    std::string take(size_t size);
+    void clear();
+};
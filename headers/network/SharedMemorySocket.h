@@ -0,0 +1,169 @@
+#pragma once
+#include "ISocket.h"
+#include "SocketStats.h"
+#include "UnixStreamSocket.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct ShmRing;
+
+// How a side that found its ring empty (or full) goes to sleep
+enum class ShmWakeup {
+    // futex() on a counter in the shared region: no descriptors, one
+    // syscall per wakeup
+    Futex,
+    // One eventfd per ring and direction, passed along with the region:
+    // costs a poll()/read() per sleep but notices a peer that died
+    // without closing immediately
+    EventFd,
+};
+
+// ISocket over a shared memory region holding two single-producer,
+// single-consumer byte rings, one per direction. Once connected, send()
+// and receive() are plain memory copies; the kernel is involved only when
+// a side has to sleep because its ring is empty (receive) or full (send),
+// and the other side wakes it. Behaves like a stream socket: message
+// boundaries are not kept and a send larger than the ring is delivered in
+// pieces as the peer drains it.
+//
+// `path` is the AF_UNIX control socket of a SharedMemoryAcceptor
+// (filesystem or '@'-prefixed abstract name). open() connects to it,
+// creates the region in a memfd and hands it over with SCM_RIGHTS; the
+// control connection stays open so either side notices when the other
+// goes away. Both ends must be on the same host, and each end is meant to
+// be used by one thread at a time.
+class SharedMemorySocket : public ISocket
+{
+private:
+    std::string path_;
+    UnixStreamSocket control_;
+    ShmWakeup wakeup_;
+    size_t ring_size_;
+    std::chrono::nanoseconds spin_time_;
+    int receive_timeout_ms_;
+    int send_timeout_ms_;
+
+    void *region_;
+    size_t region_size_;
+    ShmRing *out_;
+    ShmRing *in_;
+    char *out_data_;
+    char *in_data_;
+    // EventFd mode only: the peer waits on the *_data_ descriptor of the
+    // ring it reads and on the *_space_ one of the ring it writes
+    int out_data_event_;
+    int out_space_event_;
+    int in_data_event_;
+    int in_space_event_;
+
+    // Own positions, and the last seen positions of the peer, so the
+    // shared cache lines are touched only when the cached value runs out
+    uint64_t out_head_;
+    uint64_t out_tail_cache_;
+    uint64_t in_tail_;
+    uint64_t in_head_cache_;
+
+    // Null until setStatsEnabled(true)
+    std::unique_ptr<SocketStats> stats_;
+
+    friend class SharedMemoryAcceptor;
+    // Acceptor side of the handshake on an accepted control connection
+    bool attach(int fd);
+    // `events` are the four eventfds in ring order (data, space of ring 0,
+    // then of ring 1), or null in Futex mode
+    bool mapRegion(int memfd, size_t ring_size, int out_ring, const int *events);
+    void releaseRegion();
+
+    // A peer position outside the ring: logs, closes, sets errno EPROTO
+    void protocolError(const char *call);
+
+    // 1 when ready, 0 on timeout, -1 once the peer is gone
+    int waitForData(int timeout_ms);
+    int waitForSpace(int timeout_ms);
+
+public:
+    explicit SharedMemorySocket(const std::string &path);
+    virtual ~SharedMemorySocket() override;
+
+    SharedMemorySocket(const SharedMemorySocket &) = delete;
+    SharedMemorySocket &operator=(const SharedMemorySocket &) = delete;
+
+    // Per-direction capacity, rounded up to a power of two (at least
+    // 4 KB; 256 KB by default), and the wakeup mechanism. The connecting
+    // side picks both for the connection; call before open().
+    void setRingSize(size_t bytes);
+    void setWakeup(ShmWakeup wakeup);
+    // Busy-polls the ring this long before sleeping, trading a CPU for
+    // wakeup latency. Only pays off when both sides have a core of their
+    // own; 0 (the default) sleeps right away. Ignored on a single-CPU
+    // machine, where the spin would keep the peer from running.
+    void setSpinTime(std::chrono::nanoseconds spin);
+
+    // ISocket interface implementation
+    virtual bool open() override;
+    virtual void close() override;
+    virtual bool send(const std::string &data) override;
+    virtual std::string receive() override;
+    virtual bool send(const char *data, size_t size) override;
+    virtual ssize_t receive(char *buffer, size_t size) override;
+    virtual bool sendv(const iovec *iov, int count) override;
+    virtual ssize_t receivev(const iovec *iov, int count) override;
+    // The control connection: it only turns readable when the peer goes
+    // away, so SocketSet reports new data through getBufferedSize() alone
+    virtual int getSocketFd() const override;
+    // Bytes waiting in the receive ring
+    virtual size_t getBufferedSize() const override;
+
+    std::string receive(size_t max_size);
+
+    bool isConnected() const;
+    // No timeout (the default) waits until data arrives or the peer closes
+    bool setReceiveTimeout(int seconds);
+    bool setReceiveTimeout(std::chrono::milliseconds timeout);
+    // Longest wait for the peer to make room in a full ring (default: no
+    // limit). A send() that times out fails with errno EAGAIN; the part
+    // already copied into the ring is still delivered.
+    bool setSendTimeout(int seconds);
+    bool setSendTimeout(std::chrono::milliseconds timeout);
+
+    // Per-socket counters and histograms, off by default. Returns false
+    // when the library was built with NETWORK_SOCKET_STATS=OFF.
+    bool setStatsEnabled(bool enable);
+    const SocketStats *getStats() const;
+
+    size_t getRingSize() const;
+    ShmWakeup getWakeup() const;
+    const std::string &getPath() const;
+};
+
+
+// Listening control socket for SharedMemorySocket. Each accepted
+// connection finishes the handshake and comes back as a connected
+// SharedMemorySocket using the region its peer created.
+class SharedMemoryAcceptor
+{
+private:
+    std::string path_;
+    int backlog_;
+    int listen_fd_;
+
+public:
+    explicit SharedMemoryAcceptor(const std::string &path, int backlog = SOMAXCONN);
+    ~SharedMemoryAcceptor();
+
+    SharedMemoryAcceptor(const SharedMemoryAcceptor &) = delete;
+    SharedMemoryAcceptor &operator=(const SharedMemoryAcceptor &) = delete;
+
+    // Replaces a stale socket file; close() removes it again
+    bool listen();
+    void close();
+
+    // The next connection, or null on timeout (-1 waits forever), when
+    // the handshake fails or once the acceptor is closed
+    std::unique_ptr<SharedMemorySocket> accept(int timeout_ms = -1);
+
+    int getSocketFd() const;
+    const std::string &getPath() const;
+};
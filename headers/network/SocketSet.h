@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ISocket.h"
+#include <chrono>
+#include <cstdint>
+#include <poll.h>
+#include <unordered_map>
+#include <vector>
+
+// Readiness wait over many sockets at once.
+//
+// Deadlines are steady_clock time points and timeouts are microseconds; the
+// wait itself uses ppoll() or epoll_pwait2(), both with nanosecond timeouts
+// on the monotonic clock, so there is no FD_SETSIZE limit and no rounding
+// to whole seconds or milliseconds. Sockets holding bytes a receiveUntil()
+// read past are reported readable without waiting.
+//
+// Sockets are tracked by their current fd: re-add a socket after reopening
+// it. io_uring sockets should flush() queued sends before a wait.
+class SocketSet
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Event : uint32_t {
+        Read = 1,
+        Write = 2,
+        // Reported only: error or hang-up on the socket
+        Error = 4
+    };
+
+    enum class Backend {
+        Poll,
+        Epoll
+    };
+
+    struct Ready {
+        ISocket *socket;
+        uint32_t events;
+    };
+
+private:
+    struct Entry {
+        ISocket *socket;
+        int fd;
+        uint32_t interest;
+    };
+
+    Backend backend_;
+    int epoll_fd_;
+    std::vector<Entry> entries_;
+    std::unordered_map<int, size_t> index_; // fd -> entries_ slot
+    std::vector<pollfd> poll_fds_;
+    std::vector<Ready> ready_;
+
+    int waitPoll(Clock::time_point deadline, bool forever);
+    int waitEpoll(Clock::time_point deadline, bool forever);
+
+public:
+    explicit SocketSet(Backend backend = Backend::Poll);
+    ~SocketSet();
+
+    SocketSet(const SocketSet &) = delete;
+    SocketSet &operator=(const SocketSet &) = delete;
+
+    // `interest` is a mask of Read and Write
+    bool add(ISocket *socket, uint32_t interest = Read);
+    bool modify(ISocket *socket, uint32_t interest);
+    void remove(ISocket *socket);
+    void clear();
+    size_t size() const;
+    Backend getBackend() const;
+
+    // Waits until a socket is ready or the time is up. Returns the number of
+    // ready sockets (listed by ready()), 0 on timeout, -1 on error. A
+    // negative timeout waits indefinitely.
+    int wait(std::chrono::microseconds timeout);
+    int waitUntil(Clock::time_point deadline);
+    const std::vector<Ready> &ready() const;
+
+    // Single-fd wait for the socket classes' own timeout methods. Returns
+    // the Event mask that became ready, 0 on timeout, -1 on error.
+    static int waitFd(int fd, uint32_t interest, std::chrono::microseconds timeout);
+};
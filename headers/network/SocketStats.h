@@ -0,0 +1,177 @@
+#pragma once
+
+#include "SyscallCounter.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Socket instrumentation is compiled in unless this is 0 (set with
+// -DNETWORK_SOCKET_STATS=OFF at configure time); without it every SocketOp
+// is an empty inline object and nothing is recorded
+#ifndef NETWORK_SOCKET_STATS
+#define NETWORK_SOCKET_STATS 1
+#endif
+
+// Lock-free log-linear (HDR-style) histogram.
+//
+// Values below 16 get their own bucket; above that every power of two is
+// split into 16 linear sub-buckets, so a recorded value is known to within
+// 1/16 (~6%). Values of 2^40 and more land in the last bucket.
+class StatsHistogram
+{
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxBits = 40;
+    static constexpr int kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    struct Snapshot {
+        uint64_t count;
+        uint64_t sum;
+        uint64_t max;
+        std::vector<uint64_t> buckets;
+
+        double mean() const;
+        // Upper bound of the bucket holding the given fraction of values
+        uint64_t percentile(double fraction) const;
+    };
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_;
+    std::atomic<uint64_t> max_;
+
+public:
+    StatsHistogram();
+
+    void record(uint64_t value, uint64_t count = 1);
+    Snapshot snapshot() const;
+    void reset();
+
+    static size_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(size_t index);
+};
+
+// Counters and histograms for one socket, or for all of them (global()).
+// Every field is an independent relaxed atomic: a snapshot taken while
+// sockets are busy is consistent per field, not across fields.
+class SocketStats
+{
+public:
+    struct Counters {
+        uint64_t bytes_sent;
+        uint64_t bytes_received;
+        uint64_t messages_sent;     // completed send calls, datagrams for UDP
+        uint64_t messages_received; // receive calls that returned data
+        uint64_t syscalls;
+        uint64_t eagain_retries;    // EAGAIN retries and receive timeouts
+        uint64_t errors;
+    };
+
+    struct Snapshot {
+        Counters counters;
+        StatsHistogram::Snapshot send_latency_ns;
+        StatsHistogram::Snapshot receive_latency_ns;
+        StatsHistogram::Snapshot send_size;
+        StatsHistogram::Snapshot receive_size;
+
+        std::string toJson() const;
+    };
+
+private:
+    std::atomic<uint64_t> bytes_sent_;
+    std::atomic<uint64_t> bytes_received_;
+    std::atomic<uint64_t> messages_sent_;
+    std::atomic<uint64_t> messages_received_;
+    std::atomic<uint64_t> syscalls_;
+    std::atomic<uint64_t> eagain_retries_;
+    std::atomic<uint64_t> errors_;
+    StatsHistogram send_latency_;
+    StatsHistogram receive_latency_;
+    StatsHistogram send_size_;
+    StatsHistogram receive_size_;
+
+    static std::atomic<bool> global_enabled_;
+
+public:
+    SocketStats();
+
+    void record(bool send, uint64_t bytes, uint64_t messages, uint64_t latency_ns, uint64_t syscalls,
+                uint64_t retries, bool failed);
+    Snapshot snapshot() const;
+    void reset();
+
+    // Totals over every socket; collected only while enabled (default off)
+    static SocketStats &global();
+    static void setGlobalEnabled(bool enable);
+    static bool isGlobalEnabled() { return global_enabled_.load(std::memory_order_relaxed); }
+};
+
+// Times one socket call and records it into the socket's stats and, while
+// enabled, the global ones. Syscalls are the calling thread's
+// SyscallCounter delta, so io_uring submissions are included.
+class SocketOp
+{
+public:
+    enum Kind { Send, Receive };
+
+#if NETWORK_SOCKET_STATS
+private:
+    SocketStats *stats_;
+    SocketStats *global_;
+    Kind kind_;
+    std::chrono::steady_clock::time_point start_;
+    uint64_t syscalls_;
+    uint64_t bytes_;
+    uint64_t messages_;
+    uint64_t retries_;
+    bool failed_;
+
+public:
+    SocketOp(SocketStats *stats, Kind kind)
+        : stats_(stats), global_(SocketStats::isGlobalEnabled() ? &SocketStats::global() : nullptr), kind_(kind),
+          syscalls_(0), bytes_(0), messages_(0), retries_(0), failed_(false)
+    {
+        if (stats_ || global_) {
+            start_ = std::chrono::steady_clock::now();
+            syscalls_ = SyscallCounter::get();
+        }
+    }
+
+    ~SocketOp()
+    {
+        if (!stats_ && !global_) {
+            return;
+        }
+        uint64_t latency_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_).count());
+        uint64_t syscalls = SyscallCounter::get() - syscalls_;
+        if (stats_) {
+            stats_->record(kind_ == Send, bytes_, messages_, latency_ns, syscalls, retries_, failed_);
+        }
+        if (global_) {
+            global_->record(kind_ == Send, bytes_, messages_, latency_ns, syscalls, retries_, failed_);
+        }
+    }
+
+    void complete(uint64_t bytes, uint64_t messages = 1)
+    {
+        bytes_ += bytes;
+        messages_ += messages;
+    }
+    void retry() { ++retries_; }
+    void fail() { failed_ = true; }
+#else
+    SocketOp(SocketStats *, Kind) {}
+    void complete(uint64_t, uint64_t = 1) {}
+    void retry() {}
+    void fail() {}
+#endif
+
+    SocketOp(const SocketOp &) = delete;
+    SocketOp &operator=(const SocketOp &) = delete;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+
+// Declarative TCP socket options, applied in one go by TCPSocket::open()
+// and SimpleServer::start(). A field left at -1 keeps the kernel default.
+//
+// Server-side profiles are set on the listener: Linux copies the options
+// to every accepted connection, and buffer sizes must be in place before
+// listen() and connect() to take part in window scaling. TCP_QUICKACK is
+// not sticky; the kernel drops back to delayed ACKs on its own.
+struct SocketTuning {
+    int no_delay = -1;              // TCP_NODELAY: 1 sends small segments at once
+    int cork = -1;                  // TCP_CORK: 1 holds partial segments until uncorked
+    int quick_ack = -1;             // TCP_QUICKACK
+    int send_buffer = -1;           // SO_SNDBUF, bytes (the kernel doubles it)
+    int receive_buffer = -1;        // SO_RCVBUF, bytes (the kernel doubles it)
+    int busy_poll_us = -1;          // SO_BUSY_POLL; raising it needs CAP_NET_ADMIN
+    int not_sent_lowat = -1;        // TCP_NOTSENT_LOWAT, bytes
+    int priority = -1;              // SO_PRIORITY, 0-6 without CAP_NET_ADMIN
+    int keepalive = -1;             // SO_KEEPALIVE
+    int keepalive_idle_s = -1;      // TCP_KEEPIDLE
+    int keepalive_interval_s = -1;  // TCP_KEEPINTVL
+    int keepalive_count = -1;       // TCP_KEEPCNT
+
+    // Small request/response traffic: no Nagle or delayed ACK, busy
+    // polling, a shallow unsent queue and quick dead-peer detection
+    static SocketTuning lowLatency();
+    // Large transfers: big buffers and Nagle left on
+    static SocketTuning bulkThroughput();
+
+    // Sets every configured option on `fd`. A failing option is logged and
+    // skipped; returns false if any failed.
+    bool apply(int fd) const;
+    // "name=value" for every configured option, for logs and benchmarks
+    std::string describe() const;
+};
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+// Socket and io_uring syscalls the library issued on the calling thread.
+// Thread-local, so counting costs no shared cache line; benchmarks read it
+// before and after a workload to report syscalls per message.
+class SyscallCounter
+{
+public:
+    static void add(uint64_t count = 1);
+    static uint64_t get();
+};
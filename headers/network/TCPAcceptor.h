@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SocketTuning.h"
+#include "TCPSocket.h"
+#include "Task.h"
+#include <memory>
+#include <sys/socket.h>
+
+class IoContext;
+
+// Listening TCP socket for the coroutine API: asyncAccept() hands out each
+// incoming connection as a TCPSocket, ready for its own async calls on the
+// same IoContext.
+class TCPAcceptor
+{
+private:
+    int port_;
+    int backlog_;
+    int listen_fd_;
+    SocketTuning tuning_;
+    IoContext *io_context_;
+
+public:
+    // Port 0 picks an ephemeral port; see getPort()
+    explicit TCPAcceptor(int port, int backlog = SOMAXCONN);
+    ~TCPAcceptor();
+
+    TCPAcceptor(const TCPAcceptor &) = delete;
+    TCPAcceptor &operator=(const TCPAcceptor &) = delete;
+
+    // Options for the listener, inherited by accepted connections. Must be
+    // called before listen().
+    void setTuning(const SocketTuning &tuning);
+    // Binds INADDR_ANY with SO_REUSEADDR and starts listening
+    bool listen();
+    void close();
+
+    // The next connection, or null once the acceptor is closed or on error
+    Task<std::unique_ptr<TCPSocket>> asyncAccept(IoContext &io);
+
+    int getPort() const;
+    int getSocketFd() const;
+};
@@ -1,19 +1,91 @@
 #pragma once
 
 #include "ISocket.h"
+#include "IoUring.h"
+#include "BufferPool.h"
+#include "ReadBuffer.h"
+#include "SocketStats.h"
+#include "SocketTuning.h"
+#include "Task.h"
+#include <chrono>
+#include <deque>
+#include <memory>
 #include <string>
+#include <vector>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <cstring>
 #include <errno.h>
 
+class IoContext;
+
 class TCPSocket : public ISocket
 {
+public:
+    // Payloads below this are copied even in zero-copy mode: pinning pages
+    // and reaping the completion costs more than the copy
+    static constexpr size_t kZeroCopyThreshold = 16 * 1024;
+    // How long close() waits for outstanding zero-copy completions
+    static constexpr int kZeroCopyLingerMs = 1000;
+
+    struct ZeroCopyStats {
+        uint64_t zerocopy_sends;  // sendZeroCopy() calls sent with MSG_ZEROCOPY
+        uint64_t copied_sends;    // below the threshold, or zero copy off
+        uint64_t completions;     // notifications reaped from the error queue
+        uint64_t deferred_copies; // completions where the kernel copied anyway
+    };
+
 private:
+    // A zero-copy payload the kernel may still read from. `owner` keeps it
+    // alive until the notifications for all `calls` send() ids arrived.
+    struct ZeroCopyBuffer {
+        uint32_t first_id;
+        uint32_t calls;
+        uint32_t outstanding;
+        std::shared_ptr<const void> owner;
+    };
+
     std::string address_;
     int port_;
     int sockfd_;
+    int receive_timeout_ms_;
+    // A non-blocking connect() is in flight (openAsync())
+    bool connecting_;
+    std::unique_ptr<IoUringChannel> uring_;
+    // Bytes received past the delimiter of a receiveUntil(); every receive
+    // call returns these before reading the socket again
+    ReadBuffer read_buffer_;
+    // Null until setStatsEnabled(true)
+    std::unique_ptr<SocketStats> stats_;
+    SocketTuning tuning_;
+    // Set by the first async call; the fd is registered there until close()
+    IoContext *io_context_;
+    // Kernel pipe spliceTo() relays through, created on first use
+    int relay_pipe_[2];
+    bool zerocopy_;
+    size_t zerocopy_threshold_;
+    // Notification id the next MSG_ZEROCOPY send() gets; counts from 0 per
+    // socket
+    uint32_t zerocopy_next_id_;
+    std::deque<ZeroCopyBuffer> zerocopy_pending_;
+    ZeroCopyStats zerocopy_stats_;
+
+    ssize_t readSocket(char *buffer, size_t size);
+    // One non-blocking send() for the async path; -1 with EAGAIN when full
+    ssize_t writeSocket(const char *data, size_t size);
+    // Moves `size` bytes from relay_pipe_ to `out_fd`
+    bool drainRelayPipe(int out_fd, size_t size, bool more);
+    void closeRelayPipe();
+    bool applyZeroCopy();
+    void completeZeroCopy(uint32_t first, uint32_t last);
+    // Creates the socket and issues connect(). With `non_blocking` an
+    // in-progress connect returns true with connecting_ set.
+    bool startConnect(bool non_blocking);
+    // Collects the result of an in-progress connect once the fd is writable
+    bool finishConnect(bool blocking = true);
+    bool attachContext(IoContext &io);
+    void detachContext(int fd);
 
 public:
     TCPSocket(const std::string &address, int port);
@@ -24,19 +96,111 @@ public:
     virtual void close() override;
     virtual bool send(const std::string &data) override;
     virtual std::string receive() override;
+    virtual bool send(const char *data, size_t size) override;
+    virtual ssize_t receive(char *buffer, size_t size) override;
+    virtual bool sendv(const iovec *iov, int count) override;
+    virtual ssize_t receivev(const iovec *iov, int count) override;
+    virtual size_t getBufferedSize() const override;
+
+    // Connection establishment with a deadline. open(timeout_ms) fails with
+    // ETIMEDOUT once `timeout_ms` passes instead of waiting out the kernel's
+    // SYN retries. openAsync() only starts the connect; completeOpen() waits
+    // for it.
+    bool open(int timeout_ms);
+    bool openAsync();
+    bool completeOpen(int timeout_ms);
+    bool isOpening() const;
+    // Connects all `sockets` concurrently from the calling thread under one
+    // shared deadline. Returns how many opened; the others are left closed.
+    static size_t openAll(const std::vector<TCPSocket *> &sockets, int timeout_ms);
+
+    // Coroutine API, driven by `io` on its thread. The first call switches
+    // the socket to non-blocking mode and registers it with `io` until
+    // close(); the blocking methods then spin on EAGAIN, so do not mix the
+    // two on one socket. io_uring sockets fall back to syscalls. Results
+    // match the blocking counterparts; receives wait without a timeout
+    // until data, end of stream or close() from another coroutine.
+    Task<bool> asyncOpen(IoContext &io);
+    Task<bool> asyncSend(IoContext &io, const char *data, size_t size);
+    Task<bool> asyncSend(IoContext &io, std::string data);
+    Task<ssize_t> asyncReceive(IoContext &io, char *buffer, size_t size);
+    Task<std::string> asyncReceive(IoContext &io, size_t max_size = 4096);
+    Task<std::string> asyncReceiveUntil(IoContext &io, std::string delimiter, size_t max_size = 65536);
+    // Takes ownership of an already connected fd, e.g. from accept()
+    bool adopt(int fd);
 
     // Additional TCP-specific methods
     bool isConnected() const;
+    // Receives into a pooled block, then copies what arrived into a new
+    // string; the receive(PooledBuffer &) overload skips that allocation
     std::string receive(size_t max_size);
+    // Receives up to one block into a fresh BufferPool::local() block held
+    // by `block`; returns the byte count as receive(char *, size_t) does,
+    // leaving `block` empty when nothing arrived
+    ssize_t receive(PooledBuffer &block);
     std::string receiveWithTimeout(int timeout_seconds, size_t max_size = 4096);
+    std::string receiveWithTimeout(std::chrono::microseconds timeout, size_t max_size = 4096);
     std::string receiveUntil(const std::string &delimiter, size_t max_size = 65536);
+    // Reads exactly `size` bytes, looping over short reads. On timeout the
+    // bytes that did arrive stay buffered for the next receive call.
+    bool receiveExact(char *buffer, size_t size);
+    std::string receiveExact(size_t size);
+
+    // Zero-copy transfers. sendFile() sends `length` bytes of `file_fd`
+    // starting at `offset` with sendfile(2); the file's own offset is left
+    // alone. spliceTo() moves up to `length` bytes received on this socket
+    // to `out_fd` (a socket, pipe or file) with splice(2), stopping early
+    // at end of stream; it returns the bytes moved, or -1 on error or when
+    // nothing arrived before the receive timeout. Neither raises SIGPIPE.
+    bool sendFile(int file_fd, off_t offset, size_t length);
+    ssize_t spliceTo(int out_fd, size_t length);
+    ssize_t spliceTo(TCPSocket &destination, size_t length);
+
+    // MSG_ZEROCOPY sends, opt-in. The kernel transmits straight from the
+    // caller's pages, so sendZeroCopy() takes shared ownership of the
+    // payload and holds it until the completion is reaped from the error
+    // queue: by reapZeroCopy() (non-blocking, also run by every
+    // sendZeroCopy()), waitZeroCopy() or close(). Payloads smaller than
+    // `threshold` are copied as usual. Pending completions make the socket
+    // report an error event in poll/SocketSet until reaped. Loopback peers
+    // always get a deferred copy (see deferred_copies).
+    bool setZeroCopy(bool enable, size_t threshold = kZeroCopyThreshold);
+    bool isZeroCopyEnabled() const;
+    bool sendZeroCopy(const char *data, size_t size, std::shared_ptr<const void> owner);
+    bool sendZeroCopy(std::shared_ptr<const std::string> data);
+    bool sendZeroCopy(const PooledBuffer &block, size_t size);
+    // Returns the number of payloads released
+    size_t reapZeroCopy();
+    // Waits until every payload is released; false on timeout, or at once
+    // with errno set when the socket has an error
+    bool waitZeroCopy(int timeout_ms);
+    size_t getZeroCopyPending() const;
+    ZeroCopyStats getZeroCopyStats() const;
 
     // Socket configuration methods
-    int getSocketFd() const;
+    virtual int getSocketFd() const override;
     bool setSocketOption(int level, int optname, const void *optval, socklen_t optlen);
     bool setKeepAlive(bool enable);
+    // Needs an open socket; fails without changing anything otherwise
     bool setReceiveTimeout(int seconds);
     bool setSendTimeout(int seconds);
+    // Options set on every open() before connecting, and right away when
+    // the socket is already open (false if an option failed there)
+    bool setTuning(const SocketTuning &tuning);
+    const SocketTuning &getTuning() const;
+
+    // I/O engine selection. With IoEngine::IoUring, send() only queues data;
+    // it is submitted together with the next receive (one io_uring_enter per
+    // round trip), on flush() or on close(). Returns false and keeps the
+    // syscall path when io_uring is unavailable.
+    bool setIoEngine(IoEngine engine);
+    IoEngine getIoEngine() const;
+    bool flush();
+
+    // Per-socket counters and histograms, off by default. Returns false
+    // when the library was built with NETWORK_SOCKET_STATS=OFF.
+    bool setStatsEnabled(bool enable);
+    const SocketStats *getStats() const;
 
     // Connection info
     std::string getAddress() const;
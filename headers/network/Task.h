@@ -0,0 +1,128 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+// Lazily started coroutine returning T.
+//
+// A Task does nothing until it is co_awaited; the awaiting coroutine is
+// resumed (by symmetric transfer, so deep chains do not grow the stack)
+// when the task finishes. The Task object owns the coroutine frame.
+// Top-level tasks are started with IoContext::spawn(). The library does
+// not use exceptions: one escaping a task terminates the process.
+//
+// GCC 12 miscompiles a co_await written directly in an if/while condition
+// (the awaited value is lost); bind the result to a local first.
+template <typename T>
+class Task;
+
+namespace TaskDetail {
+
+    // Resumes whoever awaited the finished task
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+        {
+            std::coroutine_handle<> continuation = handle.promise().continuation;
+            return continuation ? continuation : std::noop_coroutine();
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    struct PromiseBase {
+        std::coroutine_handle<> continuation;
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        FinalAwaiter final_suspend() const noexcept { return {}; }
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    template <typename T>
+    struct Promise : PromiseBase {
+        T value{};
+
+        Task<T> get_return_object();
+        void return_value(T result) { value = std::move(result); }
+        T take() { return std::move(value); }
+    };
+
+    template <>
+    struct Promise<void> : PromiseBase {
+        Task<void> get_return_object();
+        void return_void() const noexcept {}
+        void take() const noexcept {}
+    };
+
+}
+
+template <typename T = void>
+class Task
+{
+public:
+    using promise_type = TaskDetail::Promise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+private:
+    Handle handle_;
+
+public:
+    Task() : handle_(nullptr) {}
+    explicit Task(Handle handle) : handle_(handle) {}
+    Task(Task &&other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    ~Task()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    bool valid() const { return handle_ != nullptr; }
+    bool done() const { return !handle_ || handle_.done(); }
+
+    auto operator co_await() noexcept
+    {
+        struct Awaiter {
+            Handle handle;
+
+            bool await_ready() const noexcept { return !handle || handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+            {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle_};
+    }
+};
+
+namespace TaskDetail {
+
+    template <typename T>
+    Task<T> Promise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> Promise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+    }
+
+}
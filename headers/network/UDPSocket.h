@@ -10,10 +10,29 @@
 
 #pragma once
 #include "../headers/network/ISocket.h"
+#include "BufferPool.h"
+#include "IoUring.h"
+#include "ReadBuffer.h"
+#include "SocketStats.h"
+#include "Task.h"
+#include <cstdint>
+#include <chrono>
+#include <memory>
 #include <string>
 #include <sys/socket.h>
 #include <netinet/in.h>
 
+// One datagram of a sendBatch()/receiveBatch() call
+struct UDPDatagram {
+    char *data;
+    size_t size;        // payload size to send, or buffer capacity to receive into
+    size_t length;      // bytes received (receiveBatch only)
+    sockaddr_in peer;   // destination, or sender on receive; a zeroed peer
+                        // sends to the socket's own address
+};
+
+class IoContext;
+
 class UDPSocket : public ISocket
 {
 private:
@@ -21,6 +40,21 @@ private:
     int port_;
     int sockfd_;
     sockaddr_in server_addr_;
+    int receive_timeout_ms_;
+    bool gso_supported_;
+    bool gro_enabled_;
+    std::unique_ptr<IoUringChannel> uring_;
+    // Bytes received past the delimiter of a receiveUntil(); every receive
+    // call returns these before reading the socket again
+    ReadBuffer read_buffer_;
+    // Null until setStatsEnabled(true)
+    std::unique_ptr<SocketStats> stats_;
+    // Set by the first async call; the fd is registered there until close()
+    IoContext *io_context_;
+
+    ssize_t readSocket(char *buffer, size_t size);
+    bool attachContext(IoContext &io);
+    void detachContext(int fd);
 
 public:
     UDPSocket(const std::string &address, int port);
@@ -31,19 +65,74 @@ public:
     virtual void close() override;
     virtual bool send(const std::string &data) override;
     virtual std::string receive() override;
+    virtual bool send(const char *data, size_t size) override;
+    virtual ssize_t receive(char *buffer, size_t size) override;
+    virtual bool sendv(const iovec *iov, int count) override;
+    virtual ssize_t receivev(const iovec *iov, int count) override;
+    virtual size_t getBufferedSize() const override;
+
+    // Coroutine API, driven by `io` on its thread; see TCPSocket. A send
+    // is one datagram, a receive returns one datagram.
+    Task<bool> asyncSend(IoContext &io, const char *data, size_t size);
+    Task<bool> asyncSend(IoContext &io, std::string data);
+    Task<ssize_t> asyncReceive(IoContext &io, char *buffer, size_t size);
+    Task<std::string> asyncReceive(IoContext &io, size_t max_size = 4096);
 
     // Additional UDP-specific methods
     bool isConnected() const;
+    // Receives into a pooled block, then copies what arrived into a new
+    // string; the receive(PooledBuffer &) overload skips that allocation
     std::string receive(size_t max_size);
+    // Receives up to one block into a fresh BufferPool::local() block held
+    // by `block`; returns the byte count as receive(char *, size_t) does,
+    // leaving `block` empty when nothing arrived
+    ssize_t receive(PooledBuffer &block);
     std::string receiveWithTimeout(int timeout_seconds, size_t max_size = 4096);
+    std::string receiveWithTimeout(std::chrono::microseconds timeout, size_t max_size = 4096);
     std::string receiveUntil(const std::string &delimiter, size_t max_size = 65536);
 
+    // Batched I/O: many datagrams per sendmmsg()/recvmmsg() call.
+    // sendBatch() returns how many datagrams were sent, -1 if none could be.
+    // receiveBatch() blocks for the first datagram only, then takes whatever
+    // else is already queued; returns the number received or -1 with errno.
+    static constexpr int kMaxBatch = 64;
+    int sendBatch(UDPDatagram *datagrams, int count);
+    int receiveBatch(UDPDatagram *datagrams, int count);
+
+    // Segmentation offload for bulk streams.
+    // sendSegmented() sends `size` bytes as consecutive datagrams of
+    // `segment_size` bytes (the last one may be shorter), handing the kernel
+    // up to 64 segments per sendmsg() via UDP_SEGMENT. Without kernel GSO
+    // support it falls back to sendmmsg().
+    bool sendSegmented(const char *data, size_t size, uint16_t segment_size);
+    // With GRO enabled the kernel may coalesce datagrams from one sender
+    // into a single read, so plain receive() loses the boundaries; use
+    // receiveSegments(), which splits the buffer back into datagrams that
+    // point into `buffer`. Returns the datagram count or -1 with errno.
+    bool setGroEnabled(bool enable);
+    bool isGroEnabled() const;
+    int receiveSegments(char *buffer, size_t size, UDPDatagram *datagrams, int max_datagrams);
+
     // Socket configuration methods
-    int getSocketFd() const;
+    virtual int getSocketFd() const override;
     bool setSocketOption(int level, int optname, const void *optval, socklen_t optlen);
+    // Needs an open socket; fails without changing anything otherwise
     bool setReceiveTimeout(int seconds);
     bool setSendTimeout(int seconds);
 
+    // I/O engine selection. With IoEngine::IoUring, send() only queues data;
+    // it is submitted together with the next receive (one io_uring_enter per
+    // round trip), on flush() or on close(). Returns false and keeps the
+    // syscall path when io_uring is unavailable.
+    bool setIoEngine(IoEngine engine);
+    IoEngine getIoEngine() const;
+    bool flush();
+
+    // Per-socket counters and histograms, off by default. Returns false
+    // when the library was built with NETWORK_SOCKET_STATS=OFF.
+    bool setStatsEnabled(bool enable);
+    const SocketStats *getStats() const;
+
     // Connection info
     std::string getAddress() const;
     int getPort() const;
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+// AF_UNIX addresses for UnixStreamSocket, UnixDatagramSocket and the Unix
+// echo servers. A path starting with '@' names a socket in the Linux
+// abstract namespace: nothing is created on disk, and the name disappears
+// with the last socket bound to it.
+namespace UnixAddress {
+    // Returns false (and logs) for an empty path or one too long for sun_path
+    bool fill(const std::string& path, sockaddr_un& address, socklen_t& length);
+    // Inverse of fill(); empty for an unnamed socket
+    std::string toPath(const sockaddr_un& address, socklen_t length);
+    bool isAbstract(const std::string& path);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "ISocket.h"
+#include "SocketStats.h"
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+
+// ISocket over an AF_UNIX datagram socket connected to `path` (a
+// filesystem or '@'-prefixed abstract name, see UnixAddress). Every send
+// is one datagram and every receive returns one. Unlike UDP, datagrams are
+// never dropped or reordered on the way: a sender blocks while the
+// receiver's queue is full.
+//
+// A peer can only answer a named socket, so open() binds to setLocalPath()
+// or, by default, to an abstract name the kernel picks.
+class UnixDatagramSocket : public ISocket
+{
+private:
+    std::string path_;
+    std::string local_path_;
+    int sockfd_;
+    // open() created local_path_ on disk and close() removes it
+    bool owns_file_;
+    std::unique_ptr<SocketStats> stats_;
+
+public:
+    explicit UnixDatagramSocket(const std::string &path);
+    virtual ~UnixDatagramSocket() override;
+
+    // ISocket interface implementation
+    virtual bool open() override;
+    virtual void close() override;
+    virtual bool send(const std::string &data) override;
+    virtual std::string receive() override;
+    virtual bool send(const char *data, size_t size) override;
+    virtual ssize_t receive(char *buffer, size_t size) override;
+    virtual bool sendv(const iovec *iov, int count) override;
+    virtual ssize_t receivev(const iovec *iov, int count) override;
+    virtual int getSocketFd() const override;
+    // Nothing is read ahead, so always 0
+    virtual size_t getBufferedSize() const override;
+
+    std::string receive(size_t max_size);
+    bool isConnected() const;
+
+    // Name to bind on open(); must be called before open()
+    void setLocalPath(const std::string &path);
+    // The bound name once open, e.g. "@0003f" when autobound
+    std::string getLocalPath() const;
+
+    bool setReceiveTimeout(int seconds);
+    bool setSendTimeout(int seconds);
+
+    // Per-socket counters and histograms, off by default. Returns false
+    // when the library was built with NETWORK_SOCKET_STATS=OFF.
+    bool setStatsEnabled(bool enable);
+    const SocketStats *getStats() const;
+
+    const std::string &getPath() const;
+};
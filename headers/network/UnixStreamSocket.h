@@ -0,0 +1,62 @@
+#pragma once
+#include "ISocket.h"
+#include "SocketStats.h"
+#include <memory>
+#include <string>
+#include <sys/socket.h>
+
+// ISocket over a connected AF_UNIX stream socket, for peers on the same
+// host: data is copied straight into the peer's receive queue, with no
+// TCP/IP stack, checksums or loopback routing in the path. `path` names a
+// filesystem socket or, with a leading '@', an abstract one (see
+// UnixAddress). Calls block unless a timeout is set.
+class UnixStreamSocket : public ISocket
+{
+private:
+    std::string path_;
+    int sockfd_;
+    // Null until setStatsEnabled(true)
+    std::unique_ptr<SocketStats> stats_;
+
+public:
+    explicit UnixStreamSocket(const std::string &path);
+    virtual ~UnixStreamSocket() override;
+
+    // ISocket interface implementation
+    virtual bool open() override;
+    virtual void close() override;
+    virtual bool send(const std::string &data) override;
+    virtual std::string receive() override;
+    virtual bool send(const char *data, size_t size) override;
+    virtual ssize_t receive(char *buffer, size_t size) override;
+    virtual bool sendv(const iovec *iov, int count) override;
+    virtual ssize_t receivev(const iovec *iov, int count) override;
+    virtual int getSocketFd() const override;
+    // Nothing is read ahead, so always 0
+    virtual size_t getBufferedSize() const override;
+
+    std::string receive(size_t max_size);
+
+    // Descriptor passing (SCM_RIGHTS). sendFds() sends `data` (at least one
+    // byte) with up to kMaxFds descriptors attached; the receiver gets its
+    // own duplicates. receiveFds() works like receive() and stores the
+    // descriptors that came with the data in `fds`, closing any beyond
+    // `max_fds`.
+    static constexpr int kMaxFds = 16;
+    bool sendFds(const char *data, size_t size, const int *fds, int count);
+    ssize_t receiveFds(char *buffer, size_t size, int *fds, int max_fds, int &fd_count);
+
+    // Takes over an accepted connection, switched to blocking mode
+    bool adopt(int fd);
+    bool isConnected() const;
+
+    bool setReceiveTimeout(int seconds);
+    bool setSendTimeout(int seconds);
+
+    // Per-socket counters and histograms, off by default. Returns false
+    // when the library was built with NETWORK_SOCKET_STATS=OFF.
+    bool setStatsEnabled(bool enable);
+    const SocketStats *getStats() const;
+
+    const std::string &getPath() const;
+};
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own bounded deque.
+//
+// submit() appends to one worker's deque, picked from the caller's hint so
+// related jobs tend to share a worker. The owner takes jobs from the front
+// (oldest first); a worker with nothing to do steals from the back of the
+// others, so a burst aimed at one deque still spreads over every thread.
+// When every deque is full submit() refuses the job instead of growing:
+// backing off is up to the caller. Jobs submitted from a worker go to that
+// worker's own deque first.
+class WorkStealingPool
+{
+public:
+    using Job = std::function<void()>;
+
+    static constexpr size_t kAnyWorker = static_cast<size_t>(-1);
+
+    struct Stats {
+        uint64_t executed;
+        uint64_t stolen;    // executed by a worker other than the one queued on
+        uint64_t rejected;  // submit() calls refused because every deque was full
+        size_t queued;
+    };
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    size_t thread_count_;
+    size_t queue_capacity_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_worker_;
+    std::atomic<bool> running_;
+    // Held shared by submit() across its running_ check and push, and
+    // exclusively by stop() to clear running_: a job is either refused or
+    // counted in queued_ before the workers may exit
+    std::shared_mutex submit_mutex_;
+
+    // Idle workers sleep here until something is queued
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_;
+    std::atomic<size_t> sleepers_;
+
+    std::atomic<uint64_t> executed_;
+    std::atomic<uint64_t> stolen_;
+    std::atomic<uint64_t> rejected_;
+
+    void workerLoop(size_t index);
+    bool pushTo(size_t index, Job &job);
+    bool takeOwn(size_t index, Job &job);
+    bool steal(size_t thief, Job &job);
+
+public:
+    explicit WorkStealingPool(size_t threads, size_t queue_capacity = 1024);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    bool start();
+    // Runs whatever is still queued, then joins the workers
+    void stop();
+
+    // Safe from any thread; false when the pool is stopped or full
+    bool submit(Job job, size_t hint = kAnyWorker);
+
+    size_t getThreadCount() const;
+    Stats getStats() const;
+};
@@ -0,0 +1,480 @@
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SocketStats.h"
+#include "../headers/network/SocketTuning.h"
+#include "../headers/network/TCPSocket.h"
+#include "../headers/network/UDPSocket.h"
+#include "../server_for_test/SimpleServer.h"
+#include "../needed_files/Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Open-loop load against the echo servers ("Echo: " + request).
+//
+// Requests follow a fixed schedule: at R req/s over N connections, each
+// connection is due to send every N/R seconds, whatever happened to the
+// previous request. A connection has one request in flight, so when a
+// reply is late the next request goes out late, but its latency is still
+// measured from when it was due (coordinated-omission correction): a
+// stalled server shows up as the queueing delay its clients would see,
+// not as a few slow samples. A request that times out counts as at least
+// the timeout. The time from the actual send is kept as the service time.
+//
+// The rate ramps in steps, one interval each. Every interval gets its own
+// latency histograms (by due time) and completion count (by completion
+// time); the first interval that completes less than the target, or whose
+// p99 breaks the optional SLO, is the saturation point.
+namespace LoadGenerator {
+    using Clock = std::chrono::steady_clock;
+
+    enum class Protocol {
+        Tcp,
+        Udp
+    };
+
+    struct Options {
+        Protocol protocol = Protocol::Tcp;
+        std::string host = "127.0.0.1";
+        // Below the ephemeral range, so --serve can always bind it
+        int port = 21100;
+        int threads = 2;
+        int connections = 16;
+        double start_rate = 1000;
+        // Equal to start_rate (or 0) for a constant rate
+        double max_rate = 0;
+        double rate_step = 1000;
+        double interval_seconds = 2;
+        // Payload bytes; the first 16 carry the request number
+        size_t size = 64;
+        int timeout_ms = 1000;
+        // Saturated once an interval's p99 exceeds this (0: throughput only)
+        double slo_p99_ms = 0;
+        // Stop ramping after this many saturated intervals in a row (0: never)
+        int stop_after = 2;
+    };
+
+    // One step of the ramp. Latencies are in nanoseconds.
+    struct Interval {
+        double target_rate;
+        Clock::time_point start;
+        Clock::time_point end;
+        StatsHistogram latency;  // from due time, requests due in the interval
+        StatsHistogram service;  // from actual send
+        std::atomic<uint64_t> sent{0};
+        std::atomic<uint64_t> completed{0}; // replies that arrived in the interval
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> errors{0};
+        std::atomic<uint64_t> unsent{0};    // due in the interval, never sent
+
+        double achievedRate() const
+        {
+            std::chrono::duration<double> length = end - start;
+            return completed.load() / length.count();
+        }
+    };
+
+    class Schedule {
+    private:
+        std::vector<std::unique_ptr<Interval>> intervals_;
+        Clock::duration interval_length_;
+
+    public:
+        Schedule(const Options &options, Clock::time_point start)
+            : interval_length_(std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(options.interval_seconds)))
+        {
+            double max_rate = std::max(options.max_rate, options.start_rate);
+            double step = options.rate_step > 0 ? options.rate_step : max_rate;
+            int steps = 1 + static_cast<int>(std::ceil((max_rate - options.start_rate) / step - 1e-9));
+            for (int i = 0; i < steps; ++i)
+            {
+                auto interval = std::make_unique<Interval>();
+                interval->target_rate = std::min(options.start_rate + i * step, max_rate);
+                interval->start = start + i * interval_length_;
+                interval->end = interval->start + interval_length_;
+                intervals_.push_back(std::move(interval));
+            }
+        }
+
+        size_t size() const { return intervals_.size(); }
+        Interval &operator[](size_t index) { return *intervals_[index]; }
+        Clock::time_point start() const { return intervals_.front()->start; }
+        Clock::time_point end() const { return intervals_.back()->end; }
+
+        // Interval holding `time`, clamped to the first and last
+        Interval &at(Clock::time_point time)
+        {
+            if (time <= start())
+                return *intervals_.front();
+            size_t index = static_cast<size_t>((time - start()) / interval_length_);
+            return *intervals_[std::min(index, intervals_.size() - 1)];
+        }
+    };
+
+    // One connection's state in a worker
+    struct Connection {
+        std::unique_ptr<ISocket> socket;
+        Clock::time_point next_due;
+        bool in_flight = false;
+        Clock::time_point due;
+        Clock::time_point sent_at;
+        uint64_t sequence = 0;
+        size_t received = 0;
+        // Earliest next connect attempt after a failed one
+        Clock::time_point retry_at;
+    };
+
+    class Worker {
+    private:
+        const Options &options_;
+        Schedule &schedule_;
+        const std::atomic<bool> &stop_;
+        std::vector<Connection> connections_;
+        std::string request_;
+        std::vector<char> reply_;
+        size_t reply_size_;
+
+        bool connect(Connection &conn)
+        {
+            if (options_.protocol == Protocol::Udp)
+            {
+                conn.socket = std::make_unique<UDPSocket>(options_.host, options_.port);
+                return conn.socket->open();
+            }
+            auto tcp = std::make_unique<TCPSocket>(options_.host, options_.port);
+            SocketTuning no_delay;
+            no_delay.no_delay = 1;
+            tcp->setTuning(no_delay);
+            bool ok = tcp->open(options_.timeout_ms);
+            conn.socket = std::move(tcp);
+            return ok;
+        }
+
+        // Time between two requests on one connection at the rate due then
+        Clock::duration gap(Clock::time_point due)
+        {
+            double seconds = options_.connections / schedule_.at(due).target_rate;
+            return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+        }
+
+        void sendRequest(Connection &conn, Clock::time_point now)
+        {
+            conn.due = conn.next_due;
+            conn.next_due += gap(conn.next_due);
+            conn.sent_at = now;
+            conn.received = 0;
+            ++conn.sequence;
+
+            char number[17];
+            std::snprintf(number, sizeof(number), "%016llx", static_cast<unsigned long long>(conn.sequence));
+            std::memcpy(&request_[0], number, std::min<size_t>(16, request_.size()));
+
+            Interval &interval = schedule_.at(conn.due);
+            if (!conn.socket->send(request_))
+            {
+                interval.errors.fetch_add(1, std::memory_order_relaxed);
+                reconnect(conn);
+                return;
+            }
+            interval.sent.fetch_add(1, std::memory_order_relaxed);
+            conn.in_flight = true;
+        }
+
+        // Reads what is there; records the request once its reply is complete
+        void readReply(Connection &conn)
+        {
+            if (options_.protocol == Protocol::Udp)
+                conn.received = 0;
+            ssize_t n = conn.socket->receive(reply_.data() + conn.received, reply_size_ - conn.received);
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+            Clock::time_point now = Clock::now();
+            if (n <= 0)
+            {
+                // Servers without persistent connections close after each reply
+                if (conn.in_flight)
+                    schedule_.at(now).errors.fetch_add(1, std::memory_order_relaxed);
+                reconnect(conn);
+                return;
+            }
+            if (!conn.in_flight)
+                return; // a UDP reply that arrived after its timeout
+
+            conn.received += n;
+            if (options_.protocol == Protocol::Udp && !matches(conn))
+            {
+                conn.received = 0;
+                return; // stale datagram from an earlier request
+            }
+            if (conn.received < reply_size_)
+                return;
+
+            conn.in_flight = false;
+            Interval &due_interval = schedule_.at(conn.due);
+            due_interval.latency.record(static_cast<uint64_t>((now - conn.due).count()));
+            due_interval.service.record(static_cast<uint64_t>((now - conn.sent_at).count()));
+            // Replies drained after the end still count for latency only
+            if (now < schedule_.end())
+                schedule_.at(now).completed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // A request that got no reply in time still counts for latency, as
+        // at least the timeout; leaving it out would hide the slowest
+        // samples exactly when the server saturates
+        void expire(Connection &conn, Clock::time_point now, Clock::duration timeout)
+        {
+            Interval &due_interval = schedule_.at(conn.due);
+            due_interval.timeouts.fetch_add(1, std::memory_order_relaxed);
+            due_interval.latency.record(static_cast<uint64_t>(std::max(now - conn.due, timeout).count()));
+            if (options_.protocol == Protocol::Tcp)
+                reconnect(conn); // the late reply would be read as the next one
+            else
+                conn.in_flight = false;
+        }
+
+        bool matches(const Connection &conn) const
+        {
+            size_t prefix = reply_size_ - request_.size();
+            size_t digits = std::min<size_t>(16, request_.size());
+            char number[17];
+            std::snprintf(number, sizeof(number), "%016llx", static_cast<unsigned long long>(conn.sequence));
+            return conn.received == reply_size_ && std::memcmp(reply_.data() + prefix, number, digits) == 0;
+        }
+
+        void reconnect(Connection &conn)
+        {
+            conn.in_flight = false;
+            conn.socket->close();
+            Clock::time_point now = Clock::now();
+            if (now < schedule_.end() && !stop_ && !connect(conn))
+            {
+                schedule_.at(now).errors.fetch_add(1, std::memory_order_relaxed);
+                conn.retry_at = now + std::chrono::milliseconds(100);
+            }
+        }
+
+        // Requests that were due but never went out, counted where they were due
+        void countUnsent(Clock::time_point until)
+        {
+            for (Connection &conn : connections_)
+            {
+                for (Clock::time_point due = conn.next_due; due < until; due += gap(due))
+                    schedule_.at(due).unsent.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+    public:
+        Worker(const Options &options, Schedule &schedule, const std::atomic<bool> &stop)
+            : options_(options), schedule_(schedule), stop_(stop), request_(options.size, 'x'),
+              reply_(6 + options.size), reply_size_(6 + options.size)
+        {
+        }
+
+        // `first` .. `first + count` of the run's connections
+        void run(int first, int count)
+        {
+            const Clock::duration spacing = gap(schedule_.start()) / options_.connections;
+            const Clock::duration timeout = std::chrono::milliseconds(options_.timeout_ms);
+            connections_.resize(count);
+            for (int i = 0; i < count; ++i)
+            {
+                // Spread the connections evenly over the first gap
+                connections_[i].next_due = schedule_.start() + (first + i) * spacing;
+                connect(connections_[i]);
+            }
+
+            // Rebuilt every pass; the poll backend makes that free of syscalls
+            SocketSet set;
+            Clock::time_point stopped = Clock::time_point::max();
+            while (true)
+            {
+                Clock::time_point now = Clock::now();
+                bool sending = !stop_ && now < schedule_.end();
+                if (!sending && stopped == Clock::time_point::max())
+                    stopped = std::min(now, schedule_.end());
+                // After the last interval, wait one timeout for replies in flight
+                bool in_flight = std::any_of(connections_.begin(), connections_.end(),
+                                             [](const Connection &conn) { return conn.in_flight; });
+                if (!sending && (!in_flight || now >= stopped + timeout))
+                {
+                    for (Connection &conn : connections_)
+                    {
+                        if (conn.in_flight)
+                            expire(conn, now, timeout);
+                    }
+                    break;
+                }
+
+                Clock::time_point wake = sending ? schedule_.end() : stopped + timeout;
+                set.clear();
+                for (Connection &conn : connections_)
+                {
+                    if (conn.socket->getSocketFd() < 0)
+                    {
+                        if (sending && now >= conn.retry_at)
+                            reconnect(conn);
+                        if (conn.socket->getSocketFd() < 0)
+                        {
+                            if (sending)
+                                wake = std::min(wake, conn.retry_at);
+                            continue;
+                        }
+                    }
+                    if (conn.in_flight && now - conn.sent_at >= timeout)
+                        expire(conn, now, timeout);
+                    if (sending && !conn.in_flight && conn.socket->getSocketFd() >= 0 && conn.next_due <= now)
+                        sendRequest(conn, now);
+
+                    if (conn.in_flight)
+                        wake = std::min(wake, conn.sent_at + timeout);
+                    else if (sending)
+                        wake = std::min(wake, conn.next_due);
+                    if (conn.socket->getSocketFd() >= 0)
+                        set.add(conn.socket.get(), SocketSet::Read);
+                }
+
+                if (set.waitUntil(wake) <= 0)
+                    continue;
+                for (const SocketSet::Ready &ready : set.ready())
+                {
+                    for (Connection &conn : connections_)
+                    {
+                        if (conn.socket.get() == ready.socket)
+                        {
+                            readReply(conn);
+                            break;
+                        }
+                    }
+                }
+            }
+
+            countUnsent(stopped);
+            for (Connection &conn : connections_)
+                conn.socket->close();
+        }
+    };
+
+    inline double toMs(uint64_t ns)
+    {
+        return ns / 1e6;
+    }
+
+    inline void printInterval(size_t index, Interval &interval)
+    {
+        StatsHistogram::Snapshot latency = interval.latency.snapshot();
+        StatsHistogram::Snapshot service = interval.service.snapshot();
+        std::cout << "[LOADGEN] interval " << index
+                  << " target/s=" << interval.target_rate
+                  << " achieved/s=" << interval.achievedRate()
+                  << " sent=" << interval.sent.load()
+                  << " unsent=" << interval.unsent.load()
+                  << " timeouts=" << interval.timeouts.load()
+                  << " errors=" << interval.errors.load()
+                  << " latency ms p50=" << toMs(latency.percentile(0.50))
+                  << " p90=" << toMs(latency.percentile(0.90))
+                  << " p99=" << toMs(latency.percentile(0.99))
+                  << " p99.9=" << toMs(latency.percentile(0.999))
+                  << " max=" << toMs(latency.max)
+                  << " service p99=" << toMs(service.percentile(0.99)) << std::endl;
+    }
+
+    // Completed under 95% of the target, or past the latency SLO
+    inline bool isSaturated(const Options &options, Interval &interval)
+    {
+        if (interval.achievedRate() < 0.95 * interval.target_rate)
+            return true;
+        return options.slo_p99_ms > 0 && toMs(interval.latency.snapshot().percentile(0.99)) > options.slo_p99_ms;
+    }
+
+    // Runs the whole ramp and prints one line per interval plus the
+    // saturation point. Returns false when no connection could be made.
+    inline bool run(const Options &options)
+    {
+        std::atomic<bool> stop{false};
+        // A moment to connect before the first request is due
+        Schedule schedule(options, Clock::now() + std::chrono::milliseconds(200));
+
+        int threads = std::max(1, std::min(options.threads, options.connections));
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::vector<std::thread> pool;
+        int first = 0;
+        for (int i = 0; i < threads; ++i)
+        {
+            int count = options.connections / threads + (i < options.connections % threads ? 1 : 0);
+            workers.push_back(std::make_unique<Worker>(options, schedule, stop));
+            pool.emplace_back(&Worker::run, workers.back().get(), first, count);
+            first += count;
+        }
+
+        // Completions are final once an interval is over, so saturation can
+        // stop the ramp early; latency needs the backlog drained first
+        size_t last = schedule.size() - 1;
+        int saturated_run = 0;
+        for (size_t i = 0; i < schedule.size(); ++i)
+        {
+            std::this_thread::sleep_until(schedule[i].end);
+            saturated_run = isSaturated(options, schedule[i]) ? saturated_run + 1 : 0;
+            if (options.stop_after > 0 && saturated_run >= options.stop_after && i + 1 < schedule.size())
+            {
+                last = i;
+                stop = true;
+                break;
+            }
+        }
+        for (std::thread &thread : pool)
+            thread.join();
+
+        uint64_t total_sent = 0;
+        int saturated_at = -1;
+        int sustained = -1;
+        for (size_t i = 0; i <= last; ++i)
+        {
+            printInterval(i, schedule[i]);
+            total_sent += schedule[i].sent.load();
+            if (saturated_at < 0 && isSaturated(options, schedule[i]))
+                saturated_at = static_cast<int>(i);
+            else if (saturated_at < 0)
+                sustained = static_cast<int>(i);
+        }
+        if (total_sent == 0)
+        {
+            Utils::log("Loadgen: nothing was sent, is the server up?");
+            return false;
+        }
+
+        if (saturated_at < 0)
+        {
+            std::cout << "[LOADGEN] not saturated up to " << schedule[last].target_rate << " req/s" << std::endl;
+            return true;
+        }
+        Interval &knee = schedule[saturated_at];
+        std::cout << "[LOADGEN] saturation at target " << knee.target_rate << " req/s: achieved "
+                  << knee.achievedRate() << " req/s, p99 " << toMs(knee.latency.snapshot().percentile(0.99))
+                  << " ms; last sustained rate ";
+        if (sustained >= 0)
+            std::cout << schedule[sustained].target_rate << " req/s" << std::endl;
+        else
+            std::cout << "none" << std::endl;
+
+        // Backlogged connections run back to back, so throughput is capped
+        // at connections / service time. If the server did not slow down,
+        // that cap (the client) is what was hit.
+        double base_service = schedule[0].service.snapshot().mean();
+        double knee_service = knee.service.snapshot().mean();
+        if (base_service > 0 && knee_service < 2 * base_service)
+            std::cout << "[LOADGEN] service time barely grew (" << toMs(static_cast<uint64_t>(base_service)) << " -> "
+                      << toMs(static_cast<uint64_t>(knee_service))
+                      << " ms mean): the " << options.connections
+                      << " connections are the limit, try more" << std::endl;
+        return true;
+    }
+}
@@ -0,0 +1,121 @@
+#include "../needed_files/Utils.h"
+#include "LoadGenerator.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+// Usage: network_loadgen [--option value]...
+//   --protocol tcp|udp    --host 127.0.0.1   --port 21100
+//   --threads 2           --connections 16
+//   --rate 1000           --max-rate R       --step 1000    --interval 2 (seconds)
+//   --size 64 (bytes)     --timeout 1000 (ms)
+//   --slo-p99 0 (ms)      --stop-after 2 (saturated intervals)
+//   --serve               also start SimpleServer (persistent connections)
+//                         or SimpleUDPServer on --port in this process
+//   --server-workers 0    SimpleServer worker threads (with --serve)
+namespace {
+
+    void usage()
+    {
+        std::cerr << "Usage: network_loadgen [--protocol tcp|udp] [--host H] [--port P] [--threads N]"
+                     " [--connections N] [--rate R] [--max-rate R] [--step R] [--interval S] [--size B]"
+                     " [--timeout MS] [--slo-p99 MS] [--stop-after N] [--serve] [--server-workers N]"
+                  << std::endl;
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    LoadGenerator::Options options;
+    bool serve = false;
+    int server_workers = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string name = argv[i];
+        if (name == "--serve")
+        {
+            serve = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            usage();
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (name == "--protocol" && (value == "tcp" || value == "udp"))
+            options.protocol = value == "tcp" ? LoadGenerator::Protocol::Tcp : LoadGenerator::Protocol::Udp;
+        else if (name == "--host")
+            options.host = value;
+        else if (name == "--port")
+            options.port = std::atoi(value.c_str());
+        else if (name == "--threads")
+            options.threads = std::atoi(value.c_str());
+        else if (name == "--connections")
+            options.connections = std::atoi(value.c_str());
+        else if (name == "--rate")
+            options.start_rate = std::atof(value.c_str());
+        else if (name == "--max-rate")
+            options.max_rate = std::atof(value.c_str());
+        else if (name == "--step")
+            options.rate_step = std::atof(value.c_str());
+        else if (name == "--interval")
+            options.interval_seconds = std::atof(value.c_str());
+        else if (name == "--size")
+            options.size = static_cast<size_t>(std::atol(value.c_str()));
+        else if (name == "--timeout")
+            options.timeout_ms = std::atoi(value.c_str());
+        else if (name == "--slo-p99")
+            options.slo_p99_ms = std::atof(value.c_str());
+        else if (name == "--stop-after")
+            options.stop_after = std::atoi(value.c_str());
+        else if (name == "--server-workers")
+            server_workers = std::atoi(value.c_str());
+        else
+        {
+            usage();
+            return 2;
+        }
+    }
+
+    // Both echo servers read one request with a single 1023-byte recv()
+    if (options.connections < 1 || options.start_rate <= 0 || options.interval_seconds <= 0 || options.size < 1 ||
+        options.size > 1023 || options.timeout_ms < 1)
+    {
+        Utils::log("Loadgen: need connections >= 1, rate > 0, interval > 0, 1 <= size <= 1023, timeout >= 1");
+        return 2;
+    }
+
+    Utils::log("Network Load Generator");
+    Utils::log("============================");
+
+    std::unique_ptr<SimpleServer> tcp_server;
+    std::unique_ptr<SimpleUDPServer> udp_server;
+    if (serve && options.protocol == LoadGenerator::Protocol::Tcp)
+    {
+        tcp_server = std::make_unique<SimpleServer>(options.port);
+        tcp_server->setPersistentConnections(true);
+        if (server_workers > 0)
+            tcp_server->setWorkerThreads(server_workers);
+        if (!tcp_server->start())
+            return 1;
+    }
+    else if (serve)
+    {
+        udp_server = std::make_unique<SimpleUDPServer>(options.port);
+        if (!udp_server->start())
+            return 1;
+    }
+
+    bool ok = LoadGenerator::run(options);
+
+    if (tcp_server)
+        tcp_server->stop();
+    if (udp_server)
+        udp_server->stop();
+    return ok ? 0 : 1;
+}
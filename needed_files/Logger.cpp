@@ -0,0 +1,300 @@
+#include "Logger.h"
+
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <errno.h>
+
+namespace {
+
+    // Fixed part of every record in a ring; the message bytes follow
+    struct RecordHeader {
+        // steady_clock, in nanoseconds
+        uint64_t timestamp;
+        uint32_t size;
+        int32_t level;
+    };
+
+    struct Entry {
+        uint64_t timestamp;
+        int level;
+        size_t offset;
+        size_t size;
+    };
+
+    const auto kIdleWait = std::chrono::milliseconds(10);
+
+    const char *levelPrefix(int level) {
+        switch (static_cast<LogLevel>(level)) {
+        case LogLevel::Trace: return "[TRACE]: ";
+        case LogLevel::Debug: return "[DEBUG]: ";
+        case LogLevel::Warn: return "[WARN]: ";
+        case LogLevel::Error: return "[ERROR]: ";
+        default: return "[LOG]: ";
+        }
+    }
+
+}
+
+// Single-producer/single-consumer byte ring; head and tail only grow and are
+// reduced modulo the capacity when indexing
+struct Logger::Ring {
+    static const size_t kCapacity = 64 * 1024;
+
+    std::unique_ptr<char[]> data;
+    alignas(64) std::atomic<size_t> head;   // advanced by the owning thread
+    alignas(64) std::atomic<size_t> tail;   // advanced by the writer thread
+    std::atomic<bool> closed;
+
+    Ring() : data(new char[kCapacity]), head(0), tail(0), closed(false) {}
+
+    void copyIn(size_t position, const void *source, size_t size) {
+        size_t offset = position % kCapacity;
+        size_t first = std::min(size, kCapacity - offset);
+        std::memcpy(data.get() + offset, source, first);
+        std::memcpy(data.get(), static_cast<const char *>(source) + first, size - first);
+    }
+
+    void copyOut(size_t position, void *dest, size_t size) const {
+        size_t offset = position % kCapacity;
+        size_t first = std::min(size, kCapacity - offset);
+        std::memcpy(dest, data.get() + offset, first);
+        std::memcpy(static_cast<char *>(dest) + first, data.get(), size - first);
+    }
+};
+
+// Hands the ring to the writer for a final drain when its thread exits
+struct Logger::RingHolder {
+    std::shared_ptr<Ring> ring;
+
+    ~RingHolder() {
+        if (ring) {
+            ring->closed.store(true, std::memory_order_release);
+        }
+    }
+};
+
+Logger::Logger()
+    : level_(static_cast<int>(LogLevel::Info)), sink_fd_(STDOUT_FILENO),
+      stalls_(0), synchronous_(false), writer_sleeping_(false), passes_(0),
+      wake_requested_(false) {
+    writer_ = std::thread(&Logger::writerLoop, this);
+}
+
+Logger &Logger::instance() {
+    static Logger *logger = [] {
+        Logger *created = new Logger();
+        std::atexit(&Logger::flushAtExit);
+        return created;
+    }();
+    return *logger;
+}
+
+void Logger::flushAtExit() {
+    Logger &logger = instance();
+    logger.flush();
+    // Threads still running during exit write directly from now on
+    logger.synchronous_.store(true);
+}
+
+void Logger::write(LogLevel level, const std::string &message) {
+    write(level, message.data(), message.size());
+}
+
+void Logger::write(LogLevel level, const char *data, size_t size) {
+    if (!isEnabled(level)) {
+        return;
+    }
+
+    if (synchronous_.load(std::memory_order_relaxed)) {
+        writeSynchronously(level, data, size);
+        return;
+    }
+
+    push(localRing(), level, data, size);
+}
+
+Logger::Ring &Logger::localRing() {
+    static thread_local RingHolder holder;
+    if (!holder.ring) {
+        holder.ring = std::make_shared<Ring>();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+void Logger::push(Ring &ring, LogLevel level, const char *data, size_t size) {
+    // A single record may take at most half the ring
+    size = std::min(size, Ring::kCapacity / 2 - sizeof(RecordHeader));
+
+    RecordHeader header;
+    // A clock read rather than a shared counter keeps producers off each
+    // other's cache lines
+    header.timestamp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+    header.size = static_cast<uint32_t>(size);
+    header.level = static_cast<int32_t>(level);
+    size_t needed = sizeof(header) + size;
+
+    size_t head = ring.head.load(std::memory_order_relaxed);
+    while (Ring::kCapacity - (head - ring.tail.load(std::memory_order_acquire)) < needed) {
+        // Ring full: wait for the writer rather than lose the record
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        wakeWriter();
+        std::this_thread::yield();
+    }
+
+    ring.copyIn(head, &header, sizeof(header));
+    ring.copyIn(head + sizeof(header), data, size);
+    ring.head.store(head + needed, std::memory_order_release);
+
+    if (writer_sleeping_.load(std::memory_order_relaxed)) {
+        wakeWriter();
+    }
+}
+
+void Logger::wakeWriter() {
+    {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        wake_requested_ = true;
+    }
+    writer_cv_.notify_one();
+}
+
+void Logger::writerLoop() {
+    std::string out;
+
+    while (true) {
+        out.clear();
+        bool wrote = drain(out);
+        if (!out.empty()) {
+            writeToSink(out);
+        }
+
+        std::unique_lock<std::mutex> lock(writer_mutex_);
+        ++passes_;
+        flushed_cv_.notify_all();
+
+        if (!wrote && !wake_requested_) {
+            writer_sleeping_.store(true);
+            writer_cv_.wait_for(lock, kIdleWait, [this] { return wake_requested_; });
+            writer_sleeping_.store(false);
+        }
+        wake_requested_ = false;
+    }
+}
+
+bool Logger::drain(std::string &out) {
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings = rings_;
+    }
+
+    std::vector<Entry> entries;
+    std::string text;
+    bool retired = false;
+
+    for (auto &ring : rings) {
+        // Read closed before head: a closed ring gets no more records
+        bool closed = ring->closed.load(std::memory_order_acquire);
+        size_t tail = ring->tail.load(std::memory_order_relaxed);
+        size_t head = ring->head.load(std::memory_order_acquire);
+
+        while (tail < head) {
+            RecordHeader header;
+            ring->copyOut(tail, &header, sizeof(header));
+
+            Entry entry{header.timestamp, header.level, text.size(), header.size};
+            text.resize(text.size() + header.size);
+            ring->copyOut(tail + sizeof(header), &text[entry.offset], header.size);
+            entries.push_back(entry);
+
+            tail += sizeof(header) + header.size;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+        retired = retired || closed;
+    }
+
+    if (retired) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                    [](const std::shared_ptr<Ring> &ring) {
+                                        return ring->closed.load(std::memory_order_acquire) &&
+                                               ring->tail.load() == ring->head.load();
+                                    }),
+                     rings_.end());
+    }
+
+    // Restore the order the records were produced in across threads. Each
+    // ring's timestamps never decrease, so the stable sort keeps a thread's
+    // records in order when they share a timestamp.
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry &a, const Entry &b) { return a.timestamp < b.timestamp; });
+
+    for (const Entry &entry : entries) {
+        out += levelPrefix(entry.level);
+        out.append(text, entry.offset, entry.size);
+        out += '\n';
+    }
+    return !entries.empty();
+}
+
+void Logger::writeSynchronously(LogLevel level, const char *data, size_t size) {
+    static std::mutex sync_mutex;
+
+    std::string line = levelPrefix(static_cast<int>(level));
+    line.append(data, size);
+    line += '\n';
+
+    std::lock_guard<std::mutex> lock(sync_mutex);
+    writeToSink(line);
+}
+
+void Logger::writeToSink(const std::string &out) {
+    int fd = sink_fd_.load();
+    size_t written = 0;
+    while (written < out.size()) {
+        ssize_t n = ::write(fd, out.data() + written, out.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        written += n;
+    }
+}
+
+void Logger::setLevel(LogLevel level) {
+    level_.store(static_cast<int>(level));
+}
+
+LogLevel Logger::getLevel() const {
+    return static_cast<LogLevel>(level_.load());
+}
+
+void Logger::setSink(int fd) {
+    flush();
+    sink_fd_.store(fd);
+}
+
+void Logger::flush() {
+    if (synchronous_.load()) {
+        return;
+    }
+
+    // Wait for a full drain pass that started after this call
+    std::unique_lock<std::mutex> lock(writer_mutex_);
+    uint64_t target = passes_ + 2;
+    wake_requested_ = true;
+    writer_cv_.notify_one();
+    flushed_cv_.wait(lock, [&] { return passes_ >= target; });
+}
+
+uint64_t Logger::getStalls() const {
+    return stalls_.load(std::memory_order_relaxed);
+}
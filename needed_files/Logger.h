@@ -0,0 +1,107 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class LogLevel : int {
+    Trace = 0,
+    Debug = 1,
+    Info = 2,
+    Warn = 3,
+    Error = 4,
+    Off = 5
+};
+
+// Records below this level are compiled out of the NET_LOG_* macros
+// entirely (set with -DNETWORK_LOG_LEVEL=<n> at configure time)
+#ifndef NETWORK_LOG_MIN_LEVEL
+#define NETWORK_LOG_MIN_LEVEL 0
+#endif
+
+#define NET_LOG(level, message)                                                        \
+    do {                                                                               \
+        if (static_cast<int>(level) >= NETWORK_LOG_MIN_LEVEL &&                        \
+            Logger::instance().isEnabled(level)) {                                     \
+            Logger::instance().write(level, message);                                  \
+        }                                                                              \
+    } while (0)
+
+#define NET_LOG_TRACE(message) NET_LOG(LogLevel::Trace, message)
+#define NET_LOG_DEBUG(message) NET_LOG(LogLevel::Debug, message)
+#define NET_LOG_INFO(message) NET_LOG(LogLevel::Info, message)
+#define NET_LOG_WARN(message) NET_LOG(LogLevel::Warn, message)
+#define NET_LOG_ERROR(message) NET_LOG(LogLevel::Error, message)
+
+// Asynchronous logger.
+//
+// write() only copies the message into the calling thread's lock-free
+// single-producer ring; a background thread drains all rings, restores the
+// cross-thread order from per-record timestamps and writes each batch to
+// the sink fd with one write(). When a ring is full the producer waits for
+// the writer instead of dropping records. Pending records are flushed at exit, after which logging falls
+// back to synchronous writes.
+class Logger
+{
+private:
+    struct Ring;
+    struct RingHolder;
+
+    std::atomic<int> level_;
+    std::atomic<int> sink_fd_;
+    std::atomic<uint64_t> stalls_;
+    std::atomic<bool> synchronous_;
+    std::atomic<bool> writer_sleeping_;
+
+    std::mutex rings_mutex_;
+    std::vector<std::shared_ptr<Ring>> rings_;
+
+    std::mutex writer_mutex_;
+    std::condition_variable writer_cv_;
+    std::condition_variable flushed_cv_;
+    uint64_t passes_;
+    bool wake_requested_;
+    std::thread writer_;
+
+    Logger();
+
+    Ring &localRing();
+    void push(Ring &ring, LogLevel level, const char *data, size_t size);
+    void wakeWriter();
+    void writerLoop();
+    bool drain(std::string &out);
+    void writeSynchronously(LogLevel level, const char *data, size_t size);
+    void writeToSink(const std::string &out);
+    static void flushAtExit();
+
+public:
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+
+    // Process-wide instance; never destroyed so threads may log during exit
+    static Logger &instance();
+
+    void write(LogLevel level, const std::string &message);
+    void write(LogLevel level, const char *data, size_t size);
+
+    // Runtime filter on top of NETWORK_LOG_MIN_LEVEL (default: Info)
+    void setLevel(LogLevel level);
+    LogLevel getLevel() const;
+    bool isEnabled(LogLevel level) const
+    {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    // Destination file descriptor (default: stdout)
+    void setSink(int fd);
+    // Blocks until every record written before the call reached the sink
+    void flush();
+    // Times a producer had to wait for room in its ring
+    uint64_t getStalls() const;
+};
@@ -1,7 +1,7 @@
 #include "Utils.h"
-#include <iostream>
+#include "Logger.h"
 
 void Utils::log(const std::string& msg) {
-    std::cout << "[LOG]: " << msg << std::endl;
+    NET_LOG_INFO(msg);
 }
 
@@ -0,0 +1,212 @@
+#include "CoroutineServer.h"
+#include "../needed_files/Logger.h"
+#include "../needed_files/Utils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+    // Echo replies are "Echo: " + request, with requests capped at 1023 bytes
+    const char kEchoPrefix[] = "Echo: ";
+    const size_t kEchoPrefixLen = sizeof(kEchoPrefix) - 1;
+    const size_t kMaxRequest = 1023;
+}
+
+CoroutineEchoServer::CoroutineEchoServer(int port)
+    : port_(port), persistent_(false), running_(false) {}
+
+CoroutineEchoServer::~CoroutineEchoServer()
+{
+    stop();
+}
+
+void CoroutineEchoServer::setPersistentConnections(bool enable)
+{
+    persistent_ = enable;
+}
+
+bool CoroutineEchoServer::start()
+{
+    if (running_)
+        return true;
+
+    auto io = std::make_unique<IoContext>();
+    auto acceptor = std::make_unique<TCPAcceptor>(port_);
+    if (!io->init() || !acceptor->listen())
+    {
+        Utils::log("Server: failed to start coroutine server on port " + std::to_string(port_));
+        return false;
+    }
+
+    io_ = std::move(io);
+    // Runs up to the first accept wait here; the loop thread takes over
+    io_->spawn(acceptLoop(std::move(acceptor)));
+    running_ = true;
+    thread_ = std::thread([this]() {
+        io_->run();
+        Utils::log("Server: Main loop exited");
+    });
+
+    Utils::log("Coroutine server started on port " + std::to_string(port_));
+    return true;
+}
+
+Task<void> CoroutineEchoServer::acceptLoop(std::unique_ptr<TCPAcceptor> acceptor)
+{
+    while (true)
+    {
+        std::unique_ptr<TCPSocket> client = co_await acceptor->asyncAccept(*io_);
+        if (!client)
+            break;
+        NET_LOG_DEBUG("Server: Client connected");
+        io_->spawn(session(std::move(client)));
+    }
+}
+
+Task<void> CoroutineEchoServer::session(std::unique_ptr<TCPSocket> client)
+{
+    // Echo back with a prefix: the request lands right behind it
+    char response[kEchoPrefixLen + kMaxRequest];
+    std::memcpy(response, kEchoPrefix, kEchoPrefixLen);
+
+    do
+    {
+        ssize_t bytes_read = co_await client->asyncReceive(*io_, response + kEchoPrefixLen, kMaxRequest);
+        if (bytes_read <= 0)
+            break;
+
+        NET_LOG_DEBUG("Server received: " + std::string(response + kEchoPrefixLen, bytes_read));
+
+        bool sent = co_await client->asyncSend(*io_, response, kEchoPrefixLen + bytes_read);
+        if (!sent)
+            break;
+    } while (persistent_);
+
+    NET_LOG_DEBUG("Server: Client disconnected");
+}
+
+void CoroutineEchoServer::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    io_->stop();
+    Utils::log("Waiting for server thread to exit...");
+    thread_.join();
+    // Destroys the suspended sessions and the acceptor with them
+    io_.reset();
+    Utils::log("Server stopped cleanly.");
+}
+
+bool CoroutineEchoServer::isRunning() const
+{
+    return running_;
+}
+
+
+CoroutineUDPEchoServer::CoroutineUDPEchoServer(int port)
+    : port_(port), server_fd_(-1), running_(false) {}
+
+CoroutineUDPEchoServer::~CoroutineUDPEchoServer()
+{
+    stop();
+}
+
+bool CoroutineUDPEchoServer::start()
+{
+    if (running_)
+        return true;
+
+    server_fd_ = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (server_fd_ < 0)
+    {
+        Utils::log("Server: socket() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port_);
+
+    io_ = std::make_unique<IoContext>();
+    if (bind(server_fd_, (sockaddr *)&address, sizeof(address)) < 0 || !io_->init() || !io_->watch(server_fd_))
+    {
+        Utils::log("Server: failed to start coroutine UDP server: " + std::string(strerror(errno)));
+        io_.reset();
+        ::close(server_fd_);
+        server_fd_ = -1;
+        return false;
+    }
+
+    io_->spawn(serve());
+    running_ = true;
+    thread_ = std::thread([this]() {
+        io_->run();
+        Utils::log("Server: Main loop exited");
+    });
+
+    Utils::log("Coroutine UDP server started on port " + std::to_string(port_));
+    return true;
+}
+
+Task<void> CoroutineUDPEchoServer::serve()
+{
+    char response[kEchoPrefixLen + kMaxRequest];
+    std::memcpy(response, kEchoPrefix, kEchoPrefixLen);
+
+    while (true)
+    {
+        sockaddr_in peer{};
+        socklen_t peer_len = sizeof(peer);
+        ssize_t bytes_read = recvfrom(server_fd_, response + kEchoPrefixLen, kMaxRequest, 0,
+                                      (sockaddr *)&peer, &peer_len);
+        if (bytes_read < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                bool ready = co_await io_->readable(server_fd_);
+                if (!ready)
+                    co_return;
+            }
+            else if (errno != EINTR)
+            {
+                Utils::log("Server: recvfrom() failed: " + std::string(strerror(errno)));
+            }
+            continue;
+        }
+
+        NET_LOG_DEBUG("Server received: " + std::string(response + kEchoPrefixLen, bytes_read));
+
+        // A full send buffer drops the echo, as the network could
+        sendto(server_fd_, response, kEchoPrefixLen + bytes_read, 0, (sockaddr *)&peer, peer_len);
+    }
+}
+
+void CoroutineUDPEchoServer::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    io_->stop();
+    Utils::log("Waiting for server thread to exit...");
+    thread_.join();
+    io_.reset();
+    ::close(server_fd_);
+    server_fd_ = -1;
+    Utils::log("UDP Server stopped cleanly.");
+}
+
+bool CoroutineUDPEchoServer::isRunning() const
+{
+    return running_;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "../headers/network/IoContext.h"
+#include "../headers/network/TCPAcceptor.h"
+#include "../headers/network/TCPSocket.h"
+#include "../headers/network/Task.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+
+// The echo servers written against the coroutine API: one thread running an
+// IoContext, one straight-line coroutine per connection. Replies are
+// "Echo: " + request, like SimpleServer and SimpleUDPServer.
+class CoroutineEchoServer {
+private:
+    int port_;
+    bool persistent_;
+    std::atomic<bool> running_;
+    std::unique_ptr<IoContext> io_;
+    std::thread thread_;
+
+    Task<void> acceptLoop(std::unique_ptr<TCPAcceptor> acceptor);
+    Task<void> session(std::unique_ptr<TCPSocket> client);
+
+public:
+    CoroutineEchoServer(int port);
+    ~CoroutineEchoServer();
+
+    // Keeps connections open after a reply; must be called before start()
+    void setPersistentConnections(bool enable);
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+};
+
+
+class CoroutineUDPEchoServer {
+private:
+    int port_;
+    int server_fd_;
+    std::atomic<bool> running_;
+    std::unique_ptr<IoContext> io_;
+    std::thread thread_;
+
+    Task<void> serve();
+
+public:
+    CoroutineUDPEchoServer(int port);
+    ~CoroutineUDPEchoServer();
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+};
@@ -0,0 +1,141 @@
+#include "SharedMemoryServer.h"
+#include "../needed_files/Logger.h"
+#include "../needed_files/Utils.h"
+
+#include <cstring>
+#include <errno.h>
+
+namespace {
+    const char kEchoPrefix[] = "Echo: ";
+    const size_t kEchoPrefixLen = sizeof(kEchoPrefix) - 1;
+    const size_t kMaxRequest = 64 * 1024;
+    // How often idle threads look at running_
+    const int kPollMs = 100;
+    // A client that stops reading is dropped after this long with a full
+    // ring, which also bounds how long stop() waits for its session
+    const int kSendTimeoutMs = 1000;
+}
+
+SimpleSharedMemoryServer::SimpleSharedMemoryServer(const std::string &path)
+    : path_(path), spin_time_(0), running_(false) {}
+
+SimpleSharedMemoryServer::~SimpleSharedMemoryServer()
+{
+    stop();
+}
+
+void SimpleSharedMemoryServer::setSpinTime(std::chrono::nanoseconds spin)
+{
+    spin_time_ = spin;
+}
+
+bool SimpleSharedMemoryServer::start()
+{
+    if (running_)
+        return true;
+
+    acceptor_ = std::make_unique<SharedMemoryAcceptor>(path_);
+    if (!acceptor_->listen())
+    {
+        acceptor_.reset();
+        return false;
+    }
+
+    running_ = true;
+    accept_thread_ = std::thread(&SimpleSharedMemoryServer::acceptClients, this);
+    Utils::log("Shared memory server started on " + path_);
+    return true;
+}
+
+void SimpleSharedMemoryServer::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    if (accept_thread_.joinable())
+        accept_thread_.join();
+    acceptor_.reset();
+
+    // Sessions notice running_ within one receive or send timeout
+    std::vector<std::unique_ptr<Session>> sessions;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions.swap(sessions_);
+    }
+    for (std::unique_ptr<Session> &session : sessions)
+        session->thread.join();
+    Utils::log("Shared memory server stopped cleanly.");
+}
+
+bool SimpleSharedMemoryServer::isRunning() const
+{
+    return running_;
+}
+
+const std::string &SimpleSharedMemoryServer::getPath() const
+{
+    return path_;
+}
+
+void SimpleSharedMemoryServer::acceptClients()
+{
+    while (running_)
+    {
+        reapSessions();
+        std::unique_ptr<SharedMemorySocket> socket = acceptor_->accept(kPollMs);
+        if (!socket)
+            continue;
+
+        auto session = std::make_unique<Session>();
+        Session *raw = session.get();
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        sessions_.push_back(std::move(session));
+        raw->thread = std::thread(&SimpleSharedMemoryServer::serveClient, this, raw, std::move(socket));
+    }
+}
+
+void SimpleSharedMemoryServer::reapSessions()
+{
+    std::vector<std::unique_ptr<Session>> finished;
+    {
+        std::lock_guard<std::mutex> lock(sessions_mutex_);
+        for (size_t i = 0; i < sessions_.size();)
+        {
+            if (sessions_[i]->done.load(std::memory_order_acquire))
+            {
+                finished.push_back(std::move(sessions_[i]));
+                sessions_[i] = std::move(sessions_.back());
+                sessions_.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+    for (std::unique_ptr<Session> &session : finished)
+        session->thread.join();
+}
+
+void SimpleSharedMemoryServer::serveClient(Session *session, std::unique_ptr<SharedMemorySocket> socket)
+{
+    socket->setReceiveTimeout(std::chrono::milliseconds(kPollMs));
+    socket->setSendTimeout(std::chrono::milliseconds(kSendTimeoutMs));
+    socket->setSpinTime(spin_time_);
+
+    std::vector<char> buffer(kEchoPrefixLen + kMaxRequest);
+    std::memcpy(buffer.data(), kEchoPrefix, kEchoPrefixLen);
+    while (running_)
+    {
+        ssize_t bytes_read = socket->receive(buffer.data() + kEchoPrefixLen, kMaxRequest);
+        if (bytes_read < 0 && errno == EAGAIN)
+            continue;
+        if (bytes_read <= 0)
+            break;
+
+        NET_LOG_DEBUG("Shared memory server received: " + std::string(buffer.data() + kEchoPrefixLen, bytes_read));
+        if (!socket->send(buffer.data(), kEchoPrefixLen + bytes_read))
+            break;
+    }
+    socket->close();
+    session->done.store(true, std::memory_order_release);
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "../headers/network/SharedMemorySocket.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Echo server for SharedMemorySocket: an accept thread plus one thread per
+// connection (each side of a ring is single-threaded), replies are
+// "Echo: " + whatever one receive() returned.
+class SimpleSharedMemoryServer {
+private:
+    std::string path_;
+    std::chrono::nanoseconds spin_time_;
+    std::atomic<bool> running_;
+    std::unique_ptr<SharedMemoryAcceptor> acceptor_;
+    std::thread accept_thread_;
+    // One connection's thread; done is set as the thread returns, so the
+    // accept thread can join it without waiting
+    struct Session {
+        std::thread thread;
+        std::atomic<bool> done{false};
+    };
+
+    std::mutex sessions_mutex_;
+    std::vector<std::unique_ptr<Session>> sessions_;
+
+    void acceptClients();
+    // Joins and drops the sessions that finished
+    void reapSessions();
+    void serveClient(Session *session, std::unique_ptr<SharedMemorySocket> socket);
+
+public:
+    SimpleSharedMemoryServer(const std::string &path);
+    ~SimpleSharedMemoryServer();
+
+    // Spin time of the server side of each connection; must be called
+    // before start()
+    void setSpinTime(std::chrono::nanoseconds spin);
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+    const std::string &getPath() const;
+};
@@ -1,14 +1,42 @@
 #include "SimpleServer.h"
+#include "../needed_files/Logger.h"
 #include "../needed_files/Utils.h"
 
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <pthread.h>
+#include <sched.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <errno.h>
 
-SimpleServer::SimpleServer(int port)
-    : port_(port), server_fd_(-1), running_(false) {}
+namespace {
+    // io_uring user_data layout: operation in the high half, connection id low
+    enum UringOp : uint64_t { kAccept = 1, kRecv = 2, kSend = 3, kWakeup = 4 };
+    const uint16_t kBufferGroup = 0;
+    const unsigned kBufferCount = 256;
+    const size_t kBufferSize = 1024;
+
+    // Echo replies are "Echo: " + request, with requests capped at 1023 bytes
+    const char kEchoPrefix[] = "Echo: ";
+    const size_t kEchoPrefixLen = sizeof(kEchoPrefix) - 1;
+    const size_t kMaxRequest = 1023;
+
+    // Framed connections read in chunks of this size, and stop reading to
+    // answer once this much is buffered
+    const size_t kFramedReadChunk = 64 * 1024;
+    const size_t kFramedBatchBytes = 256 * 1024;
+
+    uint64_t userData(UringOp op, uint32_t id) { return (static_cast<uint64_t>(op) << 32) | id; }
+}
+
+SimpleServer::SimpleServer(int port, int backlog)
+    : port_(port), backlog_(backlog), running_(false), engine_(IoEngine::Syscall),
+      shard_count_(1), pin_threads_(false), persistent_(false), framed_(false), frame_prefix_(FramePrefix::Varint),
+      max_frame_size_(0), idle_timeout_ms_(0), worker_threads_(0), worker_queue_(1024) {}
 
 SimpleServer::~SimpleServer()
 {
@@ -17,8 +45,60 @@ SimpleServer::~SimpleServer()
 
 bool SimpleServer::start()
 {
-    server_fd_ = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_fd_ < 0)
+    if (running_)
+        return true;
+
+    for (int i = 0; i < shard_count_; ++i)
+    {
+        auto shard = std::make_unique<Shard>();
+        shard->index = i;
+        shard->server_fd = -1;
+        shard->wakeup_fd = -1;
+        shard->timer_fd = -1;
+        shard->wakeup_value = 0;
+        shard->next_connection_id = 0;
+        shard->in_flight = 0;
+        shard->pool = nullptr;
+
+        if (!openListener(*shard))
+        {
+            for (auto &opened : shards_)
+                ::close(opened->server_fd);
+            shards_.clear();
+            return false;
+        }
+        shards_.push_back(std::move(shard));
+    }
+
+    if (worker_threads_ > 0)
+    {
+        workers_ = std::make_unique<WorkStealingPool>(worker_threads_, worker_queue_);
+        workers_->start();
+    }
+
+    running_ = true;
+    for (auto &shard : shards_)
+    {
+        if (!startShard(*shard))
+        {
+            stop();
+            return false;
+        }
+    }
+
+    std::string mode = shards_.front()->ring ? " (io_uring)" : "";
+    if (shard_count_ > 1)
+        mode += " with " + std::to_string(shard_count_) + " shards";
+    if (workers_)
+        mode += " and " + std::to_string(worker_threads_) + " workers";
+    Utils::log("Server started on port " + std::to_string(port_) + mode);
+    return true;
+}
+
+bool SimpleServer::openListener(Shard &shard)
+{
+    shard.server_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (shard.server_fd < 0)
     {
         Utils::log("Server: socket() failed: " + std::string(strerror(errno)));
         return false;
@@ -26,36 +106,94 @@ bool SimpleServer::start()
 
     // Allow reuse of address
     int opt = 1;
-    if (setsockopt(server_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+    if (setsockopt(shard.server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0 ||
+        (shard_count_ > 1 &&
+         setsockopt(shard.server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0))
     {
         Utils::log("Server: setsockopt() failed: " + std::string(strerror(errno)));
-        ::close(server_fd_);
+        ::close(shard.server_fd);
+        shard.server_fd = -1;
         return false;
     }
 
+    // Failed options are logged; the server runs without them
+    tuning_.apply(shard.server_fd);
+
     sockaddr_in address{};
     address.sin_family = AF_INET;
     address.sin_addr.s_addr = INADDR_ANY;
     address.sin_port = htons(port_);
 
-    if (bind(server_fd_, (sockaddr *)&address, sizeof(address)) < 0)
+    if (bind(shard.server_fd, (sockaddr *)&address, sizeof(address)) < 0)
     {
         Utils::log("Server: bind() failed: " + std::string(strerror(errno)));
-        ::close(server_fd_);
+        ::close(shard.server_fd);
+        shard.server_fd = -1;
         return false;
     }
 
-    if (listen(server_fd_, 3) < 0)
+    if (listen(shard.server_fd, backlog_) < 0)
     {
         Utils::log("Server: listen() failed: " + std::string(strerror(errno)));
-        ::close(server_fd_);
+        ::close(shard.server_fd);
+        shard.server_fd = -1;
         return false;
     }
 
-    running_ = true;
-    server_thread_ = std::thread(&SimpleServer::serverLoop, this);
+    return true;
+}
+
+bool SimpleServer::startShard(Shard &shard)
+{
+    if (engine_ == IoEngine::IoUring && setupUring(shard))
+    {
+        shard.thread = std::thread(&SimpleServer::serverLoopUring, this, &shard);
+        return true;
+    }
 
-    Utils::log("Server started on port " + std::to_string(port_));
+    shard.loop = std::make_unique<EventLoop>();
+    Shard *raw = &shard;
+    if (!shard.loop->init() ||
+        !shard.loop->add(shard.server_fd, EPOLLIN, [this, raw](uint32_t) { acceptClients(*raw); }) ||
+        !startIdleTimer(shard))
+    {
+        Utils::log("Server: failed to set up event loop");
+        shard.loop.reset();
+        return false;
+    }
+
+    shard.thread = std::thread(&SimpleServer::serverLoop, this, &shard);
+    return true;
+}
+
+bool SimpleServer::startIdleTimer(Shard &shard)
+{
+    if (idle_timeout_ms_ <= 0)
+        return true;
+
+    shard.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (shard.timer_fd < 0)
+    {
+        Utils::log("Server: timerfd_create() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    // A connection is closed between 1x and 1.25x the timeout after its
+    // last activity
+    long period_ms = std::max(1, idle_timeout_ms_ / 4);
+    itimerspec spec{};
+    spec.it_interval.tv_sec = period_ms / 1000;
+    spec.it_interval.tv_nsec = (period_ms % 1000) * 1000000;
+    spec.it_value = spec.it_interval;
+    Shard *raw = &shard;
+    if (timerfd_settime(shard.timer_fd, 0, &spec, nullptr) < 0 ||
+        !shard.loop->add(shard.timer_fd, EPOLLIN, [this, raw](uint32_t) { closeIdleClients(*raw); }))
+    {
+        Utils::log("Server: failed to arm the idle timer: " + std::string(strerror(errno)));
+        ::close(shard.timer_fd);
+        shard.timer_fd = -1;
+        return false;
+    }
     return true;
 }
 
@@ -67,18 +205,63 @@ void SimpleServer::stop()
 
     running_ = false;
 
-    if (server_fd_ != -1) {
-        ::close(server_fd_);
-        server_fd_ = -1;
+    // Shard threads first: once they have joined, nothing reads workers_
+    // or submits to it any more
+    for (auto &shard : shards_)
+        haltShard(*shard);
+
+    // Workers then finish what they hold; their replies are posted to
+    // loops that no longer run and are dropped with them
+    if (workers_)
+    {
+        workers_->stop();
+        workers_.reset();
     }
 
-    if (server_thread_.joinable())
+    for (auto &shard : shards_)
+        releaseShard(*shard);
+    shards_.clear();
+
+    Utils::log("Server stopped cleanly.");
+}
+
+void SimpleServer::haltShard(Shard &shard)
+{
+    if (shard.ring)
+    {
+        uint64_t one = 1;
+        ssize_t ignored = write(shard.wakeup_fd, &one, sizeof(one));
+        (void)ignored;
+    }
+    else if (shard.loop)
+    {
+        shard.loop->stop();
+    }
+
+    if (shard.thread.joinable())
     {
         Utils::log("Waiting for server thread to exit...");
-        server_thread_.detach();
+        shard.thread.join();
     }
+}
 
-    Utils::log("Server stopped cleanly.");
+void SimpleServer::releaseShard(Shard &shard)
+{
+    shard.loop.reset();
+    shard.ring.reset();
+    if (shard.wakeup_fd != -1) {
+        ::close(shard.wakeup_fd);
+        shard.wakeup_fd = -1;
+    }
+    if (shard.timer_fd != -1) {
+        ::close(shard.timer_fd);
+        shard.timer_fd = -1;
+    }
+
+    if (shard.server_fd != -1) {
+        ::close(shard.server_fd);
+        shard.server_fd = -1;
+    }
 }
 
 bool SimpleServer::isRunning() const
@@ -86,54 +269,808 @@ bool SimpleServer::isRunning() const
     return running_;
 }
 
-void SimpleServer::serverLoop()
+void SimpleServer::setIoEngine(IoEngine engine)
+{
+    engine_ = engine;
+}
+
+void SimpleServer::setShardCount(int shards)
+{
+    shard_count_ = shards > 0 ? shards : 1;
+}
+
+void SimpleServer::setCpuPinning(bool enable)
+{
+    pin_threads_ = enable;
+}
+
+void SimpleServer::setPersistentConnections(bool enable)
+{
+    persistent_ = enable;
+}
+
+void SimpleServer::setFraming(FramePrefix prefix, size_t max_frame_size)
+{
+    framed_ = true;
+    frame_prefix_ = prefix;
+    max_frame_size_ = max_frame_size;
+}
+
+void SimpleServer::setIdleTimeout(int ms)
+{
+    idle_timeout_ms_ = ms > 0 ? ms : 0;
+}
+
+void SimpleServer::setTuning(const SocketTuning &tuning)
+{
+    tuning_ = tuning;
+}
+
+void SimpleServer::setRequestHandler(RequestHandler handler)
+{
+    handler_ = std::move(handler);
+}
+
+void SimpleServer::setWorkerThreads(int threads, size_t queue_capacity)
+{
+    worker_threads_ = threads > 0 ? threads : 0;
+    worker_queue_ = queue_capacity;
+}
+
+int SimpleServer::getShardCount() const
+{
+    return shard_count_;
+}
+
+BufferPool::Stats SimpleServer::getBufferPoolStats() const
+{
+    BufferPool::Stats total{};
+    for (const auto &shard : shards_)
+    {
+        BufferPool *pool = shard->pool.load();
+        if (pool == nullptr)
+            continue;
+
+        BufferPool::Stats stats = pool->getStats();
+        total.hits += stats.hits;
+        total.misses += stats.misses;
+        total.remote_frees += stats.remote_frees;
+        total.slabs += stats.slabs;
+        total.blocks_in_use += stats.blocks_in_use;
+        total.huge_pages = total.huge_pages || stats.huge_pages;
+    }
+    return total;
+}
+
+WorkStealingPool::Stats SimpleServer::getWorkerStats() const
+{
+    return workers_ ? workers_->getStats() : WorkStealingPool::Stats{};
+}
+
+void SimpleServer::pinCurrentThread(int index)
+{
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0)
+        return;
+
+    // Pick the index-th CPU this process may run on
+    int target = index % CPU_COUNT(&allowed);
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (!CPU_ISSET(cpu, &allowed) || target-- > 0)
+            continue;
+
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int err = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (err != 0)
+            Utils::log("Server: pthread_setaffinity_np() failed: " + std::string(strerror(err)));
+        return;
+    }
+}
+
+void SimpleServer::serverLoop(Shard *shard)
 {
+    if (pin_threads_)
+        pinCurrentThread(shard->index);
+    shard->pool = &BufferPool::local();
+
+    shard->loop->run();
+
+    // Connections still open at shutdown are owned by this thread
+    while (!shard->connections.empty())
+    {
+        closeClient(*shard, shard->connections.begin()->first);
+    }
+    Utils::log("Server: Main loop exited");
+}
+
+void SimpleServer::acceptClients(Shard &shard)
+{
+    // Edge-triggered: drain the whole accept queue
     while (running_)
     {
         sockaddr_in client_addr{};
         socklen_t client_len = sizeof(client_addr);
 
-        int client_fd = accept(server_fd_, (sockaddr *)&client_addr, &client_len);
+        int client_fd = accept4(shard.server_fd, (sockaddr *)&client_addr, &client_len,
+                                SOCK_NONBLOCK | SOCK_CLOEXEC);
         if (client_fd < 0)
         {
-            if (running_)
-            {
-                // Only log if we're still supposed to be running
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
                 Utils::log("Server: accept() failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = client_fd;
+        conn->id = shard.next_connection_id++;
+        conn->response_size = 0;
+        conn->sent = 0;
+        conn->responded = false;
+        conn->pending = false;
+        conn->last_active = std::chrono::steady_clock::now();
+        if (framed_)
+            conn->parser = std::make_unique<FrameParser>(frame_prefix_, max_frame_size_);
+        Connection *raw = conn.get();
+        Shard *owner = &shard;
+
+        if (!shard.loop->add(client_fd, EPOLLIN | EPOLLRDHUP,
+                             [this, owner, raw](uint32_t events) { handleClient(*owner, *raw, events); }))
+        {
+            ::close(client_fd);
+            continue;
+        }
+        shard.connections[client_fd] = std::move(conn);
+
+        NET_LOG_DEBUG("Server: Client connected");
+    }
+}
+
+void SimpleServer::handleClient(Shard &shard, Connection &conn, uint32_t events)
+{
+    if (events & EPOLLERR)
+    {
+        closeClient(shard, conn.fd);
+        return;
+    }
+    if (idle_timeout_ms_ > 0)
+        conn.last_active = std::chrono::steady_clock::now();
+
+    if (conn.pending || conn.held)
+    {
+        // The socket is read again once the request has been answered
+        if (events & EPOLLHUP)
+            closeClient(shard, conn.fd);
+        return;
+    }
+
+    if (conn.responded)
+    {
+        // Waiting for the socket to drain the rest of the response
+        FlushResult result = (events & EPOLLOUT) ? flushClient(conn) : FlushResult::Blocked;
+        if (result == FlushResult::Failed)
+        {
+            closeClient(shard, conn.fd);
+            return;
+        }
+        if (result == FlushResult::Done)
+        {
+            if (!finishResponse(shard, conn))
+                return;
+            shard.loop->modify(conn.fd, EPOLLIN | EPOLLRDHUP);
+        }
+        else
+        {
+            if (events & EPOLLHUP)
+                closeClient(shard, conn.fd);
+            return;
+        }
+    }
+
+    readRequests(shard, conn);
+}
+
+void SimpleServer::readRequests(Shard &shard, Connection &conn)
+{
+    if (conn.parser)
+    {
+        readFrames(shard, conn);
+        return;
+    }
+
+    if (!conn.response)
+    {
+        conn.response = BufferPool::local().acquire();
+        if (!conn.response)
+        {
+            closeClient(shard, conn.fd);
+            return;
+        }
+        std::memcpy(conn.response.data(), kEchoPrefix, kEchoPrefixLen);
+    }
+
+    // Edge-triggered: a persistent connection keeps serving requests until
+    // the socket runs dry
+    while (true)
+    {
+        // Echo back with a prefix: the request lands right behind it, so the
+        // reply is built without copying
+        char *request = conn.response.data() + kEchoPrefixLen;
+        ssize_t bytes_read = recv(conn.fd, request, kMaxRequest, 0);
+
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+
+        if (bytes_read <= 0)
+        {
+            closeClient(shard, conn.fd);
+            return;
+        }
+
+        NET_LOG_DEBUG("Server received: " + std::string(request, bytes_read));
+
+        if (workers_)
+        {
+            auto job = std::make_shared<Request>();
+            job->block = std::move(conn.response);
+            job->request_size = bytes_read;
+            if (offloadRequest(shard, conn, job))
+                return;
+            runRequest(*job);
+            if (!deliverResponse(shard, conn, *job))
+                return;
+            continue;
+        }
+
+        conn.response_size = buildResponse(conn.response, bytes_read, conn.reply);
+        if (!sendResponse(shard, conn))
+            return;
+    }
+}
+
+void SimpleServer::readFrames(Shard &shard, Connection &conn)
+{
+    FrameParser &parser = *conn.parser;
+    size_t read_limit = kFramedBatchBytes;
+    while (true)
+    {
+        // Pipelined requests arrive together: take everything the socket
+        // has (up to a batch), then answer all of it with one send
+        bool drained = false;
+        while (parser.buffered() < read_limit)
+        {
+            char *space = parser.prepare(kFramedReadChunk);
+            ssize_t bytes_read = recv(conn.fd, space, parser.writable(), 0);
+            if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            {
+                drained = true;
+                break;
+            }
+            if (bytes_read <= 0)
+            {
+                closeClient(shard, conn.fd);
+                return;
             }
-            // Break out of loop if server is stopping
+            parser.commit(bytes_read);
+        }
+
+        FrameView frame;
+        std::shared_ptr<Request> job;
+        if (workers_)
+        {
+            job = std::make_shared<Request>();
+            while (parser.next(frame))
+                job->frames.emplace_back(frame.data, frame.size);
+        }
+        else
+        {
+            while (parser.next(frame))
+            {
+                NET_LOG_DEBUG("Server received: " + std::string(frame.data, frame.size));
+                if (!appendFramedReply(conn.reply, frame.data, frame.size))
+                {
+                    Utils::log("Server: reply too large for the frame prefix");
+                    closeClient(shard, conn.fd);
+                    return;
+                }
+            }
+        }
+        if (parser.hasError())
+        {
+            Utils::log("Server: malformed or oversized frame, closing connection");
+            closeClient(shard, conn.fd);
+            return;
+        }
+
+        bool answered = job ? !job->frames.empty() : !conn.reply.empty();
+        if (!answered && !drained)
+        {
+            // One frame bigger than a batch: keep reading until it is whole.
+            // The parser has already refused frames over max_frame_size.
+            read_limit = parser.buffered() + kFramedReadChunk;
+            continue;
+        }
+        read_limit = kFramedBatchBytes;
+        if (answered)
+        {
+            if (job)
+            {
+                if (offloadRequest(shard, conn, job))
+                    return;
+                runRequest(*job);
+                if (!deliverResponse(shard, conn, *job))
+                    return;
+            }
+            else
+            {
+                conn.response_size = conn.reply.size();
+                if (!sendResponse(shard, conn))
+                    return;
+            }
+        }
+        if (drained)
+            return;
+    }
+}
+
+size_t SimpleServer::buildResponse(PooledBuffer &block, size_t request_size, std::string &reply) const
+{
+    if (!handler_)
+        return kEchoPrefixLen + request_size;
+
+    reply = handler_(std::string_view(block.data() + kEchoPrefixLen, request_size));
+    return reply.size();
+}
+
+// Appends one framed reply; false if it is too large for the prefix
+bool SimpleServer::appendFramedReply(std::string &out, const char *request, size_t size) const
+{
+    char prefix[FrameEncoder::kMaxPrefixSize];
+    if (handler_)
+    {
+        std::string reply = handler_(std::string_view(request, size));
+        size_t prefix_size = FrameEncoder::encodePrefix(frame_prefix_, reply.size(), prefix);
+        if (prefix_size == 0)
+            return false;
+        out.append(prefix, prefix_size).append(reply);
+        return true;
+    }
+
+    size_t prefix_size = FrameEncoder::encodePrefix(frame_prefix_, kEchoPrefixLen + size, prefix);
+    if (prefix_size == 0)
+        return false;
+    out.append(prefix, prefix_size).append(kEchoPrefix, kEchoPrefixLen).append(request, size);
+    return true;
+}
+
+void SimpleServer::runRequest(Request &request) const
+{
+    if (request.block)
+    {
+        request.response_size = buildResponse(request.block, request.request_size, request.reply);
+        return;
+    }
+
+    for (const std::string &frame : request.frames)
+    {
+        if (!appendFramedReply(request.reply, frame.data(), frame.size()))
+        {
+            request.failed = true;
             break;
         }
+    }
+    request.response_size = request.reply.size();
+}
+
+// Returns false when the pool is full and this shard has nothing at the
+// workers: no reply would come back to retry, so the caller answers it
+bool SimpleServer::offloadRequest(Shard &shard, Connection &conn, std::shared_ptr<Request> request)
+{
+    if (dispatchRequest(shard, conn, request))
+        return true;
+    if (shard.in_flight == 0)
+        return false;
+
+    // Every queue is full: the connection is not read until one of this
+    // shard's replies comes back and retries it
+    conn.held = std::move(request);
+    shard.stalled.push_back(conn.fd);
+    return true;
+}
 
-        if (!running_)
+bool SimpleServer::dispatchRequest(Shard &shard, Connection &conn, const std::shared_ptr<Request> &request)
+{
+    Shard *owner = &shard;
+    int client_fd = conn.fd;
+    uint32_t id = conn.id;
+    // Shard i feeds worker i first; idle workers steal the rest
+    bool queued = workers_->submit(
+        [this, owner, client_fd, id, request]() {
+            runRequest(*request);
+            owner->loop->post([this, owner, client_fd, id, request]() {
+                completeRequest(*owner, client_fd, id, *request);
+            });
+        },
+        static_cast<size_t>(shard.index));
+
+    if (!queued)
+        return false;
+    conn.pending = true;
+    shard.in_flight++;
+    return true;
+}
+
+void SimpleServer::completeRequest(Shard &shard, int client_fd, uint32_t id, Request &request)
+{
+    shard.in_flight--;
+
+    // The client may have gone, and its fd been reused, meanwhile
+    auto it = shard.connections.find(client_fd);
+    if (it != shard.connections.end() && it->second->id == id)
+    {
+        Connection &conn = *it->second;
+        conn.pending = false;
+        conn.last_active = std::chrono::steady_clock::now();
+        if (deliverResponse(shard, conn, request))
+            readRequests(shard, conn);
+    }
+
+    resumeStalled(shard);
+}
+
+void SimpleServer::resumeStalled(Shard &shard)
+{
+    while (!shard.stalled.empty())
+    {
+        auto it = shard.connections.find(shard.stalled.front());
+        if (it == shard.connections.end() || !it->second->held)
         {
-            // If we got a connection but server is stopping, close it
-            ::close(client_fd);
+            shard.stalled.pop_front();
+            continue;
+        }
+
+        Connection &conn = *it->second;
+        if (dispatchRequest(shard, conn, conn.held))
+        {
+            conn.held.reset();
+            shard.stalled.pop_front();
+            continue;
+        }
+        // Still full; the next reply retries
+        if (shard.in_flight > 0)
+            return;
+
+        shard.stalled.pop_front();
+        std::shared_ptr<Request> request = std::move(conn.held);
+        runRequest(*request);
+        if (deliverResponse(shard, conn, *request))
+            readRequests(shard, conn);
+    }
+}
+
+// Returns true when the connection is ready for its next request
+bool SimpleServer::deliverResponse(Shard &shard, Connection &conn, Request &request)
+{
+    if (request.failed)
+    {
+        Utils::log("Server: reply too large for the frame prefix");
+        closeClient(shard, conn.fd);
+        return false;
+    }
+    if (request.block)
+        conn.response = std::move(request.block);
+    conn.reply = std::move(request.reply);
+    conn.response_size = request.response_size;
+    return sendResponse(shard, conn);
+}
+
+// Returns true when the connection is ready for its next request
+bool SimpleServer::sendResponse(Shard &shard, Connection &conn)
+{
+    conn.responded = true;
+    FlushResult result = flushClient(conn);
+    if (result == FlushResult::Failed)
+    {
+        closeClient(shard, conn.fd);
+        return false;
+    }
+    if (result == FlushResult::Blocked)
+    {
+        shard.loop->modify(conn.fd, EPOLLOUT | EPOLLRDHUP);
+        return false;
+    }
+    return finishResponse(shard, conn);
+}
+
+SimpleServer::FlushResult SimpleServer::flushClient(Connection &conn)
+{
+    const char *data = conn.reply.empty() ? conn.response.data() : conn.reply.data();
+    while (conn.sent < conn.response_size)
+    {
+        ssize_t sent = send(conn.fd, data + conn.sent,
+                            conn.response_size - conn.sent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return FlushResult::Blocked;
+            Utils::log("Server: send() failed: " + std::string(strerror(errno)));
+            return FlushResult::Failed;
+        }
+        conn.sent += sent;
+    }
+
+    NET_LOG_DEBUG("Server sent: " + std::string(data, conn.response_size));
+    return FlushResult::Done;
+}
+
+// Returns true when the connection stays open for the next request
+bool SimpleServer::finishResponse(Shard &shard, Connection &conn)
+{
+    if (!persistent_ && !conn.parser)
+    {
+        closeClient(shard, conn.fd);
+        return false;
+    }
+    // The block keeps its "Echo: " prefix for the next reply
+    conn.reply.clear();
+    conn.response_size = 0;
+    conn.sent = 0;
+    conn.responded = false;
+    return true;
+}
+
+void SimpleServer::closeIdleClients(Shard &shard)
+{
+    uint64_t expirations;
+    while (read(shard.timer_fd, &expirations, sizeof(expirations)) > 0)
+    {
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    auto timeout = std::chrono::milliseconds(idle_timeout_ms_);
+    std::vector<int> idle;
+    for (const auto &entry : shard.connections)
+    {
+        // A connection waiting on a worker is busy, not idle
+        const Connection &conn = *entry.second;
+        if (!conn.pending && !conn.held && now - conn.last_active >= timeout)
+            idle.push_back(entry.first);
+    }
+    for (int client_fd : idle)
+    {
+        NET_LOG_DEBUG("Server: closing idle connection");
+        closeClient(shard, client_fd);
+    }
+}
+
+void SimpleServer::closeClient(Shard &shard, int client_fd)
+{
+    shard.loop->remove(client_fd);
+    ::close(client_fd);
+    shard.connections.erase(client_fd);
+    NET_LOG_DEBUG("Server: Client disconnected");
+}
+
+bool SimpleServer::setupUring(Shard &shard)
+{
+    if (!IoUring::isMultishotSupported())
+    {
+        Utils::log("Server: io_uring multishot unavailable, falling back to epoll");
+        return false;
+    }
+
+    shard.ring = std::make_unique<IoUring>(256);
+    shard.wakeup_fd = eventfd(0, EFD_CLOEXEC);
+    if (shard.wakeup_fd < 0 || !shard.ring->init() ||
+        !shard.ring->setupBufferRing(kBufferGroup, kBufferCount, kBufferSize))
+    {
+        Utils::log("Server: io_uring setup failed, falling back to epoll");
+        shard.ring.reset();
+        if (shard.wakeup_fd != -1)
+        {
+            ::close(shard.wakeup_fd);
+            shard.wakeup_fd = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+void SimpleServer::serverLoopUring(Shard *shard)
+{
+    if (pin_threads_)
+        pinCurrentThread(shard->index);
+    shard->pool = &BufferPool::local();
+
+    IoUring &ring = *shard->ring;
+    armAccept(*shard);
+
+    io_uring_sqe *sqe = ring.acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_READ, shard->wakeup_fd, &shard->wakeup_value,
+                     sizeof(shard->wakeup_value), 0, userData(kWakeup, 0));
+
+    bool active = true;
+    while (active)
+    {
+        // Every accept re-arm, receive and echo queued by the previous batch
+        // goes to the kernel in this single io_uring_enter
+        int ret = ring.submit(1);
+        if (ret < 0 && ret != -EINTR)
+        {
+            Utils::log("Server: io_uring_enter() failed: " + std::string(strerror(-ret)));
             break;
         }
 
-        Utils::log("Server: Client connected");
-        handleClient(client_fd);
+        ring.forEachCompletion([&](const io_uring_cqe &cqe) {
+            if ((cqe.user_data >> 32) == kWakeup)
+                active = false;
+            else
+                handleUringCompletion(*shard, cqe);
+        });
+    }
+
+    while (!shard->uring_connections.empty())
+    {
+        closeUringClient(*shard, shard->uring_connections.begin()->first);
     }
     Utils::log("Server: Main loop exited");
 }
 
-void SimpleServer::handleClient(int client_fd)
+void SimpleServer::armAccept(Shard &shard)
+{
+    io_uring_sqe *sqe = shard.ring->acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_ACCEPT, shard.server_fd, nullptr, 0, 0, userData(kAccept, 0));
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+}
+
+void SimpleServer::armReceive(Shard &shard, uint32_t id, int client_fd)
+{
+    io_uring_sqe *sqe = shard.ring->acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_RECV, client_fd, nullptr, 0, 0, userData(kRecv, id));
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+}
+
+void SimpleServer::armSend(Shard &shard, uint32_t id, Connection &conn)
+{
+    io_uring_sqe *sqe = shard.ring->acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_SEND, conn.fd, conn.response.data() + conn.sent,
+                     static_cast<unsigned>(conn.response_size - conn.sent), 0, userData(kSend, id));
+    sqe->msg_flags = MSG_NOSIGNAL;
+}
+
+void SimpleServer::handleUringCompletion(Shard &shard, const io_uring_cqe &cqe)
 {
-    char buffer[1024];
-    ssize_t bytes_read = recv(client_fd, buffer, sizeof(buffer) - 1, 0);
+    UringOp op = static_cast<UringOp>(cqe.user_data >> 32);
+    uint32_t id = static_cast<uint32_t>(cqe.user_data);
+    bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+    switch (op)
+    {
+    case kAccept:
+        if (cqe.res >= 0)
+        {
+            uint32_t conn_id = shard.next_connection_id++;
+            auto conn = std::make_unique<Connection>();
+            conn->fd = cqe.res;
+            conn->id = conn_id;
+            conn->response_size = 0;
+            conn->sent = 0;
+            conn->responded = false;
+            conn->pending = false;
+            shard.uring_connections[conn_id] = std::move(conn);
+            armReceive(shard, conn_id, cqe.res);
+            NET_LOG_DEBUG("Server: Client connected");
+        }
+        else if (running_)
+        {
+            Utils::log("Server: accept() failed: " + std::string(strerror(-cqe.res)));
+        }
+        if (!more && running_)
+            armAccept(shard);
+        return;
+
+    case kRecv:
+    {
+        bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+        uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+        auto it = shard.uring_connections.find(id);
+        if (it == shard.uring_connections.end())
+        {
+            if (has_buffer)
+                shard.ring->recycleBuffer(kBufferGroup, buffer_id);
+            return;
+        }
+        Connection &conn = *it->second;
+
+        if (cqe.res > 0 && !conn.responded)
+        {
+            // The provided buffer is recycled right away, so the reply is
+            // assembled in a pooled block that lives until the send completes
+            conn.response = BufferPool::local().acquire();
+            if (!conn.response)
+            {
+                shard.ring->recycleBuffer(kBufferGroup, buffer_id);
+                closeUringClient(shard, id);
+                return;
+            }
 
-    if (bytes_read > 0)
+            size_t length = std::min<size_t>(cqe.res, kMaxRequest);
+            char *request = conn.response.data() + kEchoPrefixLen;
+            std::memcpy(conn.response.data(), kEchoPrefix, kEchoPrefixLen);
+            std::memcpy(request, shard.ring->providedBuffer(kBufferGroup, buffer_id), length);
+            NET_LOG_DEBUG("Server received: " + std::string(request, length));
+
+            // Echo back with a prefix
+            conn.response_size = kEchoPrefixLen + length;
+            conn.responded = true;
+            armSend(shard, id, conn);
+        }
+        if (has_buffer)
+            shard.ring->recycleBuffer(kBufferGroup, buffer_id);
+
+        if (conn.responded)
+            return;
+        if (cqe.res <= 0 && cqe.res != -ENOBUFS)
+        {
+            closeUringClient(shard, id);
+            return;
+        }
+        if (!more)
+            armReceive(shard, id, conn.fd);
+        return;
+    }
+
+    case kSend:
     {
-        buffer[bytes_read] = '\0';
-        Utils::log("Server received: " + std::string(buffer));
+        auto it = shard.uring_connections.find(id);
+        if (it == shard.uring_connections.end())
+            return;
+        Connection &conn = *it->second;
+
+        if (cqe.res < 0)
+        {
+            Utils::log("Server: send() failed: " + std::string(strerror(-cqe.res)));
+            closeUringClient(shard, id);
+            return;
+        }
 
-        // Echo back with a prefix
-        std::string response = "Echo: " + std::string(buffer);
-        send(client_fd, response.c_str(), response.length(), 0);
-        Utils::log("Server sent: " + response);
+        conn.sent += cqe.res;
+        if (conn.sent < conn.response_size)
+        {
+            armSend(shard, id, conn);
+            return;
+        }
+
+        NET_LOG_DEBUG("Server sent: " + std::string(conn.response.data(), conn.response_size));
+        closeUringClient(shard, id);
+        return;
     }
 
-    ::close(client_fd);
-    Utils::log("Server: Client disconnected");
+    default:
+        return;
+    }
+}
+
+void SimpleServer::closeUringClient(Shard &shard, uint32_t id)
+{
+    auto it = shard.uring_connections.find(id);
+    if (it == shard.uring_connections.end())
+        return;
+
+    // Terminates the armed multishot receive before the fd can be reused
+    shutdown(it->second->fd, SHUT_RDWR);
+    ::close(it->second->fd);
+    shard.uring_connections.erase(it);
+    NET_LOG_DEBUG("Server: Client disconnected");
 }
\ No newline at end of file
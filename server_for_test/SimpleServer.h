@@ -1,42 +1,248 @@
 #pragma once
+#include "../headers/network/BufferPool.h"
+#include "../headers/network/EventLoop.h"
+#include "../headers/network/FrameCodec.h"
+#include "../headers/network/IoUring.h"
+#include "../headers/network/SocketTuning.h"
+#include "../headers/network/WorkStealingPool.h"
 #include <string>
+#include <string_view>
 #include <thread>
 #include <atomic>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <sys/socket.h>
 
 class SimpleServer {
+public:
+    // Builds the reply to one request; replaces the default echo
+    using RequestHandler = std::function<std::string(std::string_view request)>;
+
 private:
+    // A request on its way through the worker pool and back
+    struct Request {
+        // Unframed: the request, behind the "Echo: " prefix
+        PooledBuffer block;
+        size_t request_size;
+        // Framed: every complete frame of one read, answered together
+        std::vector<std::string> frames;
+        std::string reply;
+        size_t response_size;
+        // A reply did not fit the frame prefix
+        bool failed;
+    };
+
+    // Outcome of pushing a response out: all sent, waiting for EPOLLOUT,
+    // or a send() error that ends the connection
+    enum class FlushResult {
+        Done,
+        Blocked,
+        Failed
+    };
+
+    // Per-connection state kept between readiness notifications
+    struct Connection {
+        int fd;
+        // Tells a reused fd apart from the connection a worker answers
+        uint32_t id;
+        // "Echo: " + request, built in place in a pooled block
+        PooledBuffer response;
+        // A request handler's reply, or the coalesced replies of a framed
+        // connection, sent instead of the block when set
+        std::string reply;
+        size_t response_size;
+        size_t sent;
+        bool responded;
+        // A worker owns the request
+        bool pending;
+        // A request read but refused by a full worker pool
+        std::shared_ptr<Request> held;
+        // Framed connections only
+        std::unique_ptr<FrameParser> parser;
+        std::chrono::steady_clock::time_point last_active;
+    };
+
+    // One listener, event loop and thread. With several shards every one
+    // binds its own SO_REUSEPORT listener and the kernel spreads incoming
+    // connections across them.
+    struct Shard {
+        int index;
+        int server_fd;
+        std::thread thread;
+        // The shard thread's BufferPool::local(), published for stats
+        std::atomic<BufferPool *> pool;
+        std::unique_ptr<EventLoop> loop;
+        // Periodic idle-connection sweep (timerfd)
+        int timer_fd;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+        // Requests handed to the worker pool and not answered yet
+        size_t in_flight;
+        // Connections holding a request the pool refused, oldest first
+        std::deque<int> stalled;
+
+        // io_uring mode: connections are keyed by id, since a closed fd can
+        // be reused while completions for it are still in the ring
+        std::unique_ptr<IoUring> ring;
+        int wakeup_fd;
+        uint64_t wakeup_value;
+        uint32_t next_connection_id;
+        std::unordered_map<uint32_t, std::unique_ptr<Connection>> uring_connections;
+    };
+
     int port_;
-    int server_fd_;
+    int backlog_;
     std::atomic<bool> running_;
-    std::thread server_thread_;
+    IoEngine engine_;
+    int shard_count_;
+    bool pin_threads_;
+    bool persistent_;
+    bool framed_;
+    FramePrefix frame_prefix_;
+    size_t max_frame_size_;
+    int idle_timeout_ms_;
+    SocketTuning tuning_;
+    int worker_threads_;
+    size_t worker_queue_;
+    RequestHandler handler_;
+    std::unique_ptr<WorkStealingPool> workers_;
+    std::vector<std::unique_ptr<Shard>> shards_;
     
-    void serverLoop();
-    void handleClient(int client_fd);
+    bool openListener(Shard &shard);
+    bool startShard(Shard &shard);
+    // Wakes the shard's thread and joins it
+    void haltShard(Shard &shard);
+    // Frees the loop or ring and closes the shard's descriptors
+    void releaseShard(Shard &shard);
+    void pinCurrentThread(int index);
+
+    void serverLoop(Shard *shard);
+    bool startIdleTimer(Shard &shard);
+    void closeIdleClients(Shard &shard);
+    void acceptClients(Shard &shard);
+    void handleClient(Shard &shard, Connection &conn, uint32_t events);
+    void readRequests(Shard &shard, Connection &conn);
+    void readFrames(Shard &shard, Connection &conn);
+    size_t buildResponse(PooledBuffer &block, size_t request_size, std::string &reply) const;
+    bool appendFramedReply(std::string &out, const char *request, size_t size) const;
+    void runRequest(Request &request) const;
+    bool offloadRequest(Shard &shard, Connection &conn, std::shared_ptr<Request> request);
+    bool dispatchRequest(Shard &shard, Connection &conn, const std::shared_ptr<Request> &request);
+    void completeRequest(Shard &shard, int client_fd, uint32_t id, Request &request);
+    void resumeStalled(Shard &shard);
+    bool deliverResponse(Shard &shard, Connection &conn, Request &request);
+    bool sendResponse(Shard &shard, Connection &conn);
+    FlushResult flushClient(Connection &conn);
+    bool finishResponse(Shard &shard, Connection &conn);
+    void closeClient(Shard &shard, int client_fd);
+
+    bool setupUring(Shard &shard);
+    void serverLoopUring(Shard *shard);
+    void armAccept(Shard &shard);
+    void armReceive(Shard &shard, uint32_t id, int client_fd);
+    void armSend(Shard &shard, uint32_t id, Connection &conn);
+    void handleUringCompletion(Shard &shard, const io_uring_cqe &cqe);
+    void closeUringClient(Shard &shard, uint32_t id);
 
 public:
-    SimpleServer(int port);
+    SimpleServer(int port, int backlog = SOMAXCONN);
     ~SimpleServer();
+
+    // Configuration, must be called before start()
+    // Falls back to epoll when io_uring is unavailable
+    void setIoEngine(IoEngine engine);
+    // Number of SO_REUSEPORT listeners, each with its own thread and loop
+    void setShardCount(int shards);
+    // Pins shard i to CPU i (modulo the CPUs available to the process)
+    void setCpuPinning(bool enable);
+    // Keeps connections open after a reply and serves the next request on
+    // them (syscall engine; io_uring connections still close after one echo)
+    void setPersistentConnections(bool enable);
+    // Requests and replies are length-prefixed frames (see FrameCodec)
+    // instead of one recv() each, so they are not capped at 1023 bytes.
+    // Framed connections are always persistent: every complete frame of a
+    // read is answered, and the replies go out in one send(). A frame
+    // larger than `max_frame_size` closes the connection. Syscall engine.
+    void setFraming(FramePrefix prefix, size_t max_frame_size = 1024 * 1024);
+    // Closes connections with no traffic for `ms` (0, the default, never
+    // does). Checked about every ms / 4. Syscall engine.
+    void setIdleTimeout(int ms);
+    // Socket options for the listeners, inherited by accepted connections
+    void setTuning(const SocketTuning &tuning);
+    // Syscall engine only. Runs on the I/O threads, or on the workers when
+    // there are any.
+    void setRequestHandler(RequestHandler handler);
+    // Hands each request to a pool of `threads` work-stealing workers (0,
+    // the default, answers on the I/O thread). Replies go back through the
+    // I/O thread owning the connection; a connection has one request at a
+    // worker at a time. `queue_capacity` bounds each worker's queue: with
+    // all of them full a connection stops being read until its shard gets
+    // a reply back. Syscall engine only.
+    void setWorkerThreads(int threads, size_t queue_capacity = 1024);
     
     bool start();
     void stop();
     bool isRunning() const;
+    int getShardCount() const;
+    // Receive buffer pool counters summed over all shards (while running)
+    BufferPool::Stats getBufferPoolStats() const;
+    // Worker pool counters (zero without workers or while stopped)
+    WorkStealingPool::Stats getWorkerStats() const;
 };
 
 
 class SimpleUDPServer {
 private:
+    // Echo reply kept alive until its SENDMSG completes (io_uring mode)
+    struct Reply {
+        sockaddr_in peer;
+        PooledBuffer response;
+        size_t response_size;
+        iovec iov;
+        msghdr msg;
+    };
+
     int port_;
     int server_fd_;
     std::atomic<bool> running_;
     std::thread server_thread_;
+
+    IoEngine engine_;
+    int batch_size_;
+    std::unique_ptr<IoUring> ring_;
+    // Written by stop() to wake the loop (eventfd, both engines)
+    int wakeup_fd_;
+    uint64_t wakeup_value_;
+    msghdr recv_msg_;
+    uint32_t next_reply_id_;
+    std::unordered_map<uint32_t, std::unique_ptr<Reply>> replies_;
+    // Replies whose SENDMSG completed, reused for the next datagrams
+    std::vector<std::unique_ptr<Reply>> spare_replies_;
+    std::atomic<BufferPool *> pool_;
     
     void serverLoop();
 
+    bool setupUring();
+    void serverLoopUring();
+    void armReceive();
+    void handleUringCompletion(const io_uring_cqe &cqe);
+
 public:
     SimpleUDPServer(int port);
     ~SimpleUDPServer();
+
+    // Must be called before start(); falls back to recvmmsg without io_uring
+    void setIoEngine(IoEngine engine);
+    // Datagrams echoed per recvmmsg/sendmmsg pair (syscall engine); 1 gives
+    // one datagram per wakeup. Must be called before start().
+    void setBatchSize(int datagrams);
     
     bool start();
     void stop();
     bool isRunning() const;
+    // Receive buffer pool counters of the server thread (while running)
+    BufferPool::Stats getBufferPoolStats() const;
 };
\ No newline at end of file
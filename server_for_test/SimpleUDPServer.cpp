@@ -1,15 +1,38 @@
 #include "SimpleServer.h"
+#include "../needed_files/Logger.h"
 #include "../needed_files/Utils.h"
 
 #include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <algorithm>
 #include <cstring>
 #include <errno.h>
+#include <vector>
 
+namespace {
+    // io_uring user_data layout: operation in the high half, reply id low
+    enum UringOp : uint64_t { kRecv = 1, kSend = 2, kWakeup = 3 };
+    const uint16_t kBufferGroup = 0;
+    const unsigned kBufferCount = 256;
+    const size_t kBufferSize = 2048;
+
+    // Echo replies are "Echo: " + request, with requests capped at 1023 bytes
+    const char kEchoPrefix[] = "Echo: ";
+    const size_t kEchoPrefixLen = sizeof(kEchoPrefix) - 1;
+    const size_t kMaxRequest = 1023;
+    const int kDefaultBatchSize = 32;
+    // Pause after a receive error, so a persistent one cannot spin the loop
+    const int kErrorBackoffMs = 10;
+
+    uint64_t userData(UringOp op, uint32_t id) { return (static_cast<uint64_t>(op) << 32) | id; }
+}
 
 SimpleUDPServer::SimpleUDPServer(int port)
-    : port_(port), server_fd_(-1), running_(false) {}
+    : port_(port), server_fd_(-1), running_(false), engine_(IoEngine::Syscall),
+      batch_size_(kDefaultBatchSize), wakeup_fd_(-1), wakeup_value_(0), recv_msg_{}, next_reply_id_(0), pool_(nullptr) {}
 
 SimpleUDPServer::~SimpleUDPServer()
 {
@@ -46,6 +69,26 @@ bool SimpleUDPServer::start()
         return false;
     }
 
+    if (engine_ == IoEngine::IoUring && setupUring())
+    {
+        running_ = true;
+        server_thread_ = std::thread(&SimpleUDPServer::serverLoopUring, this);
+
+        Utils::log("UDP Server started on port " + std::to_string(port_) + " (io_uring)");
+        return true;
+    }
+
+    // recvmmsg() does not return when the socket is closed under it, so
+    // stop() wakes the loop through this instead
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0)
+    {
+        Utils::log("Server: eventfd() failed: " + std::string(strerror(errno)));
+        ::close(server_fd_);
+        server_fd_ = -1;
+        return false;
+    }
+
     running_ = true;
     server_thread_ = std::thread(&SimpleUDPServer::serverLoop, this);
 
@@ -60,15 +103,23 @@ void SimpleUDPServer::stop()
 
     running_ = false;
 
-    if (server_fd_ != -1) {
-        ::close(server_fd_);
-        server_fd_ = -1;
-    }
-
+    // The loop is woken and joined before the socket goes away (with
+    // io_uring, the ring owns outstanding operations on server_fd_)
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeup_fd_, &one, sizeof(one));
+    (void)ignored;
     if (server_thread_.joinable())
     {
         Utils::log("Waiting for server thread to exit...");
-        server_thread_.detach();
+        server_thread_.join();
+    }
+    ring_.reset();
+    ::close(wakeup_fd_);
+    wakeup_fd_ = -1;
+
+    if (server_fd_ != -1) {
+        ::close(server_fd_);
+        server_fd_ = -1;
     }
 
     Utils::log("UDP Server stopped cleanly.");
@@ -79,25 +130,91 @@ bool SimpleUDPServer::isRunning() const
     return running_;
 }
 
+void SimpleUDPServer::setIoEngine(IoEngine engine)
+{
+    engine_ = engine;
+}
+
+void SimpleUDPServer::setBatchSize(int datagrams)
+{
+    batch_size_ = datagrams > 0 ? datagrams : 1;
+}
+
+BufferPool::Stats SimpleUDPServer::getBufferPoolStats() const
+{
+    BufferPool *pool = pool_.load();
+    return pool ? pool->getStats() : BufferPool::Stats{};
+}
+
 void SimpleUDPServer::serverLoop()
 {
-    char buffer[1024];
-    sockaddr_in client_addr{};
-    socklen_t client_len = sizeof(client_addr);
+    pool_ = &BufferPool::local();
+    const int batch = batch_size_;
+
+    // One pooled block per batch slot. Echo back with a prefix: every
+    // datagram is received right behind it, so replies are never copied.
+    std::vector<PooledBuffer> responses(batch);
+    std::vector<sockaddr_in> peers(batch);
+    std::vector<iovec> recv_iovs(batch);
+    std::vector<iovec> send_iovs(batch);
+    std::vector<mmsghdr> requests(batch);
+    std::vector<mmsghdr> replies(batch);
+
+    for (int i = 0; i < batch; ++i)
+    {
+        responses[i] = pool_.load()->acquire();
+        if (!responses[i])
+        {
+            Utils::log("Server: Main loop exited");
+            return;
+        }
+        std::memcpy(responses[i].data(), kEchoPrefix, kEchoPrefixLen);
+        recv_iovs[i].iov_base = responses[i].data() + kEchoPrefixLen;
+        recv_iovs[i].iov_len = kMaxRequest;
+    }
 
     while (running_)
     {
-        // Receive datagram
-        ssize_t bytes_read = recvfrom(server_fd_, buffer, sizeof(buffer) - 1, 0,
-                                      (sockaddr *)&client_addr, &client_len);
+        for (int i = 0; i < batch; ++i)
+        {
+            std::memset(&requests[i], 0, sizeof(requests[i]));
+            requests[i].msg_hdr.msg_name = &peers[i];
+            requests[i].msg_hdr.msg_namelen = sizeof(peers[i]);
+            requests[i].msg_hdr.msg_iov = &recv_iovs[i];
+            requests[i].msg_hdr.msg_iovlen = 1;
+        }
 
-        if (bytes_read < 0)
+        // Take everything already queued; sleep only once the socket is
+        // dry, so a busy server pays no extra poll() per batch
+        int received = recvmmsg(server_fd_, requests.data(), batch, MSG_DONTWAIT, nullptr);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
         {
-            if (running_)
+            pollfd fds[2] = {{server_fd_, POLLIN, 0}, {wakeup_fd_, POLLIN, 0}};
+            if (poll(fds, 2, -1) < 0 && errno != EINTR)
             {
-                // Only log if we're still supposed to be running
-                Utils::log("Server: recvfrom() failed: " + std::string(strerror(errno)));
+                Utils::log("Server: poll() failed: " + std::string(strerror(errno)));
+                break;
             }
+            if (fds[1].revents != 0)
+                break;
+            continue;
+        }
+
+        if (received < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            if (!running_)
+                break;
+            Utils::log("Server: recvmmsg() failed: " + std::string(strerror(errno)));
+            // The socket itself is unusable; retrying cannot help
+            if (errno == EBADF || errno == ENOTSOCK || errno == EFAULT || errno == EINVAL)
+                break;
+
+            // Possibly transient (ENOMEM, ENOBUFS): back off, still waking for stop()
+            pollfd wakeup{wakeup_fd_, POLLIN, 0};
+            if (poll(&wakeup, 1, kErrorBackoffMs) > 0)
+                break;
             continue;
         }
 
@@ -106,17 +223,205 @@ void SimpleUDPServer::serverLoop()
             break;
         }
 
-        if (bytes_read > 0)
+        int reply_count = 0;
+        for (int i = 0; i < received; ++i)
+        {
+            size_t bytes_read = requests[i].msg_len;
+            if (bytes_read == 0)
+                continue;
+
+            NET_LOG_DEBUG("Server received: " +
+                          std::string(responses[i].data() + kEchoPrefixLen, bytes_read));
+
+            mmsghdr &reply = replies[reply_count];
+            send_iovs[reply_count].iov_base = responses[i].data();
+            send_iovs[reply_count].iov_len = kEchoPrefixLen + bytes_read;
+            std::memset(&reply, 0, sizeof(reply));
+            reply.msg_hdr.msg_name = &peers[i];
+            reply.msg_hdr.msg_namelen = requests[i].msg_hdr.msg_namelen;
+            reply.msg_hdr.msg_iov = &send_iovs[reply_count];
+            reply.msg_hdr.msg_iovlen = 1;
+            ++reply_count;
+        }
+
+        // The whole batch of echoes goes out in as few sendmmsg calls as possible
+        int sent = 0;
+        while (sent < reply_count)
         {
-            buffer[bytes_read] = '\0';
-            Utils::log("Server received: " + std::string(buffer));
-
-            // Echo back with a prefix
-            std::string response = "Echo: " + std::string(buffer);
-            sendto(server_fd_, response.c_str(), response.length(), 0,
-                   (sockaddr *)&client_addr, client_len);
-            Utils::log("Server sent: " + response);
+            int n = sendmmsg(server_fd_, replies.data() + sent, reply_count - sent, 0);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                Utils::log("Server: sendmmsg() failed: " + std::string(strerror(errno)));
+                // Skip the datagram that failed and keep going with the rest
+                n = 1;
+            }
+            else
+            {
+                for (int i = sent; i < sent + n; ++i)
+                    NET_LOG_DEBUG("Server sent: " + std::string(static_cast<char *>(send_iovs[i].iov_base),
+                                                                send_iovs[i].iov_len));
+            }
+            sent += n;
         }
     }
     Utils::log("Server: Main loop exited");
+}
+
+bool SimpleUDPServer::setupUring()
+{
+    if (!IoUring::isMultishotSupported())
+    {
+        Utils::log("Server: io_uring multishot unavailable, falling back to recvfrom");
+        return false;
+    }
+
+    ring_ = std::make_unique<IoUring>(256);
+    wakeup_fd_ = eventfd(0, EFD_CLOEXEC);
+    if (wakeup_fd_ < 0 || !ring_->init() ||
+        !ring_->setupBufferRing(kBufferGroup, kBufferCount, kBufferSize))
+    {
+        Utils::log("Server: io_uring setup failed, falling back to recvfrom");
+        ring_.reset();
+        if (wakeup_fd_ != -1)
+        {
+            ::close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+        return false;
+    }
+    return true;
+}
+
+void SimpleUDPServer::serverLoopUring()
+{
+    pool_ = &BufferPool::local();
+    armReceive();
+
+    io_uring_sqe *sqe = ring_->acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_READ, wakeup_fd_, &wakeup_value_, sizeof(wakeup_value_),
+                     0, userData(kWakeup, 0));
+
+    while (running_)
+    {
+        // All echoes produced by the previous batch are submitted together
+        int ret = ring_->submit(1);
+        if (ret < 0 && ret != -EINTR)
+        {
+            Utils::log("Server: io_uring_enter() failed: " + std::string(strerror(-ret)));
+            break;
+        }
+
+        ring_->forEachCompletion([this](const io_uring_cqe &cqe) { handleUringCompletion(cqe); });
+    }
+
+    replies_.clear();
+    spare_replies_.clear();
+    Utils::log("Server: Main loop exited");
+}
+
+void SimpleUDPServer::armReceive()
+{
+    // Multishot recvmsg only reads the name/control sizes from this header
+    std::memset(&recv_msg_, 0, sizeof(recv_msg_));
+    recv_msg_.msg_namelen = sizeof(sockaddr_in);
+
+    io_uring_sqe *sqe = ring_->acquireSqe();
+    IoUring::prepare(sqe, IORING_OP_RECVMSG, server_fd_, &recv_msg_, 1, 0, userData(kRecv, 0));
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+}
+
+void SimpleUDPServer::handleUringCompletion(const io_uring_cqe &cqe)
+{
+    UringOp op = static_cast<UringOp>(cqe.user_data >> 32);
+    uint32_t id = static_cast<uint32_t>(cqe.user_data);
+
+    if (op == kWakeup)
+    {
+        running_ = false;
+        return;
+    }
+
+    if (op == kSend)
+    {
+        auto it = replies_.find(id);
+        if (it == replies_.end())
+            return;
+        Reply &reply = *it->second;
+        if (cqe.res < 0)
+            Utils::log("Server: sendmsg() failed: " + std::string(strerror(-cqe.res)));
+        else
+            NET_LOG_DEBUG("Server sent: " + std::string(reply.response.data(), reply.response_size));
+
+        reply.response.reset();
+        spare_replies_.push_back(std::move(it->second));
+        replies_.erase(it);
+        return;
+    }
+
+    // kRecv: the provided buffer holds io_uring_recvmsg_out, name, then payload
+    if (cqe.flags & IORING_CQE_F_BUFFER)
+    {
+        uint16_t buffer_id = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+        char *buffer = ring_->providedBuffer(kBufferGroup, buffer_id);
+
+        size_t header = sizeof(io_uring_recvmsg_out) + recv_msg_.msg_namelen + recv_msg_.msg_controllen;
+        if (cqe.res > 0 && static_cast<size_t>(cqe.res) >= header)
+        {
+            const io_uring_recvmsg_out *out = reinterpret_cast<const io_uring_recvmsg_out *>(buffer);
+            size_t payload_len = std::min<size_t>(out->payloadlen, cqe.res - header);
+
+            PooledBuffer response;
+            if (payload_len > 0 && out->namelen >= sizeof(sockaddr_in))
+                response = pool_.load()->acquire();
+
+            if (response)
+            {
+                payload_len = std::min(payload_len, kMaxRequest);
+                NET_LOG_DEBUG("Server received: " + std::string(buffer + header, payload_len));
+
+                uint32_t reply_id = next_reply_id_++;
+                std::unique_ptr<Reply> reply;
+                if (spare_replies_.empty())
+                {
+                    reply = std::make_unique<Reply>();
+                }
+                else
+                {
+                    reply = std::move(spare_replies_.back());
+                    spare_replies_.pop_back();
+                }
+                std::memcpy(&reply->peer, buffer + sizeof(io_uring_recvmsg_out), sizeof(sockaddr_in));
+
+                // Echo back with a prefix
+                std::memcpy(response.data(), kEchoPrefix, kEchoPrefixLen);
+                std::memcpy(response.data() + kEchoPrefixLen, buffer + header, payload_len);
+                reply->response = std::move(response);
+                reply->response_size = kEchoPrefixLen + payload_len;
+                reply->iov.iov_base = reply->response.data();
+                reply->iov.iov_len = reply->response_size;
+                std::memset(&reply->msg, 0, sizeof(reply->msg));
+                reply->msg.msg_name = &reply->peer;
+                reply->msg.msg_namelen = sizeof(reply->peer);
+                reply->msg.msg_iov = &reply->iov;
+                reply->msg.msg_iovlen = 1;
+
+                io_uring_sqe *sqe = ring_->acquireSqe();
+                IoUring::prepare(sqe, IORING_OP_SENDMSG, server_fd_, &reply->msg, 1, 0,
+                                 userData(kSend, reply_id));
+                replies_[reply_id] = std::move(reply);
+            }
+        }
+        ring_->recycleBuffer(kBufferGroup, buffer_id);
+    }
+    else if (cqe.res < 0 && cqe.res != -ENOBUFS && running_)
+    {
+        Utils::log("Server: recvmsg() failed: " + std::string(strerror(-cqe.res)));
+    }
+
+    if (!(cqe.flags & IORING_CQE_F_MORE) && running_)
+        armReceive();
 }
\ No newline at end of file
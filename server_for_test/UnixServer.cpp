@@ -0,0 +1,351 @@
+#include "UnixServer.h"
+#include "../headers/network/UnixAddress.h"
+#include "../needed_files/Logger.h"
+#include "../needed_files/Utils.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <errno.h>
+
+namespace {
+    const char kEchoPrefix[] = "Echo: ";
+    const size_t kEchoPrefixLen = sizeof(kEchoPrefix) - 1;
+    const size_t kMaxRequest = 64 * 1024;
+
+    // Binds a new AF_UNIX socket of `type` to `path`, replacing a stale
+    // socket file left by an earlier run
+    int bindUnix(const std::string &path, int type)
+    {
+        sockaddr_un address;
+        socklen_t length;
+        if (!UnixAddress::fill(path, address, length))
+            return -1;
+
+        int fd = socket(AF_UNIX, type | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            Utils::log("Server: socket() failed: " + std::string(strerror(errno)));
+            return -1;
+        }
+
+        if (!UnixAddress::isAbstract(path))
+            ::unlink(path.c_str());
+        if (bind(fd, (sockaddr *)&address, length) < 0)
+        {
+            Utils::log("Server: bind() failed: " + std::string(strerror(errno)));
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void unbindUnix(const std::string &path)
+    {
+        if (!UnixAddress::isAbstract(path))
+            ::unlink(path.c_str());
+    }
+}
+
+SimpleUnixServer::SimpleUnixServer(const std::string &path)
+    : path_(path), server_fd_(-1), persistent_(false), running_(false), buffer_(kEchoPrefixLen + kMaxRequest) {}
+
+SimpleUnixServer::~SimpleUnixServer()
+{
+    stop();
+}
+
+void SimpleUnixServer::setPersistentConnections(bool enable)
+{
+    persistent_ = enable;
+}
+
+bool SimpleUnixServer::start()
+{
+    if (running_)
+        return true;
+
+    server_fd_ = bindUnix(path_, SOCK_STREAM);
+    if (server_fd_ < 0)
+        return false;
+
+    if (listen(server_fd_, SOMAXCONN) < 0)
+    {
+        Utils::log("Server: listen() failed: " + std::string(strerror(errno)));
+        ::close(server_fd_);
+        server_fd_ = -1;
+        unbindUnix(path_);
+        return false;
+    }
+
+    loop_ = std::make_unique<EventLoop>();
+    if (!loop_->init() || !loop_->add(server_fd_, EPOLLIN, [this](uint32_t) { acceptClients(); }))
+    {
+        Utils::log("Server: failed to set up event loop");
+        loop_.reset();
+        ::close(server_fd_);
+        server_fd_ = -1;
+        unbindUnix(path_);
+        return false;
+    }
+
+    std::memcpy(buffer_.data(), kEchoPrefix, kEchoPrefixLen);
+    running_ = true;
+    thread_ = std::thread([this]() {
+        loop_->run();
+        while (!connections_.empty())
+            closeClient(connections_.begin()->first);
+    });
+
+    Utils::log("Unix server started on " + path_);
+    return true;
+}
+
+void SimpleUnixServer::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    loop_->stop();
+    if (thread_.joinable())
+        thread_.join();
+    loop_.reset();
+
+    ::close(server_fd_);
+    server_fd_ = -1;
+    unbindUnix(path_);
+    Utils::log("Unix server stopped cleanly.");
+}
+
+bool SimpleUnixServer::isRunning() const
+{
+    return running_;
+}
+
+const std::string &SimpleUnixServer::getPath() const
+{
+    return path_;
+}
+
+void SimpleUnixServer::acceptClients()
+{
+    // Edge-triggered: drain the whole accept queue
+    while (running_)
+    {
+        int client_fd = accept4(server_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_fd < 0)
+        {
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                Utils::log("Server: accept() failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = client_fd;
+        conn->sent = 0;
+        Connection *raw = conn.get();
+        if (!loop_->add(client_fd, EPOLLIN | EPOLLRDHUP,
+                        [this, raw](uint32_t events) { handleClient(*raw, events); }))
+        {
+            ::close(client_fd);
+            continue;
+        }
+        connections_[client_fd] = std::move(conn);
+        NET_LOG_DEBUG("Unix server: Client connected");
+    }
+}
+
+void SimpleUnixServer::handleClient(Connection &conn, uint32_t events)
+{
+    if (events & EPOLLERR)
+    {
+        closeClient(conn.fd);
+        return;
+    }
+
+    if (!conn.pending.empty())
+    {
+        // Waiting for the socket to drain the rest of the reply
+        if (!(events & EPOLLOUT) || !flushClient(conn))
+            return;
+        if (!persistent_)
+        {
+            closeClient(conn.fd);
+            return;
+        }
+        loop_->modify(conn.fd, EPOLLIN | EPOLLRDHUP);
+    }
+
+    // Edge-triggered: keep serving until the socket runs dry
+    while (true)
+    {
+        ssize_t bytes_read = recv(conn.fd, buffer_.data() + kEchoPrefixLen, kMaxRequest, 0);
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return;
+        if (bytes_read <= 0)
+        {
+            closeClient(conn.fd);
+            return;
+        }
+
+        NET_LOG_DEBUG("Unix server received: " + std::string(buffer_.data() + kEchoPrefixLen, bytes_read));
+        if (!reply(conn, bytes_read))
+            return;
+    }
+}
+
+bool SimpleUnixServer::reply(Connection &conn, size_t request_size)
+{
+    size_t size = kEchoPrefixLen + request_size;
+    ssize_t sent = send(conn.fd, buffer_.data(), size, MSG_NOSIGNAL);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+    {
+        Utils::log("Server: send() failed: " + std::string(strerror(errno)));
+        closeClient(conn.fd);
+        return false;
+    }
+
+    size_t done = sent > 0 ? static_cast<size_t>(sent) : 0;
+    if (done < size)
+    {
+        // The shared buffer is reused for the next request, so keep the rest
+        conn.pending.assign(buffer_.data() + done, size - done);
+        conn.sent = 0;
+        loop_->modify(conn.fd, EPOLLOUT | EPOLLRDHUP);
+        return false;
+    }
+
+    if (!persistent_)
+    {
+        closeClient(conn.fd);
+        return false;
+    }
+    return true;
+}
+
+bool SimpleUnixServer::flushClient(Connection &conn)
+{
+    while (conn.sent < conn.pending.size())
+    {
+        ssize_t sent = send(conn.fd, conn.pending.data() + conn.sent, conn.pending.size() - conn.sent, MSG_NOSIGNAL);
+        if (sent < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+                return false;
+            Utils::log("Server: send() failed: " + std::string(strerror(errno)));
+            break;
+        }
+        conn.sent += sent;
+    }
+    conn.pending.clear();
+    conn.sent = 0;
+    return true;
+}
+
+void SimpleUnixServer::closeClient(int client_fd)
+{
+    loop_->remove(client_fd);
+    ::close(client_fd);
+    connections_.erase(client_fd);
+    NET_LOG_DEBUG("Unix server: Client disconnected");
+}
+
+SimpleUnixDatagramServer::SimpleUnixDatagramServer(const std::string &path)
+    : path_(path), server_fd_(-1), running_(false), buffer_(kEchoPrefixLen + kMaxRequest) {}
+
+SimpleUnixDatagramServer::~SimpleUnixDatagramServer()
+{
+    stop();
+}
+
+bool SimpleUnixDatagramServer::start()
+{
+    if (running_)
+        return true;
+
+    server_fd_ = bindUnix(path_, SOCK_DGRAM);
+    if (server_fd_ < 0)
+        return false;
+
+    loop_ = std::make_unique<EventLoop>();
+    if (!loop_->init() || !loop_->add(server_fd_, EPOLLIN, [this](uint32_t) { handleDatagrams(); }))
+    {
+        Utils::log("Server: failed to set up event loop");
+        loop_.reset();
+        ::close(server_fd_);
+        server_fd_ = -1;
+        unbindUnix(path_);
+        return false;
+    }
+
+    std::memcpy(buffer_.data(), kEchoPrefix, kEchoPrefixLen);
+    running_ = true;
+    thread_ = std::thread([this]() { loop_->run(); });
+
+    Utils::log("Unix datagram server started on " + path_);
+    return true;
+}
+
+void SimpleUnixDatagramServer::stop()
+{
+    if (!running_)
+        return;
+
+    running_ = false;
+    loop_->stop();
+    if (thread_.joinable())
+        thread_.join();
+    loop_.reset();
+
+    ::close(server_fd_);
+    server_fd_ = -1;
+    unbindUnix(path_);
+    Utils::log("Unix datagram server stopped cleanly.");
+}
+
+bool SimpleUnixDatagramServer::isRunning() const
+{
+    return running_;
+}
+
+const std::string &SimpleUnixDatagramServer::getPath() const
+{
+    return path_;
+}
+
+void SimpleUnixDatagramServer::handleDatagrams()
+{
+    // Edge-triggered: take every queued datagram
+    while (running_)
+    {
+        sockaddr_un peer{};
+        socklen_t peer_length = sizeof(peer);
+        ssize_t bytes_read = recvfrom(server_fd_, buffer_.data() + kEchoPrefixLen, kMaxRequest, 0,
+                                      (sockaddr *)&peer, &peer_length);
+        if (bytes_read < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                Utils::log("Server: recvfrom() failed: " + std::string(strerror(errno)));
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        NET_LOG_DEBUG("Unix server received: " + std::string(buffer_.data() + kEchoPrefixLen, bytes_read));
+
+        // An unbound sender cannot be answered
+        if (UnixAddress::toPath(peer, peer_length).empty())
+            continue;
+        // A full peer queue drops the reply rather than stalling the loop
+        if (sendto(server_fd_, buffer_.data(), kEchoPrefixLen + bytes_read, MSG_DONTWAIT,
+                   (sockaddr *)&peer, peer_length) < 0 &&
+            errno != EAGAIN)
+        {
+            Utils::log("Server: sendto() failed: " + std::string(strerror(errno)));
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "../headers/network/EventLoop.h"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Echo servers for UnixStreamSocket and UnixDatagramSocket, the AF_UNIX
+// counterparts of SimpleServer and SimpleUDPServer: one thread, one
+// EventLoop, replies are "Echo: " + request. `path` is a filesystem or
+// '@'-prefixed abstract name; a filesystem socket file is replaced on
+// start() and removed on stop().
+class SimpleUnixServer {
+private:
+    struct Connection {
+        int fd;
+        // Reply still waiting for the socket to drain
+        std::string pending;
+        size_t sent;
+    };
+
+    std::string path_;
+    int server_fd_;
+    bool persistent_;
+    std::atomic<bool> running_;
+    std::unique_ptr<EventLoop> loop_;
+    std::thread thread_;
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<char> buffer_;
+
+    void acceptClients();
+    void handleClient(Connection &conn, uint32_t events);
+    // False once the connection is closed
+    bool reply(Connection &conn, size_t request_size);
+    bool flushClient(Connection &conn);
+    void closeClient(int client_fd);
+
+public:
+    SimpleUnixServer(const std::string &path);
+    ~SimpleUnixServer();
+
+    // Keeps connections open after a reply and serves the next request on
+    // them; must be called before start()
+    void setPersistentConnections(bool enable);
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+    const std::string &getPath() const;
+};
+
+
+class SimpleUnixDatagramServer {
+private:
+    std::string path_;
+    int server_fd_;
+    std::atomic<bool> running_;
+    std::unique_ptr<EventLoop> loop_;
+    std::thread thread_;
+    std::vector<char> buffer_;
+
+    void handleDatagrams();
+
+public:
+    SimpleUnixDatagramServer(const std::string &path);
+    ~SimpleUnixDatagramServer();
+
+    bool start();
+    void stop();
+    bool isRunning() const;
+    const std::string &getPath() const;
+};
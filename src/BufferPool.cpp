@@ -0,0 +1,194 @@
+#include "../headers/network/BufferPool.h"
+#include "../needed_files/Utils.h"
+
+#include <sys/mman.h>
+#include <cstring>
+#include <errno.h>
+#include <new>
+
+
+
+namespace {
+
+    const size_t kHugePageSize = 2 * 1024 * 1024;
+
+    std::atomic<bool> local_huge_pages{false};
+
+    size_t roundUp(size_t value, size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+}
+
+struct BufferPool::LocalHolder {
+    BufferPool *pool;
+
+    LocalHolder() : pool(new BufferPool(kDefaultBlockSize, 64, local_huge_pages.load())) {}
+    ~LocalHolder() { pool->retire(); }
+};
+
+PooledBuffer::PooledBuffer(const PooledBuffer &other) : block_(other.block_) {
+    if (block_ != nullptr) {
+        block_->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PooledBuffer &PooledBuffer::operator=(const PooledBuffer &other) {
+    if (this != &other) {
+        PooledBuffer copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+PooledBuffer &PooledBuffer::operator=(PooledBuffer &&other) noexcept {
+    if (this != &other) {
+        reset();
+        block_ = other.block_;
+        other.block_ = nullptr;
+    }
+    return *this;
+}
+
+PooledBuffer::~PooledBuffer() {
+    reset();
+}
+
+size_t PooledBuffer::capacity() const {
+    return block_ ? block_->pool->getBlockSize() : 0;
+}
+
+void PooledBuffer::reset() {
+    if (block_ != nullptr && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        block_->pool->release(block_);
+    }
+    block_ = nullptr;
+}
+
+BufferPool::BufferPool(size_t block_size, size_t blocks_per_slab, bool huge_pages)
+    : block_size_(roundUp(block_size, kCacheLine)),
+      stride_(sizeof(BufferBlock) + roundUp(block_size, kCacheLine)),
+      blocks_per_slab_(blocks_per_slab > 0 ? blocks_per_slab : 1),
+      want_huge_pages_(huge_pages), huge_pages_(false),
+      owner_(std::this_thread::get_id()), free_list_(nullptr), remote_free_(nullptr),
+      slab_count_(0), hits_(0), misses_(0), remote_frees_(0), users_(1), retired_(false) {}
+
+BufferPool::~BufferPool() {
+    for (auto &slab : slabs_) {
+        munmap(slab.memory, slab.size);
+    }
+}
+
+PooledBuffer BufferPool::acquire() {
+    if (free_list_ == nullptr) {
+        // Take back everything other threads released in one exchange
+        free_list_ = remote_free_.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    if (free_list_ != nullptr) {
+        hits_.store(hits_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    } else {
+        misses_.store(misses_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (!grow()) {
+            return PooledBuffer();
+        }
+    }
+
+    BufferBlock *block = free_list_;
+    free_list_ = block->next;
+    block->next = nullptr;
+    block->refs.store(1, std::memory_order_relaxed);
+    users_.fetch_add(1, std::memory_order_relaxed);
+    return PooledBuffer(block);
+}
+
+bool BufferPool::grow() {
+    size_t size = roundUp(stride_ * blocks_per_slab_, 4096);
+    void *memory = MAP_FAILED;
+
+    if (want_huge_pages_) {
+        size_t huge_size = roundUp(size, kHugePageSize);
+        memory = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            size = huge_size;
+            huge_pages_ = true;
+        }
+    }
+
+    if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            Utils::log("Error: buffer pool mmap() failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        if (want_huge_pages_) {
+            // No reserved huge pages: ask for transparent ones instead
+            madvise(memory, size, MADV_HUGEPAGE);
+        }
+    }
+
+    slabs_.push_back(Slab{memory, size});
+    slab_count_.fetch_add(1, std::memory_order_relaxed);
+
+    char *base = static_cast<char *>(memory);
+    size_t count = size / stride_;
+    for (size_t i = count; i-- > 0;) {
+        BufferBlock *block = new (base + i * stride_) BufferBlock();
+        block->pool = this;
+        block->next = free_list_;
+        free_list_ = block;
+    }
+    return true;
+}
+
+void BufferPool::release(BufferBlock *block) {
+    if (std::this_thread::get_id() == owner_) {
+        block->next = free_list_;
+        free_list_ = block;
+    } else {
+        BufferBlock *head = remote_free_.load(std::memory_order_relaxed);
+        do {
+            block->next = head;
+        } while (!remote_free_.compare_exchange_weak(head, block, std::memory_order_release,
+                                                     std::memory_order_relaxed));
+        remote_frees_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (users_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+void BufferPool::retire() {
+    retired_.store(true, std::memory_order_relaxed);
+    if (users_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete this;
+    }
+}
+
+size_t BufferPool::getBlockSize() const {
+    return block_size_;
+}
+
+BufferPool::Stats BufferPool::getStats() const {
+    Stats stats{};
+    stats.hits = hits_.load(std::memory_order_relaxed);
+    stats.misses = misses_.load(std::memory_order_relaxed);
+    stats.remote_frees = remote_frees_.load(std::memory_order_relaxed);
+    stats.slabs = slab_count_.load(std::memory_order_relaxed);
+    size_t users = users_.load(std::memory_order_relaxed);
+    size_t owner = retired_.load(std::memory_order_relaxed) ? 0 : 1;
+    stats.blocks_in_use = users > owner ? users - owner : 0;
+    stats.huge_pages = huge_pages_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+BufferPool &BufferPool::local() {
+    static thread_local LocalHolder holder;
+    return *holder.pool;
+}
+
+void BufferPool::setLocalHugePages(bool enable) {
+    local_huge_pages.store(enable);
+}
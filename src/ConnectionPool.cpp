@@ -0,0 +1,221 @@
+#include "../headers/network/ConnectionPool.h"
+#include "../status_checker/socketStatusChecker.h"
+#include "../needed_files/Utils.h"
+
+
+
+PooledConnection::PooledConnection(ConnectionPool *pool, const std::string &key, std::unique_ptr<TCPSocket> socket)
+    : pool_(pool), key_(key), socket_(std::move(socket)) {}
+
+PooledConnection::PooledConnection(PooledConnection &&other) noexcept
+    : pool_(other.pool_), key_(std::move(other.key_)), socket_(std::move(other.socket_)) {
+    other.pool_ = nullptr;
+}
+
+PooledConnection &PooledConnection::operator=(PooledConnection &&other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = other.pool_;
+        key_ = std::move(other.key_);
+        socket_ = std::move(other.socket_);
+        other.pool_ = nullptr;
+    }
+    return *this;
+}
+
+PooledConnection::~PooledConnection() {
+    release();
+}
+
+void PooledConnection::release() {
+    if (pool_ && socket_) {
+        pool_->giveBack(key_, std::move(socket_), true);
+    }
+    pool_ = nullptr;
+}
+
+void PooledConnection::discard() {
+    if (pool_ && socket_) {
+        pool_->giveBack(key_, std::move(socket_), false);
+    }
+    pool_ = nullptr;
+}
+
+double ConnectionPool::Stats::hitRate() const {
+    uint64_t total = hits + misses;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+}
+
+ConnectionPool::ConnectionPool() : ConnectionPool(Options()) {}
+
+ConnectionPool::ConnectionPool(const Options &options)
+    : options_(options), stopping_(false), stats_{} {
+    if (options_.max_per_destination == 0) {
+        options_.max_per_destination = 1;
+    }
+    if (options_.eviction_interval_ms > 0) {
+        evictor_ = std::thread(&ConnectionPool::evictorLoop, this);
+    }
+}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    evictor_wakeup_.notify_all();
+    if (evictor_.joinable()) {
+        evictor_.join();
+    }
+    clear();
+}
+
+PooledConnection ConnectionPool::acquire(const std::string &address, int port) {
+    const std::string key = address + ":" + std::to_string(port);
+    std::vector<std::unique_ptr<TCPSocket>> dead;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    const auto deadline = Clock::now() + std::chrono::milliseconds(options_.acquire_timeout_ms);
+
+    while (true) {
+        // Looked up again after every wait: the evictor drops destinations
+        // that have nothing idle or leased
+        Destination &dest = destinations_[key];
+
+        // Most recently used first: it is the least likely to have been
+        // dropped by the peer
+        while (!dest.idle.empty()) {
+            std::unique_ptr<TCPSocket> socket = std::move(dest.idle.back().socket);
+            dest.idle.pop_back();
+            if (Network::SocketStatusChecker::isConnectionReusable(socket->getSocketFd())) {
+                ++dest.leased;
+                ++stats_.hits;
+                lock.unlock();
+                return PooledConnection(this, key, std::move(socket));
+            }
+            ++stats_.failed_checks;
+            dead.push_back(std::move(socket));
+        }
+
+        if (dest.leased < options_.max_per_destination) {
+            // Reserve the slot, then connect without holding the lock
+            ++dest.leased;
+            ++stats_.misses;
+            break;
+        }
+        if (slot_freed_.wait_until(lock, deadline) == std::cv_status::timeout) {
+            Destination &current = destinations_[key];
+            if (current.idle.empty() && current.leased >= options_.max_per_destination) {
+                ++stats_.timeouts;
+                lock.unlock();
+                Utils::log("Error: no free connection to " + key + " within " +
+                           std::to_string(options_.acquire_timeout_ms) + " ms.");
+                return PooledConnection();
+            }
+        }
+    }
+
+    lock.unlock();
+    dead.clear();
+
+    std::unique_ptr<TCPSocket> socket = std::make_unique<TCPSocket>(address, port);
+    bool opened = options_.connect_timeout_ms < 0 ? socket->open() : socket->open(options_.connect_timeout_ms);
+    if (!opened) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        --destinations_[key].leased;
+        ++stats_.failed_opens;
+        slot_freed_.notify_one();
+        return PooledConnection();
+    }
+    return PooledConnection(this, key, std::move(socket));
+}
+
+void ConnectionPool::giveBack(const std::string &key, std::unique_ptr<TCPSocket> socket, bool reusable) {
+    // Queued io_uring sends and unread response bytes would leak into the
+    // next lease
+    reusable = reusable && socket->isConnected() && socket->flush() && socket->getBufferedSize() == 0;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Destination &dest = destinations_[key];
+        --dest.leased;
+        if (reusable && !stopping_) {
+            dest.idle.push_back(IdleConnection{std::move(socket), Clock::now()});
+        }
+    }
+    slot_freed_.notify_one();
+    // A connection that is not kept is closed here, outside the lock
+}
+
+size_t ConnectionPool::evictIdle(Clock::time_point now) {
+    const auto timeout = std::chrono::milliseconds(options_.idle_timeout_ms);
+    std::vector<std::unique_ptr<TCPSocket>> expired;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto it = destinations_.begin(); it != destinations_.end();) {
+            std::vector<IdleConnection> &idle = it->second.idle;
+            // Oldest connections sit at the front
+            size_t count = 0;
+            while (count < idle.size() && now - idle[count].since >= timeout) {
+                expired.push_back(std::move(idle[count].socket));
+                ++count;
+            }
+            idle.erase(idle.begin(), idle.begin() + count);
+
+            if (idle.empty() && it->second.leased == 0) {
+                it = destinations_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        stats_.evictions += expired.size();
+    }
+    return expired.size();
+}
+
+size_t ConnectionPool::evictExpired() {
+    return evictIdle(Clock::now());
+}
+
+void ConnectionPool::evictorLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        evictor_wakeup_.wait_for(lock, std::chrono::milliseconds(options_.eviction_interval_ms));
+        if (stopping_) {
+            break;
+        }
+        lock.unlock();
+        evictIdle(Clock::now());
+        lock.lock();
+    }
+}
+
+void ConnectionPool::clear() {
+    std::vector<IdleConnection> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto &entry : destinations_) {
+            for (IdleConnection &conn : entry.second.idle) {
+                closing.push_back(std::move(conn));
+            }
+            entry.second.idle.clear();
+        }
+    }
+}
+
+ConnectionPool::Stats ConnectionPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.idle = 0;
+    stats.leased = 0;
+    for (const auto &entry : destinations_) {
+        stats.idle += entry.second.idle.size();
+        stats.leased += entry.second.leased;
+    }
+    return stats;
+}
+
+const ConnectionPool::Options &ConnectionPool::getOptions() const {
+    return options_;
+}
@@ -0,0 +1,168 @@
+#include "../headers/network/DelimiterSearch.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define DELIMITER_SEARCH_X86 1
+#endif
+
+
+
+namespace {
+
+    size_t findScalar(const char *data, size_t size, const char *delimiter, size_t delimiter_size) {
+        if (delimiter_size > size) {
+            return DelimiterSearch::npos;
+        }
+
+        const char first = delimiter[0];
+        const size_t last_start = size - delimiter_size;
+        for (size_t i = 0; i <= last_start; ++i) {
+            if (data[i] == first && std::memcmp(data + i + 1, delimiter + 1, delimiter_size - 1) == 0) {
+                return i;
+            }
+        }
+        return DelimiterSearch::npos;
+    }
+
+#ifdef DELIMITER_SEARCH_X86
+
+    // Checks the candidates flagged in `mask` (bit i = match at block + i)
+    inline size_t verifyCandidates(uint32_t mask, const char *data, size_t block, const char *delimiter,
+                                   size_t delimiter_size) {
+        while (mask != 0) {
+            unsigned bit = static_cast<unsigned>(__builtin_ctz(mask));
+            if (delimiter_size <= 2 ||
+                std::memcmp(data + block + bit + 1, delimiter + 1, delimiter_size - 2) == 0) {
+                return block + bit;
+            }
+            mask &= mask - 1;
+        }
+        return DelimiterSearch::npos;
+    }
+
+#ifdef __SSE2__
+    size_t findSse2(const char *data, size_t size, const char *delimiter, size_t delimiter_size) {
+        if (delimiter_size > size) {
+            return DelimiterSearch::npos;
+        }
+
+        const __m128i first = _mm_set1_epi8(delimiter[0]);
+        const __m128i last = _mm_set1_epi8(delimiter[delimiter_size - 1]);
+        size_t i = 0;
+
+        // Both loads of a step must stay inside the buffer
+        for (; i + delimiter_size - 1 + 16 <= size; i += 16) {
+            __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i));
+            __m128i tail = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i + delimiter_size - 1));
+            __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(head, first), _mm_cmpeq_epi8(tail, last));
+            uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+            if (mask != 0) {
+                size_t found = verifyCandidates(mask, data, i, delimiter, delimiter_size);
+                if (found != DelimiterSearch::npos) {
+                    return found;
+                }
+            }
+        }
+
+        size_t rest = findScalar(data + i, size - i, delimiter, delimiter_size);
+        return rest == DelimiterSearch::npos ? rest : i + rest;
+    }
+#endif
+
+    __attribute__((target("avx2")))
+    size_t findAvx2(const char *data, size_t size, const char *delimiter, size_t delimiter_size) {
+        if (delimiter_size > size) {
+            return DelimiterSearch::npos;
+        }
+
+        const __m256i first = _mm256_set1_epi8(delimiter[0]);
+        const __m256i last = _mm256_set1_epi8(delimiter[delimiter_size - 1]);
+        size_t i = 0;
+
+        // Both loads of a step must stay inside the buffer
+        for (; i + delimiter_size - 1 + 32 <= size; i += 32) {
+            __m256i head = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+            __m256i tail = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i + delimiter_size - 1));
+            __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(head, first), _mm256_cmpeq_epi8(tail, last));
+            uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+            if (mask != 0) {
+                size_t found = verifyCandidates(mask, data, i, delimiter, delimiter_size);
+                if (found != DelimiterSearch::npos) {
+                    return found;
+                }
+            }
+        }
+
+        size_t rest = findScalar(data + i, size - i, delimiter, delimiter_size);
+        return rest == DelimiterSearch::npos ? rest : i + rest;
+    }
+
+#endif
+
+}
+
+size_t DelimiterSearch::find(const char *data, size_t size, const char *delimiter, size_t delimiter_size) {
+    static const Kernel kernel = bestKernel();
+    return find(kernel, data, size, delimiter, delimiter_size);
+}
+
+size_t DelimiterSearch::find(Kernel kernel, const char *data, size_t size, const char *delimiter,
+                             size_t delimiter_size) {
+    if (delimiter_size == 0) {
+        return 0;
+    }
+
+    switch (kernel) {
+#ifdef DELIMITER_SEARCH_X86
+    case Kernel::AVX2:
+        return findAvx2(data, size, delimiter, delimiter_size);
+#ifdef __SSE2__
+    case Kernel::SSE2:
+        return findSse2(data, size, delimiter, delimiter_size);
+#endif
+#endif
+    default:
+        return findScalar(data, size, delimiter, delimiter_size);
+    }
+}
+
+DelimiterSearch::Kernel DelimiterSearch::bestKernel() {
+    if (isSupported(Kernel::AVX2)) {
+        return Kernel::AVX2;
+    }
+    if (isSupported(Kernel::SSE2)) {
+        return Kernel::SSE2;
+    }
+    return Kernel::Scalar;
+}
+
+bool DelimiterSearch::isSupported(Kernel kernel) {
+    switch (kernel) {
+#ifdef DELIMITER_SEARCH_X86
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#ifdef __SSE2__
+    case Kernel::SSE2:
+        return true;
+#endif
+#endif
+    case Kernel::Scalar:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char *DelimiterSearch::kernelName(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::AVX2:
+        return "avx2";
+    case Kernel::SSE2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
@@ -0,0 +1,196 @@
+#include "../headers/network/EventLoop.h"
+#include "../needed_files/Utils.h"
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cstring>
+#include <errno.h>
+
+
+
+EventLoop::EventLoop(size_t max_events)
+    : epoll_fd_(-1), wakeup_fd_(-1), running_(false), stop_requested_(false),
+      events_(max_events) {}
+
+EventLoop::~EventLoop() {
+    if (wakeup_fd_ != -1) {
+        ::close(wakeup_fd_);
+    }
+    if (epoll_fd_ != -1) {
+        ::close(epoll_fd_);
+    }
+}
+
+bool EventLoop::init() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        Utils::log("Error: epoll_create1() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeup_fd_ < 0) {
+        Utils::log("Error: eventfd() failed: " + std::string(strerror(errno)));
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+        return false;
+    }
+
+    // The wakeup fd is registered with a null pointer so run() can tell it apart
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.ptr = nullptr;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &ev) < 0) {
+        Utils::log("Error: epoll_ctl() failed: " + std::string(strerror(errno)));
+        ::close(wakeup_fd_);
+        ::close(epoll_fd_);
+        wakeup_fd_ = -1;
+        epoll_fd_ = -1;
+        return false;
+    }
+
+    return true;
+}
+
+bool EventLoop::add(int fd, uint32_t events, Callback callback) {
+    if (epoll_fd_ < 0) {
+        Utils::log("Error: event loop is not initialized.");
+        return false;
+    }
+
+    if (!setNonBlocking(fd)) {
+        return false;
+    }
+
+    auto handler = std::make_unique<Handler>();
+    handler->fd = fd;
+    handler->active = true;
+    handler->callback = std::move(callback);
+
+    epoll_event ev{};
+    ev.events = events | EPOLLET;
+    ev.data.ptr = handler.get();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        Utils::log("Error: epoll_ctl(ADD) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    handlers_[fd] = std::move(handler);
+    return true;
+}
+
+bool EventLoop::modify(int fd, uint32_t events) {
+    auto it = handlers_.find(fd);
+    if (it == handlers_.end()) {
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = events | EPOLLET;
+    ev.data.ptr = it->second.get();
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) < 0) {
+        Utils::log("Error: epoll_ctl(MOD) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::remove(int fd) {
+    auto it = handlers_.find(fd);
+    if (it == handlers_.end()) {
+        return;
+    }
+
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+
+    // Later events of the current batch (or the running callback itself) may
+    // still reference this handler, so it is only deactivated here
+    it->second->active = false;
+    retired_.push_back(std::move(it->second));
+    handlers_.erase(it);
+}
+
+void EventLoop::run() {
+    if (epoll_fd_ < 0) {
+        Utils::log("Error: event loop is not initialized.");
+        return;
+    }
+
+    running_ = true;
+    while (!stop_requested_) {
+        int n = epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()), -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Utils::log("Error: epoll_wait() failed: " + std::string(strerror(errno)));
+            break;
+        }
+
+        for (int i = 0; i < n; ++i) {
+            Handler* handler = static_cast<Handler*>(events_[i].data.ptr);
+            if (handler == nullptr) {
+                uint64_t value;
+                while (::read(wakeup_fd_, &value, sizeof(value)) > 0) {
+                }
+                runPosted();
+                continue;
+            }
+            if (handler->active) {
+                handler->callback(events_[i].events);
+            }
+        }
+
+        retired_.clear();
+    }
+    running_ = false;
+}
+
+void EventLoop::post(std::function<void()> fn) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        // Only the first function of a batch needs to wake the loop
+        wake = posted_.empty();
+        posted_.push_back(std::move(fn));
+    }
+    if (wake && wakeup_fd_ != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeup_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void EventLoop::runPosted() {
+    std::vector<std::function<void()>> batch;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex_);
+        batch.swap(posted_);
+    }
+    for (auto &fn : batch) {
+        fn();
+    }
+}
+
+void EventLoop::stop() {
+    stop_requested_ = true;
+    if (wakeup_fd_ != -1) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wakeup_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+bool EventLoop::isRunning() const {
+    return running_;
+}
+
+bool EventLoop::setNonBlocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        Utils::log("Error: fcntl(O_NONBLOCK) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,200 @@
+#include "../headers/network/FrameCodec.h"
+#include "../headers/network/TCPSocket.h"
+#include "../needed_files/Utils.h"
+
+#include <cstring>
+
+
+
+FrameEncoder::FrameEncoder(FramePrefix prefix) : prefix_(prefix), frames_(0) {}
+
+size_t FrameEncoder::encodePrefix(FramePrefix prefix, uint64_t length, char *out) {
+    switch (prefix) {
+    case FramePrefix::Fixed16:
+        if (length > 0xFFFF) {
+            return 0;
+        }
+        out[0] = static_cast<char>(length >> 8);
+        out[1] = static_cast<char>(length);
+        return 2;
+
+    case FramePrefix::Fixed32:
+        if (length > 0xFFFFFFFFULL) {
+            return 0;
+        }
+        out[0] = static_cast<char>(length >> 24);
+        out[1] = static_cast<char>(length >> 16);
+        out[2] = static_cast<char>(length >> 8);
+        out[3] = static_cast<char>(length);
+        return 4;
+
+    default: {
+        size_t size = 0;
+        while (length >= 0x80) {
+            out[size++] = static_cast<char>((length & 0x7F) | 0x80);
+            length >>= 7;
+        }
+        out[size++] = static_cast<char>(length);
+        return size;
+    }
+    }
+}
+
+bool FrameEncoder::add(const char *data, size_t size) {
+    char prefix[kMaxPrefixSize];
+    size_t prefix_size = encodePrefix(prefix_, size, prefix);
+    if (prefix_size == 0) {
+        Utils::log("Error: frame of " + std::to_string(size) + " bytes does not fit the length prefix.");
+        return false;
+    }
+
+    buffer_.append(prefix, prefix_size);
+    buffer_.append(data, size);
+    ++frames_;
+    return true;
+}
+
+bool FrameEncoder::add(const std::string &payload) {
+    return add(payload.data(), payload.size());
+}
+
+bool FrameEncoder::flush(TCPSocket &socket) {
+    if (buffer_.empty()) {
+        return true;
+    }
+
+    bool ok = socket.send(buffer_.data(), buffer_.size());
+    clear();
+    return ok;
+}
+
+const std::string &FrameEncoder::buffer() const {
+    return buffer_;
+}
+
+size_t FrameEncoder::pendingFrames() const {
+    return frames_;
+}
+
+void FrameEncoder::clear() {
+    buffer_.clear();
+    frames_ = 0;
+}
+
+FrameParser::FrameParser(FramePrefix prefix, size_t max_frame_size)
+    : prefix_(prefix), max_frame_size_(max_frame_size), error_(false) {}
+
+char *FrameParser::prepare(size_t size) {
+    return buffer_.prepare(size);
+}
+
+size_t FrameParser::writable() const {
+    return buffer_.writable();
+}
+
+void FrameParser::commit(size_t size) {
+    buffer_.commit(size);
+}
+
+void FrameParser::feed(const char *data, size_t size) {
+    std::memcpy(buffer_.prepare(size), data, size);
+    buffer_.commit(size);
+}
+
+ssize_t FrameParser::readFrom(TCPSocket &socket, size_t chunk) {
+    char *space = buffer_.prepare(chunk);
+    ssize_t n = socket.receive(space, buffer_.writable());
+    if (n > 0) {
+        buffer_.commit(n);
+    }
+    return n;
+}
+
+bool FrameParser::next(FrameView &frame) {
+    if (error_) {
+        return false;
+    }
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(buffer_.data());
+    size_t available = buffer_.size();
+    uint64_t length = 0;
+    size_t prefix_size = 0;
+
+    switch (prefix_) {
+    case FramePrefix::Fixed16:
+        if (available < 2) {
+            return false;
+        }
+        length = (static_cast<uint64_t>(data[0]) << 8) | data[1];
+        prefix_size = 2;
+        break;
+
+    case FramePrefix::Fixed32:
+        if (available < 4) {
+            return false;
+        }
+        length = (static_cast<uint64_t>(data[0]) << 24) | (static_cast<uint64_t>(data[1]) << 16) |
+                 (static_cast<uint64_t>(data[2]) << 8) | data[3];
+        prefix_size = 4;
+        break;
+
+    default: {
+        unsigned shift = 0;
+        while (true) {
+            if (prefix_size == available) {
+                return false; // Prefix not complete yet
+            }
+            if (prefix_size == FrameEncoder::kMaxPrefixSize) {
+                Utils::log("Error: malformed varint frame prefix.");
+                error_ = true;
+                return false;
+            }
+            unsigned char byte = data[prefix_size++];
+            // The 10th byte holds bit 63 only; anything more would be
+            // shifted out and wrap the length to a small value
+            if (shift == 63 && byte > 1) {
+                Utils::log("Error: varint frame prefix overflows 64 bits.");
+                error_ = true;
+                return false;
+            }
+            length |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                break;
+            }
+            shift += 7;
+        }
+        break;
+    }
+    }
+
+    if (length > max_frame_size_) {
+        Utils::log("Error: frame of " + std::to_string(length) + " bytes exceeds the limit of " +
+                   std::to_string(max_frame_size_) + ".");
+        error_ = true;
+        return false;
+    }
+
+    if (available - prefix_size < length) {
+        return false;
+    }
+
+    // Consuming only advances the read position, so the view stays valid
+    // until the buffer is written to again
+    frame.data = buffer_.data() + prefix_size;
+    frame.size = static_cast<size_t>(length);
+    buffer_.consume(prefix_size + frame.size);
+    return true;
+}
+
+bool FrameParser::hasError() const {
+    return error_;
+}
+
+size_t FrameParser::buffered() const {
+    return buffer_.size();
+}
+
+void FrameParser::reset() {
+    buffer_.clear();
+    error_ = false;
+}
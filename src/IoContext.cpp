@@ -0,0 +1,163 @@
+#include "../headers/network/IoContext.h"
+#include "../needed_files/Utils.h"
+
+#include <vector>
+
+
+
+struct IoContext::Detached {
+    struct promise_type {
+        IoContext *io;
+
+        promise_type(IoContext *context, Task<void> &) : io(context) {}
+        ~promise_type() {
+            io->finished(std::coroutine_handle<promise_type>::from_promise(*this).address());
+        }
+
+        Detached get_return_object() {
+            return Detached{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        // Suspended first so spawn() can record the frame before it runs
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+IoContext::Detached IoContext::runDetached(IoContext *, Task<void> task) {
+    co_await task;
+}
+
+bool IoContext::ReadinessAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    if (!io_->watch(fd_)) {
+        return false;
+    }
+    Waiters &waiters = io_->fds_[fd_];
+    ReadinessAwaiter *&slot = write_ ? waiters.writer : waiters.reader;
+    if (slot != nullptr) {
+        Utils::log("Error: fd " + std::to_string(fd_) + " already has a " + (write_ ? "writer" : "reader") +
+                   " waiting.");
+        return false;
+    }
+    handle_ = handle;
+    slot = this;
+    return true;
+}
+
+IoContext::IoContext() : stop_when_idle_(false), closing_(false) {}
+
+IoContext::~IoContext() {
+    // Frames destroyed here close their sockets, which forget() their fds
+    // without resuming anyone
+    closing_ = true;
+    std::vector<void *> roots(roots_.begin(), roots_.end());
+    for (void *root : roots) {
+        std::coroutine_handle<>::from_address(root).destroy();
+    }
+    for (auto &entry : fds_) {
+        loop_.remove(entry.first);
+    }
+}
+
+bool IoContext::init() {
+    return loop_.init();
+}
+
+bool IoContext::watch(int fd) {
+    if (fds_.count(fd) != 0) {
+        return true;
+    }
+    if (!loop_.add(fd, EPOLLIN | EPOLLOUT | EPOLLRDHUP, [this, fd](uint32_t events) { dispatch(fd, events); })) {
+        return false;
+    }
+    fds_[fd] = Waiters{nullptr, nullptr};
+    return true;
+}
+
+void IoContext::forget(int fd) {
+    auto it = fds_.find(fd);
+    if (it == fds_.end()) {
+        return;
+    }
+    Waiters waiters = it->second;
+    fds_.erase(it);
+    loop_.remove(fd);
+
+    if (closing_) {
+        return;
+    }
+    // Entry is gone first: a resumed coroutine may register the fd number
+    // again for a new socket
+    for (ReadinessAwaiter *awaiter : {waiters.reader, waiters.writer}) {
+        if (awaiter != nullptr) {
+            awaiter->ready_ = false;
+            awaiter->handle_.resume();
+        }
+    }
+}
+
+IoContext::ReadinessAwaiter IoContext::readable(int fd) {
+    return ReadinessAwaiter(this, fd, false);
+}
+
+IoContext::ReadinessAwaiter IoContext::writable(int fd) {
+    return ReadinessAwaiter(this, fd, true);
+}
+
+void IoContext::dispatch(int fd, uint32_t events) {
+    const uint32_t kReadEvents = EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR;
+    const uint32_t kWriteEvents = EPOLLOUT | EPOLLHUP | EPOLLERR;
+
+    // Looked up again after each resume: the reader may close the socket
+    auto it = fds_.find(fd);
+    if (it != fds_.end() && (events & kReadEvents) && it->second.reader != nullptr) {
+        ReadinessAwaiter *reader = it->second.reader;
+        it->second.reader = nullptr;
+        reader->ready_ = true;
+        reader->handle_.resume();
+    }
+    it = fds_.find(fd);
+    if (it != fds_.end() && (events & kWriteEvents) && it->second.writer != nullptr) {
+        ReadinessAwaiter *writer = it->second.writer;
+        it->second.writer = nullptr;
+        writer->ready_ = true;
+        writer->handle_.resume();
+    }
+}
+
+void IoContext::spawn(Task<void> task) {
+    Detached detached = runDetached(this, std::move(task));
+    roots_.insert(detached.handle.address());
+    detached.handle.resume();
+}
+
+void IoContext::finished(void *root) {
+    roots_.erase(root);
+    if (roots_.empty() && stop_when_idle_ && !closing_) {
+        loop_.stop();
+    }
+}
+
+size_t IoContext::getActiveTasks() const {
+    return roots_.size();
+}
+
+void IoContext::run() {
+    loop_.run();
+}
+
+void IoContext::runUntilIdle() {
+    if (roots_.empty()) {
+        return;
+    }
+    stop_when_idle_ = true;
+    loop_.run();
+    stop_when_idle_ = false;
+}
+
+void IoContext::stop() {
+    loop_.stop();
+}
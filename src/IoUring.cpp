@@ -0,0 +1,634 @@
+#include "../headers/network/IoUring.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../needed_files/Utils.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <errno.h>
+#include <algorithm>
+
+
+
+namespace {
+
+    const uint64_t kRecvTag = ~0ULL;
+    const uint64_t kTimeoutTag = ~0ULL - 1;
+    const unsigned kChannelRingEntries = 64;
+    // Sends queued between flushes; two slots stay free for a receive and
+    // its linked timeout
+    const size_t kMaxPendingSends = kChannelRingEntries - 2;
+
+    int ioUringSetup(unsigned entries, io_uring_params *params) {
+        return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+    }
+
+    int ioUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+        SyscallCounter::add();
+        return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete,
+                                        flags, nullptr, 0));
+    }
+
+    int ioUringRegister(int fd, unsigned opcode, const void *arg, unsigned nr_args) {
+        return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+    }
+
+    // Entries start at the ring base; the header's flexible array member is
+    // laid out at a different offset when compiled as C++
+    io_uring_buf *ringEntries(io_uring_buf_ring *ring) {
+        return reinterpret_cast<io_uring_buf *>(ring);
+    }
+
+    // Probes the opcodes the socket engine relies on
+    bool probeOpcodes(const std::vector<uint8_t> &required) {
+        io_uring_params params{};
+        int fd = ioUringSetup(2, &params);
+        if (fd < 0) {
+            return false;
+        }
+
+        const unsigned ops = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + ops * sizeof(io_uring_probe_op), 0);
+        io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(storage.data());
+        bool ok = ioUringRegister(fd, IORING_REGISTER_PROBE, probe, ops) == 0;
+        for (uint8_t op : required) {
+            if (!ok || op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                ok = false;
+                break;
+            }
+        }
+
+        ::close(fd);
+        return ok;
+    }
+
+}
+
+IoUring::IoUring(unsigned entries)
+    : ring_fd_(-1), entries_(entries), sq_ptr_(MAP_FAILED), sq_size_(0),
+      cq_ptr_(MAP_FAILED), cq_size_(0), sqes_(nullptr), sqes_size_(0),
+      sq_head_(nullptr), sq_tail_(nullptr), sq_mask_(nullptr), sq_array_(nullptr),
+      cq_head_(nullptr), cq_tail_(nullptr), cq_mask_(nullptr), cqes_(nullptr),
+      sqe_tail_(0), sqe_head_(0) {}
+
+IoUring::~IoUring() {
+    for (auto &br : buffer_rings_) {
+        munmap(br.ring, br.ring_size);
+        munmap(br.buffers, br.buffers_size);
+    }
+    if (sqes_ != nullptr) {
+        munmap(sqes_, sqes_size_);
+    }
+    if (cq_ptr_ != MAP_FAILED && cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_size_);
+    }
+    if (sq_ptr_ != MAP_FAILED) {
+        munmap(sq_ptr_, sq_size_);
+    }
+    if (ring_fd_ != -1) {
+        ::close(ring_fd_);
+    }
+}
+
+bool IoUring::init() {
+    io_uring_params params{};
+    ring_fd_ = ioUringSetup(entries_, &params);
+    if (ring_fd_ < 0) {
+        Utils::log("Error: io_uring_setup() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single_mmap) {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring_fd_, IORING_OFF_SQ_RING);
+    if (sq_ptr_ == MAP_FAILED) {
+        Utils::log("Error: io_uring mmap() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    if (single_mmap) {
+        cq_ptr_ = sq_ptr_;
+    } else {
+        cq_ptr_ = mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                       ring_fd_, IORING_OFF_CQ_RING);
+        if (cq_ptr_ == MAP_FAILED) {
+            Utils::log("Error: io_uring mmap() failed: " + std::string(strerror(errno)));
+            return false;
+        }
+    }
+
+    sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        Utils::log("Error: io_uring mmap() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    sqes_ = static_cast<io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(sq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+    char *cq = static_cast<char *>(cq_ptr_);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    entries_ = params.sq_entries;
+    sqe_tail_ = sqe_head_ = *sq_tail_;
+    return true;
+}
+
+bool IoUring::isValid() const {
+    return sqes_ != nullptr;
+}
+
+bool IoUring::isSupported() {
+    static const bool supported = probeOpcodes({IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED,
+                                                IORING_OP_SENDMSG, IORING_OP_LINK_TIMEOUT});
+    return supported;
+}
+
+bool IoUring::isMultishotSupported() {
+    // SEND_ZC shipped in the same release as multishot recv (6.0), which came
+    // after multishot accept and provided buffer rings (5.19)
+    static const bool supported = probeOpcodes({IORING_OP_ACCEPT, IORING_OP_RECV,
+                                                IORING_OP_RECVMSG, IORING_OP_SENDMSG,
+                                                IORING_OP_SEND_ZC});
+    return supported;
+}
+
+io_uring_sqe *IoUring::getSqe() {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sqe_tail_ - head >= entries_) {
+        return nullptr;
+    }
+    io_uring_sqe *sqe = &sqes_[sqe_tail_ & *sq_mask_];
+    ++sqe_tail_;
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+io_uring_sqe *IoUring::acquireSqe() {
+    io_uring_sqe *sqe = getSqe();
+    if (sqe == nullptr) {
+        submit();
+        sqe = getSqe();
+    }
+    return sqe;
+}
+
+unsigned IoUring::pendingSubmissions() const {
+    return sqe_tail_ - sqe_head_;
+}
+
+unsigned IoUring::freeSqes() const {
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    return entries_ - (sqe_tail_ - head);
+}
+
+int IoUring::submit(unsigned wait_nr) {
+    unsigned tail = *sq_tail_;
+    unsigned to_submit = sqe_tail_ - sqe_head_;
+    while (sqe_head_ != sqe_tail_) {
+        sq_array_[tail & *sq_mask_] = sqe_head_ & *sq_mask_;
+        ++tail;
+        ++sqe_head_;
+    }
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+
+    unsigned flags = wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0;
+    int ret;
+    do {
+        ret = ioUringEnter(ring_fd_, to_submit, wait_nr, flags);
+    } while (ret < 0 && errno == EINTR && to_submit == 0);
+
+    return ret < 0 ? -errno : ret;
+}
+
+io_uring_cqe *IoUring::peekCompletion() {
+    unsigned head = *cq_head_;
+    if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+        return nullptr;
+    }
+    return &cqes_[head & *cq_mask_];
+}
+
+void IoUring::completionSeen() {
+    __atomic_store_n(cq_head_, *cq_head_ + 1, __ATOMIC_RELEASE);
+}
+
+bool IoUring::registerBuffers(const iovec *iovecs, unsigned count) {
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_BUFFERS, iovecs, count) < 0) {
+        Utils::log("Error: io_uring buffer registration failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool IoUring::setupBufferRing(uint16_t group_id, unsigned entries, size_t buffer_size) {
+    // The kernel requires a power-of-two ring size
+    unsigned ring_entries = 1;
+    while (ring_entries < entries) {
+        ring_entries <<= 1;
+    }
+
+    BufferRing br{};
+    br.ring_size = ring_entries * sizeof(io_uring_buf);
+    br.buffers_size = ring_entries * buffer_size;
+    br.buffer_size = buffer_size;
+    br.entries = ring_entries;
+    br.group_id = group_id;
+
+    void *ring = mmap(nullptr, br.ring_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    void *buffers = mmap(nullptr, br.buffers_size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED || buffers == MAP_FAILED) {
+        Utils::log("Error: buffer ring mmap() failed: " + std::string(strerror(errno)));
+        if (ring != MAP_FAILED) munmap(ring, br.ring_size);
+        if (buffers != MAP_FAILED) munmap(buffers, br.buffers_size);
+        return false;
+    }
+    br.ring = static_cast<io_uring_buf_ring *>(ring);
+    br.buffers = static_cast<char *>(buffers);
+
+    io_uring_buf_reg reg{};
+    reg.ring_addr = reinterpret_cast<uint64_t>(br.ring);
+    reg.ring_entries = ring_entries;
+    reg.bgid = group_id;
+    if (ioUringRegister(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        Utils::log("Error: io_uring buffer ring registration failed: " + std::string(strerror(errno)));
+        munmap(ring, br.ring_size);
+        munmap(buffers, br.buffers_size);
+        return false;
+    }
+
+    for (unsigned i = 0; i < ring_entries; ++i) {
+        io_uring_buf &buf = ringEntries(br.ring)[i];
+        buf.addr = reinterpret_cast<uint64_t>(br.buffers + i * buffer_size);
+        buf.len = static_cast<uint32_t>(buffer_size);
+        buf.bid = static_cast<uint16_t>(i);
+    }
+    __atomic_store_n(&br.ring->tail, static_cast<uint16_t>(ring_entries), __ATOMIC_RELEASE);
+
+    buffer_rings_.push_back(br);
+    return true;
+}
+
+char *IoUring::providedBuffer(uint16_t group_id, uint16_t buffer_id) {
+    for (auto &br : buffer_rings_) {
+        if (br.group_id == group_id) {
+            return br.buffers + static_cast<size_t>(buffer_id) * br.buffer_size;
+        }
+    }
+    return nullptr;
+}
+
+void IoUring::recycleBuffer(uint16_t group_id, uint16_t buffer_id) {
+    for (auto &br : buffer_rings_) {
+        if (br.group_id != group_id) {
+            continue;
+        }
+        uint16_t tail = br.ring->tail;
+        io_uring_buf &buf = ringEntries(br.ring)[tail & (br.entries - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(br.buffers + static_cast<size_t>(buffer_id) * br.buffer_size);
+        buf.len = static_cast<uint32_t>(br.buffer_size);
+        buf.bid = buffer_id;
+        __atomic_store_n(&br.ring->tail, static_cast<uint16_t>(tail + 1), __ATOMIC_RELEASE);
+        return;
+    }
+}
+
+void IoUring::prepare(io_uring_sqe *sqe, uint8_t opcode, int fd, const void *addr,
+                      unsigned len, uint64_t offset, uint64_t user_data) {
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(addr);
+    sqe->len = len;
+    sqe->off = offset;
+    sqe->user_data = user_data;
+}
+
+IoUringChannel::IoUringChannel(size_t buffer_size)
+    : ring_(kChannelRingEntries), buffer_size_(buffer_size), queued_bytes_(0), in_flight_(0), broken_(false) {}
+
+bool IoUringChannel::init() {
+    if (!IoUring::isSupported() || !ring_.init()) {
+        return false;
+    }
+
+    send_region_.resize(buffer_size_);
+    recv_region_.resize(buffer_size_);
+
+    iovec regions[2];
+    regions[0].iov_base = send_region_.data();
+    regions[0].iov_len = send_region_.size();
+    regions[1].iov_base = recv_region_.data();
+    regions[1].iov_len = recv_region_.size();
+    if (!ring_.registerBuffers(regions, 2)) {
+        return false;
+    }
+
+    pending_.reserve(kMaxPendingSends);
+    return true;
+}
+
+bool IoUringChannel::queueSend(int fd, const char *data, size_t size) {
+    if (broken_) {
+        errno = EIO;
+        return false;
+    }
+    while (size > 0) {
+        bool new_entry = pending_.empty() || pending_.back().datagram;
+        if ((queued_bytes_ == send_region_.size() || (new_entry && pending_.size() == kMaxPendingSends)) &&
+            !flush(fd)) {
+            return false;
+        }
+
+        size_t chunk = std::min(size, send_region_.size() - queued_bytes_);
+        std::memcpy(send_region_.data() + queued_bytes_, data, chunk);
+
+        // Stream data is contiguous, so it extends the previous write
+        if (!pending_.empty() && !pending_.back().datagram) {
+            pending_.back().length += chunk;
+        } else {
+            PendingSend send{};
+            send.offset = queued_bytes_;
+            send.length = chunk;
+            pending_.push_back(send);
+        }
+
+        queued_bytes_ += chunk;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+bool IoUringChannel::queueSendTo(int fd, const char *data, size_t size, const sockaddr_in &peer) {
+    iovec iov{const_cast<char *>(data), size};
+    return queueSendTo(fd, &iov, 1, peer);
+}
+
+bool IoUringChannel::queueSendTo(int fd, const iovec *iov, int count, const sockaddr_in &peer) {
+    if (broken_) {
+        errno = EIO;
+        return false;
+    }
+    size_t size = 0;
+    for (int i = 0; i < count; ++i) {
+        size += iov[i].iov_len;
+    }
+
+    if (size > send_region_.size()) {
+        errno = EMSGSIZE;
+        Utils::log("Error: datagram larger than io_uring send region.");
+        return false;
+    }
+
+    if ((send_region_.size() - queued_bytes_ < size || pending_.size() == kMaxPendingSends) &&
+        !flush(fd)) {
+        return false;
+    }
+
+    char *dest = send_region_.data() + queued_bytes_;
+    for (int i = 0; i < count; ++i) {
+        std::memcpy(dest, iov[i].iov_base, iov[i].iov_len);
+        dest += iov[i].iov_len;
+    }
+
+    PendingSend send{};
+    send.offset = queued_bytes_;
+    send.length = size;
+    send.datagram = true;
+    send.peer = peer;
+    pending_.push_back(send);
+
+    queued_bytes_ += size;
+    return true;
+}
+
+bool IoUringChannel::hasPending() const {
+    return !pending_.empty();
+}
+
+void IoUringChannel::prepareSends(int fd, unsigned reserve) {
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        PendingSend &send = pending_[i];
+        if (send.in_flight || send.sent == send.length) {
+            continue;
+        }
+        if (ring_.freeSqes() <= reserve) {
+            return;
+        }
+
+        io_uring_sqe *sqe = ring_.getSqe();
+        if (sqe == nullptr) {
+            return;
+        }
+
+        char *base = send_region_.data() + send.offset + send.sent;
+        size_t remaining = send.length - send.sent;
+        if (send.datagram) {
+            send.iov.iov_base = base;
+            send.iov.iov_len = remaining;
+            std::memset(&send.msg, 0, sizeof(send.msg));
+            send.msg.msg_name = &send.peer;
+            send.msg.msg_namelen = sizeof(send.peer);
+            send.msg.msg_iov = &send.iov;
+            send.msg.msg_iovlen = 1;
+            IoUring::prepare(sqe, IORING_OP_SENDMSG, fd, &send.msg, 1, 0, i);
+            sqe->msg_flags = MSG_NOSIGNAL;
+        } else {
+            IoUring::prepare(sqe, IORING_OP_WRITE_FIXED, fd, base,
+                             static_cast<unsigned>(remaining), 0, i);
+            sqe->buf_index = 0;
+        }
+        send.in_flight = true;
+        ++in_flight_;
+    }
+}
+
+bool IoUringChannel::handleSendCompletion(const io_uring_cqe &cqe) {
+    PendingSend &send = pending_[cqe.user_data];
+    send.in_flight = false;
+    --in_flight_;
+
+    if (cqe.res < 0) {
+        if (cqe.res == -EAGAIN || cqe.res == -EINTR) {
+            return true; // Resubmitted on the next round
+        }
+        errno = -cqe.res;
+        Utils::log("Error: io_uring send failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    if (cqe.res == 0 && !send.datagram) {
+        errno = EPIPE;
+        Utils::log("Error: Connection closed by peer during send.");
+        return false;
+    }
+
+    // A short stream write is resubmitted from where it stopped
+    send.sent = send.datagram ? send.length : send.sent + cqe.res;
+    return true;
+}
+
+bool IoUringChannel::flush(int fd) {
+    if (broken_) {
+        errno = EIO;
+        return false;
+    }
+    bool ok = true;
+    int saved_errno = 0;
+
+    while (true) {
+        if (ok) {
+            prepareSends(fd);
+        }
+        if (in_flight_ == 0 && ring_.pendingSubmissions() == 0) {
+            break;
+        }
+
+        int ret = ring_.submit(1);
+        if (ret < 0 && ret != -EINTR) {
+            errno = -ret;
+            Utils::log("Error: io_uring_enter() failed: " + std::string(strerror(errno)));
+            abandon(0);
+            return false;
+        }
+
+        ring_.forEachCompletion([&](const io_uring_cqe &cqe) {
+            if (!handleSendCompletion(cqe) && ok) {
+                ok = false;
+                saved_errno = errno;
+            }
+        });
+    }
+
+    reset();
+    if (!ok) {
+        errno = saved_errno;
+    }
+    return ok;
+}
+
+ssize_t IoUringChannel::receive(int fd, char *buffer, size_t size, long timeout_ms) {
+    if (broken_) {
+        errno = EIO;
+        return -1;
+    }
+    // The receive and its linked timeout have to go in back to back
+    unsigned needed = timeout_ms > 0 ? 2 : 1;
+    prepareSends(fd, needed);
+    if (ring_.freeSqes() < needed) {
+        errno = EBUSY;
+        return -1;
+    }
+
+    io_uring_sqe *sqe = ring_.getSqe();
+    size_t len = std::min(size, recv_region_.size());
+    IoUring::prepare(sqe, IORING_OP_READ_FIXED, fd, recv_region_.data(),
+                     static_cast<unsigned>(len), 0, kRecvTag);
+    sqe->buf_index = 1;
+
+    __kernel_timespec timeout{};
+    if (timeout_ms > 0) {
+        sqe->flags |= IOSQE_IO_LINK;
+        timeout.tv_sec = timeout_ms / 1000;
+        timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+        io_uring_sqe *timeout_sqe = ring_.getSqe();
+        IoUring::prepare(timeout_sqe, IORING_OP_LINK_TIMEOUT, -1, &timeout, 1, 0, kTimeoutTag);
+    }
+
+    bool received = false;
+    // A linked timeout always completes too, either fired or cancelled
+    bool timeout_pending = timeout_ms > 0;
+    int recv_result = 0;
+    bool sends_ok = true;
+    int saved_errno = 0;
+
+    while (!received || timeout_pending || in_flight_ > 0 || ring_.pendingSubmissions() > 0) {
+        int ret = ring_.submit(1);
+        if (ret < 0 && ret != -EINTR) {
+            errno = -ret;
+            Utils::log("Error: io_uring_enter() failed: " + std::string(strerror(errno)));
+            abandon((received ? 0 : 1) + (timeout_pending ? 1 : 0));
+            return -1;
+        }
+
+        ring_.forEachCompletion([&](const io_uring_cqe &cqe) {
+            if (cqe.user_data == kRecvTag) {
+                received = true;
+                recv_result = cqe.res;
+            } else if (cqe.user_data == kTimeoutTag) {
+                timeout_pending = false;
+            } else {
+                if (!handleSendCompletion(cqe) && sends_ok) {
+                    sends_ok = false;
+                    saved_errno = errno;
+                }
+            }
+        });
+
+        if (sends_ok) {
+            prepareSends(fd);
+        }
+    }
+
+    reset();
+
+    if (!sends_ok) {
+        errno = saved_errno;
+        return -1;
+    }
+
+    if (recv_result < 0) {
+        errno = recv_result == -ECANCELED ? EAGAIN : -recv_result;
+        return -1;
+    }
+
+    std::memcpy(buffer, recv_region_.data(), recv_result);
+    return recv_result;
+}
+
+void IoUringChannel::abandon(unsigned others) {
+    int saved_errno = errno;
+    while (in_flight_ > 0 || others > 0) {
+        int ret = ring_.submit(1);
+        if (ret < 0 && ret != -EINTR) {
+            Utils::log("Error: io_uring channel unusable, requests still in flight.");
+            broken_ = true;
+            errno = saved_errno;
+            return;
+        }
+        ring_.forEachCompletion([&](const io_uring_cqe &cqe) {
+            if (cqe.user_data == kRecvTag || cqe.user_data == kTimeoutTag) {
+                if (others > 0) {
+                    --others;
+                }
+            } else {
+                handleSendCompletion(cqe);
+            }
+        });
+    }
+    reset();
+    errno = saved_errno;
+}
+
+void IoUringChannel::reset() {
+    pending_.clear();
+    queued_bytes_ = 0;
+}
@@ -0,0 +1,52 @@
+#include "../headers/network/ReadBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+
+ReadBuffer::ReadBuffer() : begin_(0), end_(0) {}
+
+char* ReadBuffer::prepare(size_t size) {
+    if (data_.size() - end_ < size) {
+        // Slide the unread bytes to the front before growing
+        if (begin_ > 0) {
+            std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (data_.size() - end_ < size) {
+            data_.resize(std::max(end_ + size, data_.size() * 2));
+        }
+    }
+    return data_.data() + end_;
+}
+
+void ReadBuffer::commit(size_t size) {
+    end_ = std::min(end_ + size, data_.size());
+}
+
+void ReadBuffer::consume(size_t size) {
+    begin_ += std::min(size, end_ - begin_);
+    if (begin_ == end_) {
+        begin_ = end_ = 0;
+    }
+}
+
+size_t ReadBuffer::read(char* dest, size_t size) {
+    size_t n = std::min(size, end_ - begin_);
+    std::memcpy(dest, data_.data() + begin_, n);
+    consume(n);
+    return n;
+}
+
+std::string ReadBuffer::take(size_t size) {
+    size_t n = std::min(size, end_ - begin_);
+    std::string result(data_.data() + begin_, n);
+    consume(n);
+    return result;
+}
+
+void ReadBuffer::clear() {
+    begin_ = end_ = 0;
+}
@@ -0,0 +1,730 @@
+#include "../headers/network/SharedMemorySocket.h"
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../headers/network/UnixAddress.h"
+#include "../needed_files/Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <linux/futex.h>
+#include <new>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+
+
+// One direction of the connection. The producer owns `head` and the
+// consumer `tail` (both count bytes since the start), each on a cache
+// line of its own so the two sides do not keep stealing it from each
+// other. The *_seq counters are the futex words a sleeping side waits on;
+// *_waiting tells the other side whether a wakeup is needed at all.
+struct ShmRing {
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint32_t> data_seq;
+    std::atomic<uint32_t> reader_waiting;
+    std::atomic<uint32_t> producer_closed;
+    alignas(64) std::atomic<uint32_t> space_seq;
+    std::atomic<uint32_t> writer_waiting;
+    std::atomic<uint32_t> consumer_closed;
+};
+
+namespace {
+
+    using Clock = std::chrono::steady_clock;
+
+    constexpr uint32_t kMagic = 0x4d48534e; // "NSHM"
+    constexpr uint32_t kVersion = 1;
+    constexpr size_t kDefaultRingSize = 256 * 1024;
+    constexpr size_t kMinRingSize = 4096;
+    constexpr size_t kMaxRingSize = size_t(1) << 30;
+    constexpr int kEventCount = 4;
+    // Longest single futex sleep, so a peer that died without closing is
+    // still noticed
+    constexpr int kLivenessCheckMs = 100;
+    constexpr int kHandshakeTimeoutSeconds = 5;
+
+    // Start of the region; the creator sends on ring 0, the acceptor on ring 1
+    struct RegionHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_size;
+        ShmRing rings[2];
+    };
+
+    // The data areas follow, page aligned
+    constexpr size_t kDataOffset = (sizeof(RegionHeader) + 4095) & ~size_t(4095);
+
+    // Sent by the creator together with the memfd (and the eventfds)
+    struct Hello {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t ring_size;
+        uint32_t wakeup;
+        uint32_t fd_count;
+    };
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+                  "shared rings need address-free atomics");
+
+    size_t roundRingSize(size_t bytes) {
+        size_t size = kMinRingSize;
+        while (size < bytes && size < kMaxRingSize) {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    // Not FUTEX_PRIVATE_FLAG: waiter and waker may be different processes.
+    // True when the whole timeout passed without a wakeup.
+    bool futexWait(std::atomic<uint32_t>& word, uint32_t expected, int timeout_ms) {
+        timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+        SyscallCounter::add();
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0) < 0 &&
+               errno == ETIMEDOUT;
+    }
+
+    void futexWake(std::atomic<uint32_t>& word) {
+        SyscallCounter::add();
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    // Wakes whoever sleeps on `seq`, whether it asked or not
+    void wake(std::atomic<uint32_t>& seq, ShmWakeup mode, int event_fd) {
+        seq.fetch_add(1, std::memory_order_seq_cst);
+        if (mode == ShmWakeup::Futex) {
+            futexWake(seq);
+            return;
+        }
+        uint64_t one = 1;
+        SyscallCounter::add();
+        if (::write(event_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            Utils::log("Error: write(eventfd) failed: " + std::string(strerror(errno)));
+        }
+    }
+
+    // Called after publishing head or tail. The fence pairs with the one in
+    // waitUntil(): either this side sees `waiting` set or the sleeper sees
+    // the new position, so a wakeup is never lost and the common case (the
+    // peer is busy) costs no syscall.
+    void notify(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting, ShmWakeup mode, int event_fd) {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) != 0) {
+            wake(seq, mode, event_fd);
+        }
+    }
+
+    // With one CPU the peer cannot run while this side spins, so spinning
+    // only delays the data it waits for
+    bool canSpin() {
+        static const bool multi_core = std::thread::hardware_concurrency() > 1;
+        return multi_core;
+    }
+
+    // Nothing is sent on the control connection after the handshake, so
+    // readable means closed
+    bool hungUp(int control_fd) {
+        pollfd pfd{control_fd, POLLIN | POLLRDHUP, 0};
+        SyscallCounter::add();
+        return ::poll(&pfd, 1, 0) > 0;
+    }
+
+    // Spins, then sleeps until ready() holds. 1 when ready, 0 after
+    // `timeout_ms` (-1 waits forever) with errno EAGAIN, -1 once the peer
+    // is gone.
+    template <typename Ready>
+    int waitUntil(Ready ready, std::atomic<uint32_t>& seq, std::atomic<uint32_t>& waiting, ShmWakeup mode,
+                  int event_fd, int control_fd, std::chrono::nanoseconds spin, int timeout_ms) {
+        if (ready()) {
+            return 1;
+        }
+        if (spin.count() > 0 && canSpin()) {
+            Clock::time_point spin_end = Clock::now() + spin;
+            do {
+                for (int i = 0; i < 64; ++i) {
+                    if (ready()) {
+                        return 1;
+                    }
+                    cpuRelax();
+                }
+            } while (Clock::now() < spin_end);
+        }
+
+        Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(std::max(timeout_ms, 0));
+        int result;
+        while (true) {
+            uint32_t observed = seq.load(std::memory_order_acquire);
+            waiting.store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (ready()) {
+                result = 1;
+                break;
+            }
+
+            int slice = -1;
+            if (timeout_ms >= 0) {
+                auto left = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now()).count();
+                if (left <= 0) {
+                    errno = EAGAIN;
+                    result = 0;
+                    break;
+                }
+                slice = static_cast<int>(left);
+            }
+
+            if (mode == ShmWakeup::Futex) {
+                // A changed `seq` returns at once, so a wakeup between the
+                // check above and the sleep is not lost
+                bool timed_out = futexWait(seq, observed, slice < 0 ? kLivenessCheckMs : std::min(slice, kLivenessCheckMs));
+                if (timed_out && !ready() && hungUp(control_fd)) {
+                    result = -1;
+                    break;
+                }
+                continue;
+            }
+
+            pollfd fds[2] = {{event_fd, POLLIN, 0}, {control_fd, POLLIN | POLLRDHUP, 0}};
+            SyscallCounter::add();
+            int n = ::poll(fds, 2, slice);
+            if (n < 0 && errno != EINTR) {
+                Utils::log("Error: poll() failed: " + std::string(strerror(errno)));
+                result = -1;
+                break;
+            }
+            if (n > 0 && (fds[0].revents & POLLIN)) {
+                uint64_t count;
+                SyscallCounter::add();
+                [[maybe_unused]] ssize_t drained = ::read(event_fd, &count, sizeof(count));
+            }
+            if (n > 0 && fds[1].revents != 0 && !ready()) {
+                result = -1;
+                break;
+            }
+        }
+        waiting.store(0, std::memory_order_relaxed);
+        return result;
+    }
+
+    void copyToRing(char* ring, size_t ring_size, uint64_t position, const char* data, size_t size) {
+        size_t offset = position & (ring_size - 1);
+        size_t first = std::min(size, ring_size - offset);
+        std::memcpy(ring + offset, data, first);
+        std::memcpy(ring, data + first, size - first);
+    }
+
+    void copyFromRing(const char* ring, size_t ring_size, uint64_t position, char* data, size_t size) {
+        size_t offset = position & (ring_size - 1);
+        size_t first = std::min(size, ring_size - offset);
+        std::memcpy(data, ring + offset, first);
+        std::memcpy(data + first, ring, size - first);
+    }
+
+    void closeAll(const int* fds, int count) {
+        for (int i = 0; i < count; ++i) {
+            ::close(fds[i]);
+        }
+    }
+
+}
+
+SharedMemorySocket::SharedMemorySocket(const std::string& path)
+    : path_(path), control_(path), wakeup_(ShmWakeup::Futex), ring_size_(kDefaultRingSize), spin_time_(0),
+      receive_timeout_ms_(-1), send_timeout_ms_(-1), region_(nullptr), region_size_(0), out_(nullptr), in_(nullptr), out_data_(nullptr),
+      in_data_(nullptr), out_data_event_(-1), out_space_event_(-1), in_data_event_(-1), in_space_event_(-1),
+      out_head_(0), out_tail_cache_(0), in_tail_(0), in_head_cache_(0) {}
+
+SharedMemorySocket::~SharedMemorySocket() {
+    close();
+}
+
+void SharedMemorySocket::setRingSize(size_t bytes) {
+    ring_size_ = roundRingSize(bytes);
+}
+
+void SharedMemorySocket::setWakeup(ShmWakeup wakeup) {
+    wakeup_ = wakeup;
+}
+
+void SharedMemorySocket::setSpinTime(std::chrono::nanoseconds spin) {
+    spin_time_ = spin;
+}
+
+bool SharedMemorySocket::open() {
+    if (!control_.open()) {
+        return false;
+    }
+
+    int fds[1 + kEventCount];
+    int fd_count = 0;
+    fds[fd_count] = memfd_create("network-shm", MFD_CLOEXEC);
+    if (fds[fd_count] < 0) {
+        Utils::log("Error: memfd_create() failed: " + std::string(strerror(errno)));
+        control_.close();
+        return false;
+    }
+    ++fd_count;
+    if (ftruncate(fds[0], kDataOffset + 2 * ring_size_) < 0) {
+        Utils::log("Error: ftruncate() failed: " + std::string(strerror(errno)));
+        closeAll(fds, fd_count);
+        control_.close();
+        return false;
+    }
+    if (wakeup_ == ShmWakeup::EventFd) {
+        for (int i = 0; i < kEventCount; ++i) {
+            fds[fd_count] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (fds[fd_count] < 0) {
+                Utils::log("Error: eventfd() failed: " + std::string(strerror(errno)));
+                closeAll(fds, fd_count);
+                control_.close();
+                return false;
+            }
+            ++fd_count;
+        }
+    }
+
+    if (!mapRegion(fds[0], ring_size_, 0, wakeup_ == ShmWakeup::EventFd ? fds + 1 : nullptr)) {
+        closeAll(fds, fd_count);
+        control_.close();
+        return false;
+    }
+    // The mapping keeps the memory alive; the peer gets its own reference
+    Hello hello{kMagic, kVersion, ring_size_, static_cast<uint32_t>(wakeup_), static_cast<uint32_t>(fd_count)};
+    bool sent = control_.setReceiveTimeout(kHandshakeTimeoutSeconds) &&
+                control_.sendFds(reinterpret_cast<const char*>(&hello), sizeof(hello), fds, fd_count);
+    ::close(fds[0]);
+    char ack = 0;
+    if (!sent || control_.receive(&ack, 1) != 1 || ack != 1) {
+        Utils::log("Error: shared memory handshake with " + path_ + " failed.");
+        close();
+        return false;
+    }
+    control_.setReceiveTimeout(0);
+
+    Utils::log("Shared memory connection established to " + path_ + " (" + std::to_string(ring_size_ / 1024) +
+               " KB rings)");
+    return true;
+}
+
+bool SharedMemorySocket::attach(int fd) {
+    if (!control_.adopt(fd)) {
+        ::close(fd);
+        return false;
+    }
+
+    Hello hello{};
+    int fds[1 + kEventCount];
+    int fd_count = 0;
+    control_.setReceiveTimeout(kHandshakeTimeoutSeconds);
+    ssize_t n = control_.receiveFds(reinterpret_cast<char*>(&hello), sizeof(hello), fds, 1 + kEventCount, fd_count);
+
+    // The peer is trusted to be on this host, not to be well behaved
+    bool valid = n == static_cast<ssize_t>(sizeof(hello)) && hello.magic == kMagic && hello.version == kVersion &&
+                 hello.fd_count == static_cast<uint32_t>(fd_count) && hello.ring_size == roundRingSize(hello.ring_size) &&
+                 ((hello.wakeup == static_cast<uint32_t>(ShmWakeup::Futex) && fd_count == 1) ||
+                  (hello.wakeup == static_cast<uint32_t>(ShmWakeup::EventFd) && fd_count == 1 + kEventCount));
+    struct stat info;
+    valid = valid && fstat(fds[0], &info) == 0 &&
+            static_cast<uint64_t>(info.st_size) >= kDataOffset + 2 * hello.ring_size;
+    if (valid) {
+        wakeup_ = static_cast<ShmWakeup>(hello.wakeup);
+        valid = mapRegion(fds[0], hello.ring_size, 1, wakeup_ == ShmWakeup::EventFd ? fds + 1 : nullptr);
+        if (!valid) {
+            closeAll(fds + 1, fd_count - 1);
+        }
+    } else {
+        closeAll(fds + 1, std::max(fd_count - 1, 0));
+    }
+    if (fd_count > 0) {
+        ::close(fds[0]);
+    }
+    if (valid) {
+        const RegionHeader* header = static_cast<const RegionHeader*>(region_);
+        valid = header->magic == kMagic && header->ring_size == ring_size_;
+    }
+
+    char ack = valid ? 1 : 0;
+    if (!valid || !control_.send(&ack, 1)) {
+        Utils::log("Error: rejected shared memory handshake on " + path_);
+        close();
+        return false;
+    }
+    control_.setReceiveTimeout(0);
+    return true;
+}
+
+bool SharedMemorySocket::mapRegion(int memfd, size_t ring_size, int out_ring, const int* events) {
+    size_t size = kDataOffset + 2 * ring_size;
+    void* region = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, memfd, 0);
+    if (region == MAP_FAILED) {
+        Utils::log("Error: mmap() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    int in_ring = 1 - out_ring;
+    RegionHeader* header = static_cast<RegionHeader*>(region);
+    if (out_ring == 0) {
+        // The creator lays out an empty, open ring pair
+        header = new (region) RegionHeader();
+        header->magic = kMagic;
+        header->version = kVersion;
+        header->ring_size = ring_size;
+    }
+    char* data = static_cast<char*>(region) + kDataOffset;
+    region_ = region;
+    region_size_ = size;
+    ring_size_ = ring_size;
+    out_ = &header->rings[out_ring];
+    in_ = &header->rings[in_ring];
+    out_data_ = data + out_ring * ring_size;
+    in_data_ = data + in_ring * ring_size;
+    if (events != nullptr) {
+        out_data_event_ = events[out_ring * 2];
+        out_space_event_ = events[out_ring * 2 + 1];
+        in_data_event_ = events[in_ring * 2];
+        in_space_event_ = events[in_ring * 2 + 1];
+    }
+    out_head_ = out_->head.load(std::memory_order_relaxed);
+    out_tail_cache_ = out_->tail.load(std::memory_order_acquire);
+    in_tail_ = in_->tail.load(std::memory_order_relaxed);
+    in_head_cache_ = in_->head.load(std::memory_order_acquire);
+    return true;
+}
+
+void SharedMemorySocket::releaseRegion() {
+    munmap(region_, region_size_);
+    region_ = nullptr;
+    region_size_ = 0;
+    out_ = in_ = nullptr;
+    out_data_ = in_data_ = nullptr;
+    for (int* fd : {&out_data_event_, &out_space_event_, &in_data_event_, &in_space_event_}) {
+        if (*fd != -1) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void SharedMemorySocket::close() {
+    if (region_ == nullptr) {
+        control_.close();
+        return;
+    }
+
+    // Ends both rings for the peer and wakes it if it sleeps on either
+    out_->producer_closed.store(1, std::memory_order_release);
+    wake(out_->data_seq, wakeup_, out_data_event_);
+    in_->consumer_closed.store(1, std::memory_order_release);
+    wake(in_->space_seq, wakeup_, in_space_event_);
+
+    releaseRegion();
+    control_.close();
+    Utils::log("Shared memory socket closed.");
+}
+
+bool SharedMemorySocket::send(const std::string& data) {
+    return send(data.data(), data.size());
+}
+
+bool SharedMemorySocket::send(const char* data, size_t size) {
+    iovec iov{const_cast<char*>(data), size};
+    return sendv(&iov, 1);
+}
+
+bool SharedMemorySocket::sendv(const iovec* iov, int count) {
+    if (region_ == nullptr) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    uint64_t start = out_head_;
+    for (int i = 0; i < count; ++i) {
+        const char* data = static_cast<const char*>(iov[i].iov_base);
+        size_t left = iov[i].iov_len;
+        while (left > 0) {
+            size_t space = ring_size_ - (out_head_ - out_tail_cache_);
+            if (space == 0) {
+                out_tail_cache_ = out_->tail.load(std::memory_order_acquire);
+                if (out_head_ - out_tail_cache_ > ring_size_) {
+                    protocolError("send");
+                    op.fail();
+                    return false;
+                }
+                space = ring_size_ - (out_head_ - out_tail_cache_);
+            }
+            if (space == 0 || out_->consumer_closed.load(std::memory_order_relaxed) != 0) {
+                // Lets the peer drain what is already copied before sleeping
+                out_->head.store(out_head_, std::memory_order_release);
+                notify(out_->data_seq, out_->reader_waiting, wakeup_, out_data_event_);
+                int ready = waitForSpace(send_timeout_ms_);
+                if (ready == 0) {
+                    // What was copied so far stays in the ring
+                    Utils::log("Error: send() timed out waiting for the peer to drain the ring.");
+                    op.fail();
+                    return false;
+                }
+                if (ready < 0 || out_->consumer_closed.load(std::memory_order_acquire) != 0) {
+                    Utils::log("Error: send() failed: peer closed the shared memory ring.");
+                    errno = EPIPE;
+                    op.fail();
+                    return false;
+                }
+                out_tail_cache_ = out_->tail.load(std::memory_order_acquire);
+                if (out_head_ - out_tail_cache_ > ring_size_) {
+                    protocolError("send");
+                    op.fail();
+                    return false;
+                }
+                continue;
+            }
+
+            size_t chunk = std::min(left, space);
+            copyToRing(out_data_, ring_size_, out_head_, data, chunk);
+            out_head_ += chunk;
+            data += chunk;
+            left -= chunk;
+        }
+    }
+
+    out_->head.store(out_head_, std::memory_order_release);
+    notify(out_->data_seq, out_->reader_waiting, wakeup_, out_data_event_);
+    op.complete(out_head_ - start);
+    return true;
+}
+
+std::string SharedMemorySocket::receive() {
+    return receive(4096); // Default buffer size
+}
+
+std::string SharedMemorySocket::receive(size_t max_size) {
+    std::string result(max_size, '\0');
+    ssize_t n = receive(&result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return result;
+}
+
+ssize_t SharedMemorySocket::receive(char* buffer, size_t size) {
+    iovec iov{buffer, size};
+    return receivev(&iov, 1);
+}
+
+ssize_t SharedMemorySocket::receivev(const iovec* iov, int count) {
+    if (region_ == nullptr) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    if (in_head_cache_ == in_tail_) {
+        in_head_cache_ = in_->head.load(std::memory_order_acquire);
+    }
+    if (in_head_cache_ == in_tail_) {
+        if (waitForData(receive_timeout_ms_) == 0) {
+            op.retry();
+            return -1;
+        }
+        // Woken by data, or by the peer closing after its last send
+        in_head_cache_ = in_->head.load(std::memory_order_acquire);
+        if (in_head_cache_ == in_tail_) {
+            Utils::log("Connection closed by peer.");
+            return 0;
+        }
+    }
+    if (in_head_cache_ - in_tail_ > ring_size_) {
+        protocolError("receive");
+        op.fail();
+        return -1;
+    }
+
+    uint64_t start = in_tail_;
+    for (int i = 0; i < count && in_tail_ < in_head_cache_; ++i) {
+        size_t chunk = std::min(iov[i].iov_len, static_cast<size_t>(in_head_cache_ - in_tail_));
+        copyFromRing(in_data_, ring_size_, in_tail_, static_cast<char*>(iov[i].iov_base), chunk);
+        in_tail_ += chunk;
+    }
+    in_->tail.store(in_tail_, std::memory_order_release);
+    notify(in_->space_seq, in_->writer_waiting, wakeup_, in_space_event_);
+
+    op.complete(in_tail_ - start);
+    return static_cast<ssize_t>(in_tail_ - start);
+}
+
+void SharedMemorySocket::protocolError(const char* call) {
+    Utils::log("Error: " + std::string(call) + "() failed: peer moved a ring position out of range.");
+    close();
+    errno = EPROTO;
+}
+
+int SharedMemorySocket::waitForData(int timeout_ms) {
+    auto ready = [this]() {
+        return in_->head.load(std::memory_order_acquire) != in_tail_ ||
+               in_->producer_closed.load(std::memory_order_acquire) != 0;
+    };
+    return waitUntil(ready, in_->data_seq, in_->reader_waiting, wakeup_, in_data_event_, control_.getSocketFd(),
+                     spin_time_, timeout_ms);
+}
+
+int SharedMemorySocket::waitForSpace(int timeout_ms) {
+    auto ready = [this]() {
+        // Out of range (tail past head) also ends the wait; sendv() rejects it
+        return out_head_ - out_->tail.load(std::memory_order_acquire) != ring_size_ ||
+               out_->consumer_closed.load(std::memory_order_acquire) != 0;
+    };
+    return waitUntil(ready, out_->space_seq, out_->writer_waiting, wakeup_, out_space_event_, control_.getSocketFd(),
+                     spin_time_, timeout_ms);
+}
+
+int SharedMemorySocket::getSocketFd() const {
+    return control_.getSocketFd();
+}
+
+size_t SharedMemorySocket::getBufferedSize() const {
+    if (region_ == nullptr) {
+        return 0;
+    }
+    return static_cast<size_t>(std::min<uint64_t>(in_->head.load(std::memory_order_acquire) - in_tail_, ring_size_));
+}
+
+bool SharedMemorySocket::isConnected() const {
+    return region_ != nullptr;
+}
+
+bool SharedMemorySocket::setReceiveTimeout(int seconds) {
+    return setReceiveTimeout(std::chrono::seconds(seconds));
+}
+
+bool SharedMemorySocket::setReceiveTimeout(std::chrono::milliseconds timeout) {
+    receive_timeout_ms_ = timeout.count() > 0 ? static_cast<int>(std::min<int64_t>(timeout.count(), INT_MAX)) : -1;
+    return true;
+}
+
+bool SharedMemorySocket::setSendTimeout(int seconds) {
+    return setSendTimeout(std::chrono::seconds(seconds));
+}
+
+bool SharedMemorySocket::setSendTimeout(std::chrono::milliseconds timeout) {
+    send_timeout_ms_ = timeout.count() > 0 ? static_cast<int>(std::min<int64_t>(timeout.count(), INT_MAX)) : -1;
+    return true;
+}
+
+bool SharedMemorySocket::setStatsEnabled(bool enable) {
+#if NETWORK_SOCKET_STATS
+    if (!enable) {
+        stats_.reset();
+    } else if (!stats_) {
+        stats_ = std::make_unique<SocketStats>();
+    }
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+const SocketStats* SharedMemorySocket::getStats() const {
+    return stats_.get();
+}
+
+size_t SharedMemorySocket::getRingSize() const {
+    return ring_size_;
+}
+
+ShmWakeup SharedMemorySocket::getWakeup() const {
+    return wakeup_;
+}
+
+const std::string& SharedMemorySocket::getPath() const {
+    return path_;
+}
+
+
+SharedMemoryAcceptor::SharedMemoryAcceptor(const std::string& path, int backlog)
+    : path_(path), backlog_(backlog), listen_fd_(-1) {}
+
+SharedMemoryAcceptor::~SharedMemoryAcceptor() {
+    close();
+}
+
+bool SharedMemoryAcceptor::listen() {
+    sockaddr_un address;
+    socklen_t length;
+    if (!UnixAddress::fill(path_, address, length)) {
+        return false;
+    }
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        Utils::log("Error: socket() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    if (!UnixAddress::isAbstract(path_)) {
+        ::unlink(path_.c_str());
+    }
+    if (bind(listen_fd_, (sockaddr*)&address, length) < 0 || ::listen(listen_fd_, backlog_) < 0) {
+        Utils::log("Error: listen on " + path_ + " failed: " + std::string(strerror(errno)));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    return true;
+}
+
+void SharedMemoryAcceptor::close() {
+    if (listen_fd_ != -1) {
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        if (!UnixAddress::isAbstract(path_)) {
+            ::unlink(path_.c_str());
+        }
+    }
+}
+
+std::unique_ptr<SharedMemorySocket> SharedMemoryAcceptor::accept(int timeout_ms) {
+    if (listen_fd_ < 0) {
+        Utils::log("Error: acceptor is not listening.");
+        return nullptr;
+    }
+
+    std::chrono::microseconds timeout = timeout_ms < 0 ? std::chrono::microseconds(-1)
+                                                       : std::chrono::milliseconds(timeout_ms);
+    if (SocketSet::waitFd(listen_fd_, SocketSet::Read, timeout) <= 0) {
+        return nullptr;
+    }
+    SyscallCounter::add();
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        Utils::log("Error: accept() failed: " + std::string(strerror(errno)));
+        return nullptr;
+    }
+
+    auto socket = std::make_unique<SharedMemorySocket>(path_);
+    if (!socket->attach(fd)) {
+        return nullptr;
+    }
+    return socket;
+}
+
+int SharedMemoryAcceptor::getSocketFd() const {
+    return listen_fd_;
+}
+
+const std::string& SharedMemoryAcceptor::getPath() const {
+    return path_;
+}
@@ -0,0 +1,313 @@
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../needed_files/Utils.h"
+
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+
+
+namespace {
+
+    timespec remainingTime(SocketSet::Clock::time_point deadline) {
+        auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - SocketSet::Clock::now());
+        timespec ts{};
+        if (left.count() > 0) {
+            ts.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+            ts.tv_nsec = static_cast<long>(left.count() % 1000000000);
+        }
+        return ts;
+    }
+
+    short pollEvents(uint32_t interest) {
+        short events = 0;
+        if (interest & SocketSet::Read) events |= POLLIN;
+        if (interest & SocketSet::Write) events |= POLLOUT;
+        return events;
+    }
+
+    uint32_t epollEvents(uint32_t interest) {
+        uint32_t events = 0;
+        if (interest & SocketSet::Read) events |= EPOLLIN;
+        if (interest & SocketSet::Write) events |= EPOLLOUT;
+        return events;
+    }
+
+    uint32_t fromPoll(short revents) {
+        uint32_t events = 0;
+        if (revents & POLLIN) events |= SocketSet::Read;
+        if (revents & POLLOUT) events |= SocketSet::Write;
+        if (revents & (POLLERR | POLLHUP | POLLNVAL)) events |= SocketSet::Error;
+        return events;
+    }
+
+    uint32_t fromEpoll(uint32_t revents) {
+        uint32_t events = 0;
+        if (revents & EPOLLIN) events |= SocketSet::Read;
+        if (revents & EPOLLOUT) events |= SocketSet::Write;
+        if (revents & (EPOLLERR | EPOLLHUP)) events |= SocketSet::Error;
+        return events;
+    }
+
+}
+
+SocketSet::SocketSet(Backend backend) : backend_(backend), epoll_fd_(-1) {
+    if (backend_ == Backend::Epoll) {
+        epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd_ < 0) {
+            Utils::log("Error: epoll_create1() failed: " + std::string(strerror(errno)) + ", using poll.");
+            backend_ = Backend::Poll;
+        }
+    }
+}
+
+SocketSet::~SocketSet() {
+    if (epoll_fd_ >= 0) {
+        ::close(epoll_fd_);
+    }
+}
+
+bool SocketSet::add(ISocket *socket, uint32_t interest) {
+    int fd = socket->getSocketFd();
+    if (fd < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    if (index_.count(fd) != 0) {
+        return modify(socket, interest);
+    }
+
+    if (backend_ == Backend::Epoll) {
+        epoll_event ev{};
+        ev.events = epollEvents(interest);
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            Utils::log("Error: epoll_ctl(ADD) failed: " + std::string(strerror(errno)));
+            return false;
+        }
+    }
+
+    index_[fd] = entries_.size();
+    entries_.push_back(Entry{socket, fd, interest});
+    return true;
+}
+
+bool SocketSet::modify(ISocket *socket, uint32_t interest) {
+    auto it = index_.find(socket->getSocketFd());
+    if (it == index_.end()) {
+        return false;
+    }
+
+    if (backend_ == Backend::Epoll) {
+        epoll_event ev{};
+        ev.events = epollEvents(interest);
+        ev.data.fd = it->first;
+        if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, it->first, &ev) < 0) {
+            Utils::log("Error: epoll_ctl(MOD) failed: " + std::string(strerror(errno)));
+            return false;
+        }
+    }
+
+    entries_[it->second].interest = interest;
+    return true;
+}
+
+void SocketSet::remove(ISocket *socket) {
+    // Look up by object as well: the socket may already be closed
+    size_t slot = entries_.size();
+    auto it = index_.find(socket->getSocketFd());
+    if (it != index_.end() && entries_[it->second].socket == socket) {
+        slot = it->second;
+    } else {
+        for (size_t i = 0; i < entries_.size(); ++i) {
+            if (entries_[i].socket == socket) {
+                slot = i;
+                break;
+            }
+        }
+    }
+    if (slot == entries_.size()) {
+        return;
+    }
+
+    int fd = entries_[slot].fd;
+    if (backend_ == Backend::Epoll) {
+        // Fails harmlessly when the fd was closed first
+        epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    index_.erase(fd);
+    if (slot != entries_.size() - 1) {
+        entries_[slot] = entries_.back();
+        index_[entries_[slot].fd] = slot;
+    }
+    entries_.pop_back();
+}
+
+void SocketSet::clear() {
+    if (backend_ == Backend::Epoll) {
+        for (const Entry &entry : entries_) {
+            epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, entry.fd, nullptr);
+        }
+    }
+    entries_.clear();
+    index_.clear();
+    ready_.clear();
+}
+
+size_t SocketSet::size() const {
+    return entries_.size();
+}
+
+SocketSet::Backend SocketSet::getBackend() const {
+    return backend_;
+}
+
+int SocketSet::wait(std::chrono::microseconds timeout) {
+    if (timeout.count() < 0) {
+        return backend_ == Backend::Epoll ? waitEpoll(Clock::time_point(), true)
+                                          : waitPoll(Clock::time_point(), true);
+    }
+    return waitUntil(Clock::now() + timeout);
+}
+
+int SocketSet::waitUntil(Clock::time_point deadline) {
+    return backend_ == Backend::Epoll ? waitEpoll(deadline, false) : waitPoll(deadline, false);
+}
+
+const std::vector<SocketSet::Ready> &SocketSet::ready() const {
+    return ready_;
+}
+
+int SocketSet::waitPoll(Clock::time_point deadline, bool forever) {
+    ready_.clear();
+
+    // Buffered bytes are ready now: only collect what else is ready
+    bool buffered = false;
+    poll_fds_.resize(entries_.size());
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        poll_fds_[i].fd = entries_[i].fd;
+        poll_fds_[i].events = pollEvents(entries_[i].interest);
+        poll_fds_[i].revents = 0;
+        if ((entries_[i].interest & Read) && entries_[i].socket->getBufferedSize() > 0) {
+            buffered = true;
+        }
+    }
+    if (buffered) {
+        forever = false;
+        deadline = Clock::now();
+    }
+
+    int n;
+    while (true) {
+        timespec ts = remainingTime(deadline);
+        SyscallCounter::add();
+        n = ppoll(poll_fds_.data(), poll_fds_.size(), forever ? nullptr : &ts, nullptr);
+        if (n >= 0 || errno != EINTR) {
+            break;
+        }
+    }
+    if (n < 0) {
+        Utils::log("Error: ppoll() failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        uint32_t events = fromPoll(poll_fds_[i].revents);
+        if ((entries_[i].interest & Read) && entries_[i].socket->getBufferedSize() > 0) {
+            events |= Read;
+        }
+        if (events != 0) {
+            ready_.push_back(Ready{entries_[i].socket, events});
+        }
+    }
+    return static_cast<int>(ready_.size());
+}
+
+int SocketSet::waitEpoll(Clock::time_point deadline, bool forever) {
+    ready_.clear();
+
+    std::vector<size_t> buffered;
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        if ((entries_[i].interest & Read) && entries_[i].socket->getBufferedSize() > 0) {
+            buffered.push_back(i);
+        }
+    }
+    if (!buffered.empty()) {
+        forever = false;
+        deadline = Clock::now();
+    }
+
+    std::vector<epoll_event> events(entries_.empty() ? 1 : entries_.size());
+    int n;
+    while (true) {
+        timespec ts = remainingTime(deadline);
+        SyscallCounter::add();
+        n = epoll_pwait2(epoll_fd_, events.data(), static_cast<int>(events.size()), forever ? nullptr : &ts, nullptr);
+        if (n < 0 && errno == ENOSYS) {
+            // Kernels before 5.11: millisecond timeout, rounded up
+            long ms = forever ? -1 : static_cast<long>(ts.tv_sec * 1000 + (ts.tv_nsec + 999999) / 1000000);
+            SyscallCounter::add();
+            n = epoll_wait(epoll_fd_, events.data(), static_cast<int>(events.size()), static_cast<int>(ms));
+        }
+        if (n >= 0 || errno != EINTR) {
+            break;
+        }
+    }
+    if (n < 0) {
+        Utils::log("Error: epoll_pwait2() failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        auto it = index_.find(events[i].data.fd);
+        if (it == index_.end()) {
+            continue;
+        }
+        Entry &entry = entries_[it->second];
+        uint32_t ready = fromEpoll(events[i].events);
+        if (entry.socket->getBufferedSize() > 0 && (entry.interest & Read)) {
+            ready |= Read;
+        }
+        ready_.push_back(Ready{entry.socket, ready});
+    }
+    // Buffered sockets the kernel did not report
+    for (size_t slot : buffered) {
+        bool listed = false;
+        for (const Ready &r : ready_) {
+            if (r.socket == entries_[slot].socket) {
+                listed = true;
+                break;
+            }
+        }
+        if (!listed) {
+            ready_.push_back(Ready{entries_[slot].socket, Read});
+        }
+    }
+    return static_cast<int>(ready_.size());
+}
+
+int SocketSet::waitFd(int fd, uint32_t interest, std::chrono::microseconds timeout) {
+    pollfd pfd{};
+    pfd.fd = fd;
+    pfd.events = pollEvents(interest);
+    bool forever = timeout.count() < 0;
+    Clock::time_point deadline = Clock::now() + (forever ? std::chrono::microseconds(0) : timeout);
+
+    int n;
+    while (true) {
+        timespec ts = remainingTime(deadline);
+        SyscallCounter::add();
+        n = ppoll(&pfd, 1, forever ? nullptr : &ts, nullptr);
+        if (n >= 0 || errno != EINTR) {
+            break;
+        }
+    }
+    if (n < 0) {
+        Utils::log("Error: ppoll() failed: " + std::string(strerror(errno)));
+        return -1;
+    }
+    return n == 0 ? 0 : static_cast<int>(fromPoll(pfd.revents));
+}
@@ -0,0 +1,217 @@
+#include "../headers/network/SocketStats.h"
+
+#include <sstream>
+
+
+
+namespace {
+
+    void atomicMax(std::atomic<uint64_t> &target, uint64_t value) {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    void writeHistogram(std::ostringstream &out, const char *name, const StatsHistogram::Snapshot &h) {
+        out << "\"" << name << "\": {"
+            << "\"count\": " << h.count << ", "
+            << "\"mean\": " << h.mean() << ", "
+            << "\"p50\": " << h.percentile(0.50) << ", "
+            << "\"p90\": " << h.percentile(0.90) << ", "
+            << "\"p99\": " << h.percentile(0.99) << ", "
+            << "\"p999\": " << h.percentile(0.999) << ", "
+            << "\"max\": " << h.max << ", "
+            << "\"buckets\": [";
+        // Sparse [upper_bound, count] pairs, enough to merge histograms later
+        bool first = true;
+        for (size_t i = 0; i < h.buckets.size(); ++i) {
+            if (h.buckets[i] == 0) {
+                continue;
+            }
+            out << (first ? "" : ", ") << "[" << StatsHistogram::bucketUpperBound(i) << ", " << h.buckets[i] << "]";
+            first = false;
+        }
+        out << "]}";
+    }
+
+}
+
+StatsHistogram::StatsHistogram() {
+    reset();
+}
+
+size_t StatsHistogram::bucketIndex(uint64_t value) {
+    if (value < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<size_t>(value);
+    }
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= kMaxBits) {
+        return kBuckets - 1;
+    }
+    // Group g >= 1 covers [2^(g+3), 2^(g+4)); the sub-bucket is the four
+    // bits below the most significant one
+    size_t group = static_cast<size_t>(msb - kSubBucketBits + 1);
+    size_t sub = static_cast<size_t>((value >> (msb - kSubBucketBits)) & (kSubBuckets - 1));
+    return group * kSubBuckets + sub;
+}
+
+uint64_t StatsHistogram::bucketUpperBound(size_t index) {
+    size_t group = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    if (group == 0) {
+        return sub;
+    }
+    int msb = static_cast<int>(group) + kSubBucketBits - 1;
+    uint64_t width = 1ULL << (msb - kSubBucketBits);
+    return (1ULL << msb) + sub * width + width - 1;
+}
+
+void StatsHistogram::record(uint64_t value, uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    buckets_[bucketIndex(value)].fetch_add(count, std::memory_order_relaxed);
+    count_.fetch_add(count, std::memory_order_relaxed);
+    sum_.fetch_add(value * count, std::memory_order_relaxed);
+    atomicMax(max_, value);
+}
+
+StatsHistogram::Snapshot StatsHistogram::snapshot() const {
+    Snapshot snap{};
+    snap.buckets.resize(kBuckets);
+    for (int i = 0; i < kBuckets; ++i) {
+        snap.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    snap.count = count_.load(std::memory_order_relaxed);
+    snap.sum = sum_.load(std::memory_order_relaxed);
+    snap.max = max_.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void StatsHistogram::reset() {
+    for (auto &bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_.store(0, std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+double StatsHistogram::Snapshot::mean() const {
+    return count == 0 ? 0.0 : static_cast<double>(sum) / count;
+}
+
+uint64_t StatsHistogram::Snapshot::percentile(double fraction) const {
+    // Bucket counts may run ahead of count in a live snapshot; rank on the
+    // buckets themselves
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(fraction * (total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            // The last bucket is open-ended; max is the better answer there
+            uint64_t bound = bucketUpperBound(i);
+            return bound < max ? bound : max;
+        }
+    }
+    return max;
+}
+
+std::atomic<bool> SocketStats::global_enabled_{false};
+
+SocketStats::SocketStats() {
+    reset();
+}
+
+void SocketStats::record(bool send, uint64_t bytes, uint64_t messages, uint64_t latency_ns, uint64_t syscalls,
+                         uint64_t retries, bool failed) {
+    syscalls_.fetch_add(syscalls, std::memory_order_relaxed);
+    if (retries != 0) {
+        eagain_retries_.fetch_add(retries, std::memory_order_relaxed);
+    }
+    if (failed) {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (messages == 0) {
+        return;
+    }
+
+    if (send) {
+        bytes_sent_.fetch_add(bytes, std::memory_order_relaxed);
+        messages_sent_.fetch_add(messages, std::memory_order_relaxed);
+        send_latency_.record(latency_ns);
+        send_size_.record(bytes / messages, messages);
+    } else {
+        bytes_received_.fetch_add(bytes, std::memory_order_relaxed);
+        messages_received_.fetch_add(messages, std::memory_order_relaxed);
+        receive_latency_.record(latency_ns);
+        receive_size_.record(bytes / messages, messages);
+    }
+}
+
+SocketStats::Snapshot SocketStats::snapshot() const {
+    Snapshot snap{};
+    snap.counters.bytes_sent = bytes_sent_.load(std::memory_order_relaxed);
+    snap.counters.bytes_received = bytes_received_.load(std::memory_order_relaxed);
+    snap.counters.messages_sent = messages_sent_.load(std::memory_order_relaxed);
+    snap.counters.messages_received = messages_received_.load(std::memory_order_relaxed);
+    snap.counters.syscalls = syscalls_.load(std::memory_order_relaxed);
+    snap.counters.eagain_retries = eagain_retries_.load(std::memory_order_relaxed);
+    snap.counters.errors = errors_.load(std::memory_order_relaxed);
+    snap.send_latency_ns = send_latency_.snapshot();
+    snap.receive_latency_ns = receive_latency_.snapshot();
+    snap.send_size = send_size_.snapshot();
+    snap.receive_size = receive_size_.snapshot();
+    return snap;
+}
+
+void SocketStats::reset() {
+    bytes_sent_.store(0, std::memory_order_relaxed);
+    bytes_received_.store(0, std::memory_order_relaxed);
+    messages_sent_.store(0, std::memory_order_relaxed);
+    messages_received_.store(0, std::memory_order_relaxed);
+    syscalls_.store(0, std::memory_order_relaxed);
+    eagain_retries_.store(0, std::memory_order_relaxed);
+    errors_.store(0, std::memory_order_relaxed);
+    send_latency_.reset();
+    receive_latency_.reset();
+    send_size_.reset();
+    receive_size_.reset();
+}
+
+SocketStats &SocketStats::global() {
+    static SocketStats stats;
+    return stats;
+}
+
+void SocketStats::setGlobalEnabled(bool enable) {
+    global_enabled_.store(enable && NETWORK_SOCKET_STATS, std::memory_order_relaxed);
+}
+
+std::string SocketStats::Snapshot::toJson() const {
+    std::ostringstream out;
+    out << "{\"bytes_sent\": " << counters.bytes_sent << ", "
+        << "\"bytes_received\": " << counters.bytes_received << ", "
+        << "\"messages_sent\": " << counters.messages_sent << ", "
+        << "\"messages_received\": " << counters.messages_received << ", "
+        << "\"syscalls\": " << counters.syscalls << ", "
+        << "\"eagain_retries\": " << counters.eagain_retries << ", "
+        << "\"errors\": " << counters.errors << ", ";
+    writeHistogram(out, "send_latency_ns", send_latency_ns);
+    out << ", ";
+    writeHistogram(out, "receive_latency_ns", receive_latency_ns);
+    out << ", ";
+    writeHistogram(out, "send_size", send_size);
+    out << ", ";
+    writeHistogram(out, "receive_size", receive_size);
+    out << "}";
+    return out.str();
+}
@@ -0,0 +1,95 @@
+#include "../headers/network/SocketTuning.h"
+#include "../needed_files/Utils.h"
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <cerrno>
+#include <cstring>
+
+
+
+namespace {
+
+    struct Option {
+        int SocketTuning::*field;
+        int level;
+        int name;
+        const char *label;
+    };
+
+    // Buffers first, so they are in place whatever else fails. Then
+    // SO_KEEPALIVE ahead of the TCP_KEEP* values, which are harmless while
+    // it is off.
+    const Option kOptions[] = {
+        {&SocketTuning::send_buffer, SOL_SOCKET, SO_SNDBUF, "SO_SNDBUF"},
+        {&SocketTuning::receive_buffer, SOL_SOCKET, SO_RCVBUF, "SO_RCVBUF"},
+        {&SocketTuning::keepalive, SOL_SOCKET, SO_KEEPALIVE, "SO_KEEPALIVE"},
+        {&SocketTuning::keepalive_idle_s, IPPROTO_TCP, TCP_KEEPIDLE, "TCP_KEEPIDLE"},
+        {&SocketTuning::keepalive_interval_s, IPPROTO_TCP, TCP_KEEPINTVL, "TCP_KEEPINTVL"},
+        {&SocketTuning::keepalive_count, IPPROTO_TCP, TCP_KEEPCNT, "TCP_KEEPCNT"},
+        {&SocketTuning::no_delay, IPPROTO_TCP, TCP_NODELAY, "TCP_NODELAY"},
+        {&SocketTuning::cork, IPPROTO_TCP, TCP_CORK, "TCP_CORK"},
+        {&SocketTuning::quick_ack, IPPROTO_TCP, TCP_QUICKACK, "TCP_QUICKACK"},
+        {&SocketTuning::busy_poll_us, SOL_SOCKET, SO_BUSY_POLL, "SO_BUSY_POLL"},
+        {&SocketTuning::not_sent_lowat, IPPROTO_TCP, TCP_NOTSENT_LOWAT, "TCP_NOTSENT_LOWAT"},
+        {&SocketTuning::priority, SOL_SOCKET, SO_PRIORITY, "SO_PRIORITY"},
+    };
+
+}
+
+SocketTuning SocketTuning::lowLatency() {
+    SocketTuning tuning;
+    tuning.no_delay = 1;
+    tuning.cork = 0;
+    tuning.quick_ack = 1;
+    tuning.busy_poll_us = 50;
+    tuning.not_sent_lowat = 16 * 1024;
+    tuning.priority = 6;
+    tuning.keepalive = 1;
+    tuning.keepalive_idle_s = 10;
+    tuning.keepalive_interval_s = 5;
+    tuning.keepalive_count = 3;
+    return tuning;
+}
+
+SocketTuning SocketTuning::bulkThroughput() {
+    SocketTuning tuning;
+    tuning.no_delay = 0;
+    tuning.send_buffer = 4 * 1024 * 1024;
+    tuning.receive_buffer = 4 * 1024 * 1024;
+    tuning.priority = 0;
+    tuning.keepalive = 1;
+    tuning.keepalive_idle_s = 60;
+    tuning.keepalive_interval_s = 10;
+    tuning.keepalive_count = 6;
+    return tuning;
+}
+
+bool SocketTuning::apply(int fd) const {
+    bool ok = true;
+    for (const Option &option : kOptions) {
+        int value = this->*option.field;
+        if (value < 0) {
+            continue;
+        }
+        if (setsockopt(fd, option.level, option.name, &value, sizeof(value)) < 0) {
+            Utils::log("Error: setsockopt(" + std::string(option.label) + ") failed: " +
+                       std::string(strerror(errno)));
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+std::string SocketTuning::describe() const {
+    std::string result;
+    for (const Option &option : kOptions) {
+        int value = this->*option.field;
+        if (value < 0) {
+            continue;
+        }
+        result += (result.empty() ? "" : " ") + std::string(option.label) + "=" + std::to_string(value);
+    }
+    return result.empty() ? "defaults" : result;
+}
@@ -0,0 +1,15 @@
+#include "../headers/network/SyscallCounter.h"
+
+
+
+namespace {
+    thread_local uint64_t syscall_count = 0;
+}
+
+void SyscallCounter::add(uint64_t count) {
+    syscall_count += count;
+}
+
+uint64_t SyscallCounter::get() {
+    return syscall_count;
+}
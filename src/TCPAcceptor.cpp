@@ -0,0 +1,113 @@
+#include "../headers/network/TCPAcceptor.h"
+#include "../headers/network/IoContext.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../needed_files/Utils.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+
+
+TCPAcceptor::TCPAcceptor(int port, int backlog)
+    : port_(port), backlog_(backlog), listen_fd_(-1), io_context_(nullptr) {}
+
+TCPAcceptor::~TCPAcceptor() {
+    close();
+}
+
+void TCPAcceptor::setTuning(const SocketTuning& tuning) {
+    tuning_ = tuning;
+}
+
+bool TCPAcceptor::listen() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        Utils::log("Error: socket() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    int opt = 1;
+    if (setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0) {
+        Utils::log("Error: setsockopt(SO_REUSEADDR) failed: " + std::string(strerror(errno)));
+    }
+    // Failed options are logged; the listener works without them
+    tuning_.apply(listen_fd_);
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = INADDR_ANY;
+    address.sin_port = htons(port_);
+    socklen_t address_len = sizeof(address);
+
+    if (bind(listen_fd_, (sockaddr*)&address, sizeof(address)) < 0 || ::listen(listen_fd_, backlog_) < 0 ||
+        getsockname(listen_fd_, (sockaddr*)&address, &address_len) < 0) {
+        Utils::log("Error: listen on port " + std::to_string(port_) + " failed: " + std::string(strerror(errno)));
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+    port_ = ntohs(address.sin_port);
+    return true;
+}
+
+void TCPAcceptor::close() {
+    if (listen_fd_ != -1) {
+        int fd = listen_fd_;
+        listen_fd_ = -1;
+        if (io_context_ != nullptr) {
+            IoContext* io = io_context_;
+            io_context_ = nullptr;
+            io->forget(fd);
+        }
+        ::close(fd);
+    }
+}
+
+Task<std::unique_ptr<TCPSocket>> TCPAcceptor::asyncAccept(IoContext& io) {
+    if (listen_fd_ < 0) {
+        Utils::log("Error: acceptor is not listening.");
+        co_return nullptr;
+    }
+    if (io_context_ == nullptr) {
+        if (!io.watch(listen_fd_)) {
+            co_return nullptr;
+        }
+        io_context_ = &io;
+    }
+
+    while (true) {
+        sockaddr_in peer{};
+        socklen_t peer_len = sizeof(peer);
+        SyscallCounter::add();
+        int fd = accept4(listen_fd_, (sockaddr*)&peer, &peer_len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd >= 0) {
+            char address[INET_ADDRSTRLEN] = {};
+            inet_ntop(AF_INET, &peer.sin_addr, address, sizeof(address));
+            auto socket = std::make_unique<TCPSocket>(address, ntohs(peer.sin_port));
+            socket->adopt(fd);
+            co_return socket;
+        }
+        if (errno == EINTR || errno == ECONNABORTED) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: accept() failed: " + std::string(strerror(errno)));
+            co_return nullptr;
+        }
+        bool ready = co_await io.readable(listen_fd_);
+        if (!ready || listen_fd_ < 0) {
+            co_return nullptr;
+        }
+    }
+}
+
+int TCPAcceptor::getPort() const {
+    return port_;
+}
+
+int TCPAcceptor::getSocketFd() const {
+    return listen_fd_;
+}
@@ -1,21 +1,127 @@
 #include "../headers/network/TCPSocket.h"
+#include "../headers/network/BufferPool.h"
+#include "../headers/network/DelimiterSearch.h"
+#include "../headers/network/IoContext.h"
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SocketStats.h"
+#include "../headers/network/SyscallCounter.h"
 #include "../needed_files/Utils.h"
 
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <fcntl.h>
+#include <linux/errqueue.h>
+#include <netinet/in.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <thread>
 
 
+
+namespace {
+
+    bool setBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+            Utils::log("Error: fcntl(~O_NONBLOCK) failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        return true;
+    }
+
+    // sendfile() and splice() have no MSG_NOSIGNAL: block SIGPIPE on this
+    // thread for the call and swallow one it raised
+    class SigpipeGuard {
+    private:
+        sigset_t old_mask_;
+        bool was_pending_;
+
+    public:
+        SigpipeGuard() : was_pending_(false) {
+            sigset_t pipe_mask;
+            sigemptyset(&pipe_mask);
+            sigaddset(&pipe_mask, SIGPIPE);
+            sigset_t pending;
+            sigpending(&pending);
+            was_pending_ = sigismember(&pending, SIGPIPE) == 1;
+            pthread_sigmask(SIG_BLOCK, &pipe_mask, &old_mask_);
+        }
+
+        ~SigpipeGuard() {
+            sigset_t pending;
+            sigpending(&pending);
+            if (!was_pending_ && sigismember(&pending, SIGPIPE) == 1) {
+                sigset_t pipe_mask;
+                sigemptyset(&pipe_mask);
+                sigaddset(&pipe_mask, SIGPIPE);
+                timespec zero{};
+                while (sigtimedwait(&pipe_mask, nullptr, &zero) < 0 && errno == EINTR) {
+                }
+            }
+            pthread_sigmask(SIG_SETMASK, &old_mask_, nullptr);
+        }
+    };
+
+    bool waitWritable(int fd) {
+        return SocketSet::waitFd(fd, SocketSet::Write, std::chrono::microseconds(-1)) >= 0;
+    }
+
+    bool writeAll(int fd, const char* data, size_t size) {
+        size_t written = 0;
+        while (written < size) {
+            SyscallCounter::add();
+            ssize_t n = ::write(fd, data + written, size - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(fd)) {
+                    continue;
+                }
+                Utils::log("Error: write() failed: " + std::string(strerror(errno)));
+                return false;
+            }
+            written += n;
+        }
+        return true;
+    }
+
+}
+
 TCPSocket::TCPSocket(const std::string& address, int port)
-    : address_(address), port_(port), sockfd_(-1) {}
+    : address_(address), port_(port), sockfd_(-1), receive_timeout_ms_(0), connecting_(false),
+      io_context_(nullptr), relay_pipe_{-1, -1}, zerocopy_(false), zerocopy_threshold_(kZeroCopyThreshold), zerocopy_next_id_(0),
+      zerocopy_stats_{} {}
 
 TCPSocket::~TCPSocket() {
     close();
 }
 
 bool TCPSocket::open() {
-    sockfd_ = socket(AF_INET, SOCK_STREAM, 0);
+    return startConnect(false);
+}
+
+bool TCPSocket::open(int timeout_ms) {
+    return openAsync() && completeOpen(timeout_ms);
+}
+
+bool TCPSocket::openAsync() {
+    return startConnect(true);
+}
+
+bool TCPSocket::startConnect(bool non_blocking) {
+    sockfd_ = socket(AF_INET, SOCK_STREAM | (non_blocking ? SOCK_NONBLOCK : 0), 0);
     if (sockfd_ < 0) {
         Utils::log("Error: socket() failed: " + std::string(strerror(errno)));
         return false;
     }
+    // Failed options are logged; the connection works without them
+    tuning_.apply(sockfd_);
+    zerocopy_next_id_ = 0;
+    if (zerocopy_ && !applyZeroCopy()) {
+        zerocopy_ = false;
+    }
 
     sockaddr_in serv_addr{};
     serv_addr.sin_family = AF_INET;
@@ -28,60 +134,202 @@ bool TCPSocket::open() {
         return false;
     }
 
+    SyscallCounter::add();
     if (connect(sockfd_, (sockaddr*)&serv_addr, sizeof(serv_addr)) < 0) {
+        if (non_blocking && errno == EINPROGRESS) {
+            connecting_ = true;
+            return true;
+        }
         Utils::log("Error: connect() failed: " + std::string(strerror(errno)));
         ::close(sockfd_);
         sockfd_ = -1;
         return false;
     }
 
+    // Loopback connects can complete immediately
+    if (non_blocking && !setBlocking(sockfd_)) {
+        ::close(sockfd_);
+        sockfd_ = -1;
+        return false;
+    }
+
     Utils::log("TCP connection established to " + address_ + ":" + std::to_string(port_));
     return true;
 }
 
+bool TCPSocket::finishConnect(bool blocking) {
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &error, &len) < 0) {
+        error = errno;
+    }
+    connecting_ = false;
+
+    if (error != 0 || (blocking && !setBlocking(sockfd_))) {
+        if (error != 0) {
+            Utils::log("Error: connect() failed: " + std::string(strerror(error)));
+        }
+        detachContext(sockfd_);
+        ::close(sockfd_);
+        sockfd_ = -1;
+        errno = error;
+        return false;
+    }
+
+    Utils::log("TCP connection established to " + address_ + ":" + std::to_string(port_));
+    return true;
+}
+
+bool TCPSocket::completeOpen(int timeout_ms) {
+    if (!connecting_) {
+        return sockfd_ != -1;
+    }
+
+    int ready = SocketSet::waitFd(sockfd_, SocketSet::Write, std::chrono::milliseconds(timeout_ms));
+    if (ready > 0) {
+        return finishConnect();
+    }
+    if (ready == 0) {
+        Utils::log("Error: connect() to " + address_ + ":" + std::to_string(port_) + " timed out after " +
+                   std::to_string(timeout_ms) + " ms.");
+        errno = ETIMEDOUT;
+    }
+    int saved = errno;
+    ::close(sockfd_);
+    sockfd_ = -1;
+    connecting_ = false;
+    errno = saved;
+    return false;
+}
+
+bool TCPSocket::isOpening() const {
+    return connecting_;
+}
+
+size_t TCPSocket::openAll(const std::vector<TCPSocket*>& sockets, int timeout_ms) {
+    auto deadline = SocketSet::Clock::now() + std::chrono::milliseconds(timeout_ms);
+    SocketSet pending(SocketSet::Backend::Epoll);
+    size_t opened = 0;
+
+    // Every SYN goes out before waiting on any of them
+    for (TCPSocket* socket : sockets) {
+        if (!socket->openAsync()) {
+            continue;
+        }
+        if (!socket->connecting_) {
+            ++opened;
+        } else if (!pending.add(socket, SocketSet::Write)) {
+            socket->close();
+        }
+    }
+
+    while (pending.size() > 0) {
+        if (pending.waitUntil(deadline) <= 0) {
+            break;
+        }
+        std::vector<SocketSet::Ready> done = pending.ready();
+        for (const SocketSet::Ready& ready : done) {
+            TCPSocket* socket = static_cast<TCPSocket*>(ready.socket);
+            pending.remove(socket);
+            if (socket->finishConnect()) {
+                ++opened;
+            }
+        }
+    }
+
+    if (pending.size() > 0) {
+        Utils::log("Error: " + std::to_string(pending.size()) + " connections timed out after " +
+                   std::to_string(timeout_ms) + " ms.");
+        pending.clear();
+        for (TCPSocket* socket : sockets) {
+            if (socket->connecting_) {
+                ::close(socket->sockfd_);
+                socket->sockfd_ = -1;
+                socket->connecting_ = false;
+            }
+        }
+    }
+    return opened;
+}
+
 void TCPSocket::close() {
     if (sockfd_ != -1) {
-        ::close(sockfd_);
+        if (uring_ && uring_->hasPending()) {
+            uring_->flush(sockfd_);
+        }
+        // Completions stop with the fd. The kernel holds its own page
+        // references, so releasing early only risks the owner reusing
+        // memory that is still being sent.
+        if (!zerocopy_pending_.empty() && !waitZeroCopy(kZeroCopyLingerMs)) {
+            Utils::log("Error: " + std::to_string(zerocopy_pending_.size()) +
+                       " zero-copy sends still in flight at close.");
+        }
+        zerocopy_pending_.clear();
+        // The socket reads as closed before coroutines waiting on it resume
+        int fd = sockfd_;
         sockfd_ = -1;
+        connecting_ = false;
+        read_buffer_.clear();
+        closeRelayPipe();
+        detachContext(fd);
+        ::close(fd);
         Utils::log("TCP socket closed.");
     }
 }
 
 bool TCPSocket::send(const std::string& data) {
+    return send(data.data(), data.size());
+}
+
+bool TCPSocket::send(const char* data, size_t size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
         return false;
     }
 
-    if (data.empty()) {
+    if (size == 0) {
         return true; // Nothing to send
     }
 
+    SocketOp op(stats_.get(), SocketOp::Send);
+
+    if (uring_) {
+        if (!uring_->queueSend(sockfd_, data, size)) {
+            op.fail();
+            return false;
+        }
+        op.complete(size);
+        return true;
+    }
+
     size_t total_sent = 0;
-    const char* buffer = data.c_str();
-    size_t data_size = data.size();
 
-    while (total_sent < data_size) {
-        ssize_t sent = ::send(sockfd_, buffer + total_sent, 
-                            data_size - total_sent, MSG_NOSIGNAL);
+    while (total_sent < size) {
+        SyscallCounter::add();
+        ssize_t sent = ::send(sockfd_, data + total_sent, 
+                            size - total_sent, MSG_NOSIGNAL);
         
         if (sent < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 // Socket buffer full, try again
+                op.retry();
                 continue;
             }
             Utils::log("Error: send() failed: " + std::string(strerror(errno)));
+            op.fail();
             return false;
         }
         
         if (sent == 0) {
             Utils::log("Error: Connection closed by peer during send.");
+            op.fail();
             return false;
         }
         
         total_sent += sent;
     }
 
+    op.complete(size);
     return true;
 }
 
@@ -90,110 +338,928 @@ std::string TCPSocket::receive() {
 }
 
 bool TCPSocket::isConnected() const {
-    return sockfd_ != -1;
+    return sockfd_ != -1 && !connecting_;
+}
+
+size_t TCPSocket::getBufferedSize() const {
+    return read_buffer_.size();
+}
+
+ssize_t TCPSocket::receive(PooledBuffer& block) {
+    block = BufferPool::local().acquire();
+    if (!block) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = receive(block.data(), block.capacity());
+    if (n <= 0) {
+        block.reset();
+    }
+    return n;
 }
 
 std::string TCPSocket::receive(size_t max_size) {
+    // Receive into a pooled block so only the bytes that arrived are copied
+    BufferPool& pool = BufferPool::local();
+    if (max_size <= pool.getBlockSize()) {
+        PooledBuffer block = pool.acquire();
+        if (block) {
+            ssize_t n = receive(block.data(), max_size);
+            return n > 0 ? std::string(block.data(), n) : std::string();
+        }
+    }
+
+    std::string result(max_size, '\0');
+    ssize_t n = receive(&result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return result;
+}
+
+ssize_t TCPSocket::receive(char* buffer, size_t size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
-        return "";
+        errno = EBADF;
+        return -1;
     }
 
-    char* buffer = new char[max_size];
-    
-    ssize_t n = ::recv(sockfd_, buffer, max_size, 0);
+    if (!read_buffer_.empty()) {
+        return read_buffer_.read(buffer, size);
+    }
+
+    return readSocket(buffer, size);
+}
+
+ssize_t TCPSocket::readSocket(char* buffer, size_t size) {
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    ssize_t n;
+    if (uring_) {
+        n = uring_->receive(sockfd_, buffer, size, receive_timeout_ms_);
+    } else {
+        SyscallCounter::add();
+        n = ::recv(sockfd_, buffer, size, 0);
+    }
     
     if (n < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             // No data available right now
-            delete[] buffer;
-            return "";
+            op.retry();
+            return -1;
         }
         Utils::log("Error: recv() failed: " + std::string(strerror(errno)));
-        delete[] buffer;
-        return "";
+        op.fail();
+        return -1;
     }
     
     if (n == 0) {
         Utils::log("Connection closed by peer.");
-        delete[] buffer;
-        return "";
+    } else {
+        op.complete(n);
     }
 
-    std::string result(buffer, n);
-    delete[] buffer;
-    return result;
+    return n;
+}
+
+bool TCPSocket::sendv(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    if (uring_) {
+        // Queued pieces are coalesced into a single WRITE_FIXED
+        for (int i = 0; i < count; ++i) {
+            if (!uring_->queueSend(sockfd_, static_cast<const char*>(iov[i].iov_base), iov[i].iov_len)) {
+                op.fail();
+                return false;
+            }
+        }
+        op.complete(total);
+        return true;
+    }
+
+    // Send from a window over the caller's array; after a partial write the
+    // first entry of the next window starts inside the buffer it stopped in
+    const int kWindow = 64;
+    iovec window[kWindow];
+    int index = 0;
+    size_t offset = 0;
+
+    while (index < count) {
+        if (iov[index].iov_len == offset) {
+            ++index;
+            offset = 0;
+            continue;
+        }
+
+        int n = std::min(count - index, kWindow);
+        std::copy(iov + index, iov + index + n, window);
+        window[0].iov_base = static_cast<char*>(window[0].iov_base) + offset;
+        window[0].iov_len -= offset;
+
+        msghdr msg{};
+        msg.msg_iov = window;
+        msg.msg_iovlen = n;
+        SyscallCounter::add();
+        ssize_t sent = ::sendmsg(sockfd_, &msg, MSG_NOSIGNAL);
+
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket buffer full, try again
+                op.retry();
+                continue;
+            }
+            Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return false;
+        }
+
+        // Advance past everything the kernel took
+        size_t remaining = static_cast<size_t>(sent);
+        while (index < count && remaining >= iov[index].iov_len - offset) {
+            remaining -= iov[index].iov_len - offset;
+            ++index;
+            offset = 0;
+        }
+        offset += remaining;
+    }
+
+    op.complete(total);
+    return true;
+}
+
+ssize_t TCPSocket::receivev(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    if (!read_buffer_.empty()) {
+        ssize_t total = 0;
+        for (int i = 0; i < count && !read_buffer_.empty(); ++i) {
+            total += read_buffer_.read(static_cast<char*>(iov[i].iov_base), iov[i].iov_len);
+        }
+        return total;
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, 0);
+
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+        } else {
+            op.retry();
+        }
+        return -1;
+    }
+
+    if (n == 0) {
+        Utils::log("Connection closed by peer.");
+    } else {
+        op.complete(n);
+    }
+
+    return n;
 }
 
 std::string TCPSocket::receiveWithTimeout(int timeout_seconds, size_t max_size) {
+    return receiveWithTimeout(std::chrono::seconds(timeout_seconds), max_size);
+}
+
+std::string TCPSocket::receiveWithTimeout(std::chrono::microseconds timeout, size_t max_size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
         return "";
     }
 
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(sockfd_, &read_fds);
+    if (!read_buffer_.empty()) {
+        return receive(max_size);
+    }
 
-    struct timeval timeout;
-    timeout.tv_sec = timeout_seconds;
-    timeout.tv_usec = 0;
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return "";
+    }
 
-    int activity = select(sockfd_ + 1, &read_fds, nullptr, nullptr, &timeout);
-    
-    if (activity < 0) {
-        Utils::log("Error: select() failed: " + std::string(strerror(errno)));
+    int ready = SocketSet::waitFd(sockfd_, SocketSet::Read, timeout);
+    if (ready < 0) {
         return "";
     }
     
-    if (activity == 0) {
+    if (ready == 0) {
         Utils::log("Receive timeout.");
         return "";
     }
 
-    if (FD_ISSET(sockfd_, &read_fds)) {
-        return receive(max_size);
+    return receive(max_size);
+}
+
+std::string TCPSocket::receiveUntil(const std::string& delimiter, size_t max_size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return "";
+    }
+
+    if (delimiter.empty()) {
+        Utils::log("Error: empty delimiter.");
+        return "";
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return "";
+    }
+
+    const size_t kReadChunk = 16384;
+    size_t scanned = 0;
+
+    while (true) {
+        // Only bytes not scanned yet are searched, plus the delimiter's
+        // length - 1 bytes before them in case a match straddles two reads
+        size_t pos = DelimiterSearch::find(read_buffer_.data() + scanned, read_buffer_.size() - scanned,
+                                           delimiter.data(), delimiter.size());
+        if (pos != DelimiterSearch::npos) {
+            // Return data up to and including delimiter; the rest stays buffered
+            return read_buffer_.take(scanned + pos + delimiter.size());
+        }
+        if (read_buffer_.size() >= delimiter.size()) {
+            scanned = read_buffer_.size() - delimiter.size() + 1;
+        }
+
+        if (read_buffer_.size() >= max_size) {
+            return read_buffer_.take(max_size);
+        }
+
+        // Fill all the space the buffer already has, not just one chunk
+        char* space = read_buffer_.prepare(kReadChunk);
+        ssize_t n = readSocket(space, read_buffer_.writable());
+
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Keep the partial message for the next call
+                Utils::log("Receive timeout.");
+                return "";
+            }
+            break;
+        }
+
+        if (n == 0) {
+            break;
+        }
+
+        read_buffer_.commit(n);
     }
 
-    return "";
+    // Connection closed or failed: hand out whatever arrived
+    return read_buffer_.take(read_buffer_.size());
 }
 
-std::string TCPSocket::receiveUntil(const std::string& delimiter, size_t max_size) {
+bool TCPSocket::receiveExact(char* buffer, size_t size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    size_t received = read_buffer_.read(buffer, size);
+
+    while (received < size) {
+        ssize_t n = readSocket(buffer + received, size - received);
+
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // The read buffer is empty here, so this keeps the byte order
+            std::memcpy(read_buffer_.prepare(received), buffer, received);
+            read_buffer_.commit(received);
+            Utils::log("Receive timeout.");
+            return false;
+        }
+
+        if (n <= 0) {
+            return false;
+        }
+
+        received += n;
+    }
+
+    return true;
+}
+
+std::string TCPSocket::receiveExact(size_t size) {
+    std::string result(size, '\0');
+    if (!receiveExact(&result[0], size)) {
         return "";
     }
+    return result;
+}
+
+bool TCPSocket::adopt(int fd) {
+    close();
+    sockfd_ = fd;
+    connecting_ = false;
+    return sockfd_ >= 0;
+}
+
+bool TCPSocket::attachContext(IoContext& io) {
+    if (io_context_ == &io) {
+        return true;
+    }
+    if (io_context_ != nullptr) {
+        Utils::log("Error: socket is driven by another IoContext.");
+        return false;
+    }
+    if (uring_) {
+        setIoEngine(IoEngine::Syscall);
+    }
+    // Registration also makes the fd non-blocking
+    if (!io.watch(sockfd_)) {
+        return false;
+    }
+    io_context_ = &io;
+    return true;
+}
+
+void TCPSocket::detachContext(int fd) {
+    if (io_context_ != nullptr) {
+        IoContext* io = io_context_;
+        io_context_ = nullptr;
+        io->forget(fd);
+    }
+}
+
+Task<bool> TCPSocket::asyncOpen(IoContext& io) {
+    if (sockfd_ >= 0 && !connecting_) {
+        co_return attachContext(io);
+    }
+    if (sockfd_ < 0 && !startConnect(true)) {
+        co_return false;
+    }
+    if (!attachContext(io)) {
+        close();
+        co_return false;
+    }
+    if (connecting_) {
+        bool ready = co_await io.writable(sockfd_);
+        if (!ready) {
+            co_return false;
+        }
+        co_return finishConnect(false);
+    }
+    co_return true;
+}
+
+ssize_t TCPSocket::writeSocket(const char* data, size_t size) {
+    SocketOp op(stats_.get(), SocketOp::Send);
+    while (true) {
+        SyscallCounter::add();
+        ssize_t sent = ::send(sockfd_, data, size, MSG_NOSIGNAL);
+        if (sent >= 0) {
+            op.complete(sent);
+            return sent;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            op.retry();
+        } else {
+            Utils::log("Error: send() failed: " + std::string(strerror(errno)));
+            op.fail();
+        }
+        return -1;
+    }
+}
+
+Task<bool> TCPSocket::asyncSend(IoContext& io, const char* data, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        co_return false;
+    }
+    if (!attachContext(io)) {
+        co_return false;
+    }
+
+    size_t total_sent = 0;
+    while (total_sent < size) {
+        ssize_t sent = writeSocket(data + total_sent, size - total_sent);
+        if (sent > 0) {
+            total_sent += sent;
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // The socket may be closed while this waits
+            bool ready = co_await io.writable(sockfd_);
+            if (!ready || sockfd_ < 0) {
+                co_return false;
+            }
+            continue;
+        }
+        co_return false;
+    }
+    co_return true;
+}
+
+Task<bool> TCPSocket::asyncSend(IoContext& io, std::string data) {
+    co_return co_await asyncSend(io, data.data(), data.size());
+}
+
+Task<ssize_t> TCPSocket::asyncReceive(IoContext& io, char* buffer, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        co_return -1;
+    }
+    if (!read_buffer_.empty()) {
+        co_return static_cast<ssize_t>(read_buffer_.read(buffer, size));
+    }
+    if (!attachContext(io)) {
+        co_return -1;
+    }
+
+    while (true) {
+        ssize_t n = readSocket(buffer, size);
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            co_return n;
+        }
+        bool ready = co_await io.readable(sockfd_);
+        if (!ready || sockfd_ < 0) {
+            errno = ECANCELED;
+            co_return -1;
+        }
+    }
+}
+
+Task<std::string> TCPSocket::asyncReceive(IoContext& io, size_t max_size) {
+    std::string result(max_size, '\0');
+    ssize_t n = co_await asyncReceive(io, &result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    co_return result;
+}
+
+Task<std::string> TCPSocket::asyncReceiveUntil(IoContext& io, std::string delimiter, size_t max_size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        co_return "";
+    }
+    if (delimiter.empty()) {
+        Utils::log("Error: empty delimiter.");
+        co_return "";
+    }
+    if (!attachContext(io)) {
+        co_return "";
+    }
+
+    const size_t kReadChunk = 16384;
+    size_t scanned = 0;
+
+    // Same scan as receiveUntil(), waiting for readiness instead of blocking
+    while (true) {
+        size_t pos = DelimiterSearch::find(read_buffer_.data() + scanned, read_buffer_.size() - scanned,
+                                           delimiter.data(), delimiter.size());
+        if (pos != DelimiterSearch::npos) {
+            co_return read_buffer_.take(scanned + pos + delimiter.size());
+        }
+        if (read_buffer_.size() >= delimiter.size()) {
+            scanned = read_buffer_.size() - delimiter.size() + 1;
+        }
+
+        if (read_buffer_.size() >= max_size) {
+            co_return read_buffer_.take(max_size);
+        }
+
+        char* space = read_buffer_.prepare(kReadChunk);
+        ssize_t n = readSocket(space, read_buffer_.writable());
 
-    std::string result;
-    char buffer[1024];
-    
-    while (result.size() < max_size) {
-        ssize_t n = ::recv(sockfd_, buffer, sizeof(buffer), 0);
-        
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                bool ready = co_await io.readable(sockfd_);
+                if (!ready || sockfd_ < 0) {
+                    co_return "";
+                }
                 continue;
             }
-            Utils::log("Error: recv() failed: " + std::string(strerror(errno)));
             break;
         }
-        
+
         if (n == 0) {
+            break;
+        }
+
+        read_buffer_.commit(n);
+    }
+
+    co_return read_buffer_.take(read_buffer_.size());
+}
+
+bool TCPSocket::sendFile(int file_fd, off_t offset, size_t length) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    if (length == 0) {
+        return true;
+    }
+
+    // Queued io_uring sends must reach the wire before the file
+    if (uring_ && !flush()) {
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    SigpipeGuard guard;
+    size_t total_sent = 0;
+
+    while (total_sent < length) {
+        SyscallCounter::add();
+        ssize_t sent = ::sendfile(sockfd_, file_fd, &offset, length - total_sent);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(sockfd_)) {
+                // Socket buffer full
+                op.retry();
+                continue;
+            }
+            Utils::log("Error: sendfile() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return false;
+        }
+
+        if (sent == 0) {
+            Utils::log("Error: file ended after " + std::to_string(total_sent) + " of " +
+                       std::to_string(length) + " bytes.");
+            op.fail();
+            return false;
+        }
+
+        total_sent += sent;
+    }
+
+    op.complete(length);
+    return true;
+}
+
+ssize_t TCPSocket::spliceTo(int out_fd, size_t length) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    SigpipeGuard guard;
+    size_t moved = 0;
+
+    // Bytes a receiveUntil() read past go first, as a plain write
+    if (!read_buffer_.empty() && length > 0) {
+        size_t n = std::min(length, read_buffer_.size());
+        if (!writeAll(out_fd, read_buffer_.data(), n)) {
+            op.fail();
+            return -1;
+        }
+        read_buffer_.consume(n);
+        moved += n;
+    }
+
+    // A pipe can take the data directly; anything else goes through ours
+    struct stat out_stat{};
+    bool out_is_pipe = fstat(out_fd, &out_stat) == 0 && S_ISFIFO(out_stat.st_mode);
+    if (!out_is_pipe && relay_pipe_[0] < 0) {
+        SyscallCounter::add();
+        if (pipe2(relay_pipe_, O_CLOEXEC) < 0) {
+            Utils::log("Error: pipe2() failed: " + std::string(strerror(errno)));
+            relay_pipe_[0] = relay_pipe_[1] = -1;
+            op.fail();
+            return -1;
+        }
+    }
+    int target = out_is_pipe ? out_fd : relay_pipe_[1];
+
+    while (moved < length) {
+        SyscallCounter::add();
+        ssize_t in = ::splice(sockfd_, nullptr, target, nullptr, length - moved, SPLICE_F_MOVE);
+
+        if (in < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Receive timeout: report what did arrive
+                op.retry();
+                if (moved == 0) {
+                    return -1;
+                }
+                break;
+            }
+            Utils::log("Error: splice() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return -1;
+        }
+
+        if (in == 0) {
             Utils::log("Connection closed by peer.");
             break;
         }
-        
-        result.append(buffer, n);
-        
-        // Check if delimiter is found
-        size_t pos = result.find(delimiter);
-        if (pos != std::string::npos) {
-            // Return data up to and including delimiter
-            return result.substr(0, pos + delimiter.length());
+
+        if (!out_is_pipe && !drainRelayPipe(out_fd, static_cast<size_t>(in), moved + in < length)) {
+            // Whatever is still in the pipe would leak into the next call
+            closeRelayPipe();
+            op.fail();
+            return -1;
         }
+        moved += in;
+    }
+
+    if (moved > 0) {
+        op.complete(moved);
+    }
+    return static_cast<ssize_t>(moved);
+}
+
+ssize_t TCPSocket::spliceTo(TCPSocket& destination, size_t length) {
+    if (destination.uring_ && !destination.flush()) {
+        return -1;
+    }
+    return spliceTo(destination.sockfd_, length);
+}
+
+bool TCPSocket::drainRelayPipe(int out_fd, size_t size, bool more) {
+    // SPLICE_F_MORE holds back a partial segment while more is coming
+    unsigned int flags = SPLICE_F_MOVE | (more ? SPLICE_F_MORE : 0);
+    while (size > 0) {
+        SyscallCounter::add();
+        ssize_t out = ::splice(relay_pipe_[0], nullptr, out_fd, nullptr, size, flags);
+        if (out < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(out_fd)) {
+                continue;
+            }
+            Utils::log("Error: splice() failed: " + std::string(strerror(errno)));
+            return false;
+        }
+        if (out == 0) {
+            Utils::log("Error: splice() made no progress.");
+            return false;
+        }
+        size -= out;
+    }
+    return true;
+}
+
+void TCPSocket::closeRelayPipe() {
+    if (relay_pipe_[0] >= 0) {
+        ::close(relay_pipe_[0]);
+        ::close(relay_pipe_[1]);
+        relay_pipe_[0] = relay_pipe_[1] = -1;
     }
-    
-    return result;
+}
+
+bool TCPSocket::setZeroCopy(bool enable, size_t threshold) {
+    zerocopy_threshold_ = threshold;
+    if (!enable) {
+        // Buffers already sent stay pending until reaped
+        zerocopy_ = false;
+        return true;
+    }
+    if (sockfd_ >= 0 && !applyZeroCopy()) {
+        return false;
+    }
+    zerocopy_ = true;
+    return true;
+}
+
+bool TCPSocket::applyZeroCopy() {
+    int opt = 1;
+    if (setsockopt(sockfd_, SOL_SOCKET, SO_ZEROCOPY, &opt, sizeof(opt)) < 0) {
+        Utils::log("Error: setsockopt(SO_ZEROCOPY) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool TCPSocket::isZeroCopyEnabled() const {
+    return zerocopy_;
+}
+
+bool TCPSocket::sendZeroCopy(const char* data, size_t size, std::shared_ptr<const void> owner) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    if (!zerocopy_ || size < zerocopy_threshold_) {
+        ++zerocopy_stats_.copied_sends;
+        return send(data, size);
+    }
+
+    // Queued io_uring sends must reach the wire first
+    if (uring_ && !flush()) {
+        return false;
+    }
+    reapZeroCopy();
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    ZeroCopyBuffer pending{zerocopy_next_id_, 0, 0, std::move(owner)};
+    int flags = MSG_NOSIGNAL | MSG_ZEROCOPY;
+    size_t total_sent = 0;
+    bool ok = true;
+
+    while (total_sent < size) {
+        SyscallCounter::add();
+        ssize_t sent = ::send(sockfd_, data + total_sent, size - total_sent, flags);
+
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == ENOBUFS && (flags & MSG_ZEROCOPY)) {
+                // Pinned pages are charged to optmem_max: copy the rest
+                flags = MSG_NOSIGNAL;
+                continue;
+            }
+            if ((errno == EAGAIN || errno == EWOULDBLOCK) && waitWritable(sockfd_)) {
+                op.retry();
+                continue;
+            }
+            Utils::log("Error: send() failed: " + std::string(strerror(errno)));
+            op.fail();
+            ok = false;
+            break;
+        }
+
+        // Every successful MSG_ZEROCOPY call takes the next notification id
+        if (flags & MSG_ZEROCOPY) {
+            ++zerocopy_next_id_;
+            ++pending.calls;
+        }
+        total_sent += sent;
+    }
+
+    if (pending.calls > 0) {
+        pending.outstanding = pending.calls;
+        zerocopy_pending_.push_back(std::move(pending));
+        ++zerocopy_stats_.zerocopy_sends;
+    } else {
+        ++zerocopy_stats_.copied_sends;
+    }
+    if (ok) {
+        op.complete(size);
+    }
+    return ok;
+}
+
+bool TCPSocket::sendZeroCopy(std::shared_ptr<const std::string> data) {
+    const char* bytes = data->data();
+    size_t size = data->size();
+    return sendZeroCopy(bytes, size, std::move(data));
+}
+
+bool TCPSocket::sendZeroCopy(const PooledBuffer& block, size_t size) {
+    return sendZeroCopy(block.data(), size, std::make_shared<PooledBuffer>(block));
+}
+
+size_t TCPSocket::reapZeroCopy() {
+    if (sockfd_ < 0 || zerocopy_pending_.empty()) {
+        return 0;
+    }
+
+    while (true) {
+        char control[128];
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        SyscallCounter::add();
+        if (recvmsg(sockfd_, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Utils::log("Error: recvmsg(MSG_ERRQUEUE) failed: " + std::string(strerror(errno)));
+            }
+            break;
+        }
+
+        for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            bool recverr = (cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                           (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR);
+            if (!recverr) {
+                continue;
+            }
+            sock_extended_err err;
+            memcpy(&err, CMSG_DATA(cmsg), sizeof(err));
+            if (err.ee_errno != 0 || err.ee_origin != SO_EE_ORIGIN_ZEROCOPY) {
+                continue;
+            }
+            // One notification covers the id range [ee_info, ee_data]
+            uint32_t count = err.ee_data - err.ee_info + 1;
+            zerocopy_stats_.completions += count;
+            if (err.ee_code & SO_EE_CODE_ZEROCOPY_COPIED) {
+                zerocopy_stats_.deferred_copies += count;
+            }
+            completeZeroCopy(err.ee_info, err.ee_data);
+        }
+    }
+
+    // Payloads are released in send order
+    size_t released = 0;
+    while (!zerocopy_pending_.empty() && zerocopy_pending_.front().outstanding == 0) {
+        zerocopy_pending_.pop_front();
+        ++released;
+    }
+    return released;
+}
+
+void TCPSocket::completeZeroCopy(uint32_t first, uint32_t last) {
+    // Ids are 32-bit and wrap: compare distances, not values
+    uint32_t span = last - first;
+    for (ZeroCopyBuffer& pending : zerocopy_pending_) {
+        for (uint32_t i = 0; i < pending.calls; ++i) {
+            if (static_cast<uint32_t>(pending.first_id + i - first) <= span) {
+                --pending.outstanding;
+            }
+        }
+    }
+}
+
+bool TCPSocket::waitZeroCopy(int timeout_ms) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    bool woken = false;
+    while (true) {
+        uint64_t completions = zerocopy_stats_.completions;
+        reapZeroCopy();
+        if (zerocopy_pending_.empty()) {
+            return true;
+        }
+
+        // Woken without a completion: a real socket error (say ECONNRESET)
+        // also raises POLLERR and would keep waking us until the deadline
+        if (woken && zerocopy_stats_.completions == completions) {
+            int error = 0;
+            socklen_t len = sizeof(error);
+            SyscallCounter::add();
+            if (getsockopt(sockfd_, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error != 0) {
+                errno = error;
+                Utils::log("Error: waitZeroCopy() failed: " + std::string(strerror(errno)));
+                return false;
+            }
+            // Hung up: completions still come, but POLLHUP stays raised
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        // The error queue signals POLLERR whatever the interest mask
+        if (left.count() <= 0 || SocketSet::waitFd(sockfd_, 0, left) <= 0) {
+            reapZeroCopy();
+            return zerocopy_pending_.empty();
+        }
+        woken = true;
+    }
+}
+
+size_t TCPSocket::getZeroCopyPending() const {
+    return zerocopy_pending_.size();
+}
+
+TCPSocket::ZeroCopyStats TCPSocket::getZeroCopyStats() const {
+    return zerocopy_stats_;
+}
+
+bool TCPSocket::setStatsEnabled(bool enable) {
+#if NETWORK_SOCKET_STATS
+    if (!enable) {
+        stats_.reset();
+    } else if (!stats_) {
+        stats_ = std::make_unique<SocketStats>();
+    }
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+const SocketStats* TCPSocket::getStats() const {
+    return stats_.get();
 }
 
 int TCPSocket::getSocketFd() const {
@@ -223,7 +1289,12 @@ bool TCPSocket::setReceiveTimeout(int seconds) {
     struct timeval timeout;
     timeout.tv_sec = seconds;
     timeout.tv_usec = 0;
-    return setSocketOption(SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (!setSocketOption(SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))) {
+        return false;
+    }
+    // The io_uring path does not honour SO_RCVTIMEO, so keep it for a linked timeout
+    receive_timeout_ms_ = seconds * 1000;
+    return true;
 }
 
 bool TCPSocket::setSendTimeout(int seconds) {
@@ -233,6 +1304,56 @@ bool TCPSocket::setSendTimeout(int seconds) {
     return setSocketOption(SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 }
 
+bool TCPSocket::setTuning(const SocketTuning& tuning) {
+    tuning_ = tuning;
+    return sockfd_ < 0 || tuning_.apply(sockfd_);
+}
+
+const SocketTuning& TCPSocket::getTuning() const {
+    return tuning_;
+}
+
+bool TCPSocket::setIoEngine(IoEngine engine) {
+    if (engine == IoEngine::Syscall) {
+        if (uring_ && uring_->hasPending()) {
+            flush();
+        }
+        uring_.reset();
+        return true;
+    }
+
+    if (uring_) {
+        return true;
+    }
+
+    auto channel = std::make_unique<IoUringChannel>();
+    if (!channel->init()) {
+        Utils::log("io_uring unavailable, falling back to syscall I/O.");
+        return false;
+    }
+    uring_ = std::move(channel);
+    return true;
+}
+
+IoEngine TCPSocket::getIoEngine() const {
+    return uring_ ? IoEngine::IoUring : IoEngine::Syscall;
+}
+
+bool TCPSocket::flush() {
+    if (!uring_ || !uring_->hasPending()) {
+        return true;
+    }
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    if (!uring_->flush(sockfd_)) {
+        Utils::log("Error: send() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
 std::string TCPSocket::getAddress() const {
     return address_;
 }
@@ -1,9 +1,25 @@
 #include "../headers/network/UDPSocket.h"
+#include "../headers/network/BufferPool.h"
+#include "../headers/network/DelimiterSearch.h"
+#include "../headers/network/IoContext.h"
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SocketStats.h"
+#include "../headers/network/SyscallCounter.h"
 #include "../needed_files/Utils.h"
 
+#include <netinet/udp.h>
+#include <algorithm>
+
+namespace {
+    // Linux accepts at most 64 segments and one IP datagram of payload per GSO send
+    const size_t kGsoMaxSegments = 64;
+    const size_t kMaxUdpPayload = 65507;
+}
+
 
 UDPSocket::UDPSocket(const std::string& address, int port)
-    : address_(address), port_(port), sockfd_(-1) {}
+    : address_(address), port_(port), sockfd_(-1), receive_timeout_ms_(0),
+      gso_supported_(true), gro_enabled_(false), io_context_(nullptr) {}
 
 UDPSocket::~UDPSocket() {
     close();
@@ -35,42 +51,66 @@ bool UDPSocket::open() {
 
 void UDPSocket::close() {
     if (sockfd_ != -1) {
-        ::close(sockfd_);
+        if (uring_ && uring_->hasPending()) {
+            uring_->flush(sockfd_);
+        }
+        // The socket reads as closed before coroutines waiting on it resume
+        int fd = sockfd_;
         sockfd_ = -1;
+        read_buffer_.clear();
+        detachContext(fd);
+        ::close(fd);
         Utils::log("UDP socket closed.");
     }
 }
 
 bool UDPSocket::send(const std::string& data) {
+    return send(data.data(), data.size());
+}
+
+bool UDPSocket::send(const char* data, size_t size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
         return false;
     }
 
-    if (data.empty()) {
+    if (size == 0) {
         return true; // Nothing to send
     }
 
+    SocketOp op(stats_.get(), SocketOp::Send);
+
+    if (uring_) {
+        if (!uring_->queueSendTo(sockfd_, data, size, server_addr_)) {
+            op.fail();
+            return false;
+        }
+        op.complete(size);
+        return true;
+    }
+
     size_t total_sent = 0;
-    const char* buffer = data.c_str();
-    size_t data_size = data.size();
 
-    while (total_sent < data_size) {
-        ssize_t sent = ::sendto(sockfd_, buffer + total_sent, data_size - total_sent, MSG_NOSIGNAL,
+    while (total_sent < size) {
+        SyscallCounter::add();
+        ssize_t sent = ::sendto(sockfd_, data + total_sent, size - total_sent, MSG_NOSIGNAL,
                                 (sockaddr*)&server_addr_, sizeof(server_addr_));
         
         if (sent < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 // Socket buffer full, try again
+                op.retry();
                 continue;
             }
             Utils::log("Error: sendto() failed: " + std::string(strerror(errno)));
+            op.fail();
             return false;
         }
         
         total_sent += sent;
     }
 
+    op.complete(size);
     return true;
 }
 
@@ -83,65 +123,499 @@ bool UDPSocket::isConnected() const {
     return sockfd_ != -1;
 }
 
+ssize_t UDPSocket::receive(PooledBuffer& block) {
+    block = BufferPool::local().acquire();
+    if (!block) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ssize_t n = receive(block.data(), block.capacity());
+    if (n <= 0) {
+        block.reset();
+    }
+    return n;
+}
+
 std::string UDPSocket::receive(size_t max_size) {
+    // Receive into a pooled block so only the bytes that arrived are copied
+    BufferPool& pool = BufferPool::local();
+    if (max_size <= pool.getBlockSize()) {
+        PooledBuffer block = pool.acquire();
+        if (block) {
+            ssize_t n = receive(block.data(), max_size);
+            return n > 0 ? std::string(block.data(), n) : std::string();
+        }
+    }
+
+    std::string result(max_size, '\0');
+    ssize_t n = receive(&result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return result;
+}
+
+ssize_t UDPSocket::receive(char* buffer, size_t size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
-        return "";
+        errno = EBADF;
+        return -1;
     }
 
-    char* buffer = new char[max_size];
+    if (!read_buffer_.empty()) {
+        return read_buffer_.read(buffer, size);
+    }
+
+    return readSocket(buffer, size);
+}
+
+ssize_t UDPSocket::readSocket(char* buffer, size_t size) {
     sockaddr_in sender_addr;
     socklen_t addr_len = sizeof(sender_addr);
 
-    ssize_t n = ::recvfrom(sockfd_, buffer, max_size, 0, (sockaddr*)&sender_addr, &addr_len);
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    ssize_t n;
+    if (uring_) {
+        n = uring_->receive(sockfd_, buffer, size, receive_timeout_ms_);
+    } else {
+        SyscallCounter::add();
+        n = ::recvfrom(sockfd_, buffer, size, 0, (sockaddr*)&sender_addr, &addr_len);
+    }
     
     if (n < 0) {
         if (errno == EAGAIN || errno == EWOULDBLOCK) {
             // No data available right now
-            delete[] buffer;
-            return "";
+            op.retry();
+            return -1;
         }
         Utils::log("Error: recvfrom() failed: " + std::string(strerror(errno)));
-        delete[] buffer;
-        return "";
+        op.fail();
+        return -1;
     }
-    
-    std::string result(buffer, n);
-    delete[] buffer;
-    return result;
+
+    op.complete(n);
+    return n;
+}
+
+bool UDPSocket::sendv(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    if (uring_) {
+        if (!uring_->queueSendTo(sockfd_, iov, count, server_addr_)) {
+            op.fail();
+            return false;
+        }
+        op.complete(total);
+        return true;
+    }
+
+    // The buffers form one datagram, which is sent whole or not at all
+    msghdr msg{};
+    msg.msg_name = &server_addr_;
+    msg.msg_namelen = sizeof(server_addr_);
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+
+    while (true) {
+        SyscallCounter::add();
+        if (::sendmsg(sockfd_, &msg, MSG_NOSIGNAL) >= 0) {
+            break;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            // Socket buffer full, try again
+            op.retry();
+            continue;
+        }
+        Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+        op.fail();
+        return false;
+    }
+
+    op.complete(total);
+    return true;
+}
+
+ssize_t UDPSocket::receivev(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    if (!read_buffer_.empty()) {
+        ssize_t total = 0;
+        for (int i = 0; i < count && !read_buffer_.empty(); ++i) {
+            total += read_buffer_.read(static_cast<char*>(iov[i].iov_base), iov[i].iov_len);
+        }
+        return total;
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, 0);
+
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+        } else {
+            op.retry();
+        }
+        return -1;
+    }
+
+    op.complete(n);
+    return n;
+}
+
+int UDPSocket::sendBatch(UDPDatagram* datagrams, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+
+    if (uring_) {
+        // Queued datagrams already share a single io_uring_enter
+        for (int i = 0; i < count; ++i) {
+            const sockaddr_in& peer = datagrams[i].peer.sin_family == AF_INET ? datagrams[i].peer
+                                                                             : server_addr_;
+            if (!uring_->queueSendTo(sockfd_, datagrams[i].data, datagrams[i].size, peer)) {
+                if (i == 0) {
+                    op.fail();
+                }
+                return i > 0 ? i : -1;
+            }
+            op.complete(datagrams[i].size);
+        }
+        return count;
+    }
+
+    mmsghdr msgs[kMaxBatch];
+    iovec iovs[kMaxBatch];
+    int total = 0;
+
+    while (total < count) {
+        int n = std::min(count - total, kMaxBatch);
+        for (int i = 0; i < n; ++i) {
+            UDPDatagram& datagram = datagrams[total + i];
+            iovs[i].iov_base = datagram.data;
+            iovs[i].iov_len = datagram.size;
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = datagram.peer.sin_family == AF_INET ? &datagram.peer : &server_addr_;
+            msgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        SyscallCounter::add();
+        int sent = ::sendmmsg(sockfd_, msgs, n, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket buffer full, try again
+                op.retry();
+                continue;
+            }
+            Utils::log("Error: sendmmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return total > 0 ? total : -1;
+        }
+        for (int i = 0; i < sent; ++i) {
+            op.complete(datagrams[total + i].size);
+        }
+        total += sent;
+    }
+
+    return total;
+}
+
+int UDPSocket::receiveBatch(UDPDatagram* datagrams, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    // Leftover bytes of a receiveUntil() come back as one datagram first
+    if (!read_buffer_.empty() && count > 0) {
+        datagrams[0].length = read_buffer_.read(datagrams[0].data, datagrams[0].size);
+        datagrams[0].peer = server_addr_;
+        return 1;
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    mmsghdr msgs[kMaxBatch];
+    iovec iovs[kMaxBatch];
+    int total = 0;
+
+    while (total < count) {
+        int n = std::min(count - total, kMaxBatch);
+        for (int i = 0; i < n; ++i) {
+            UDPDatagram& datagram = datagrams[total + i];
+            iovs[i].iov_base = datagram.data;
+            iovs[i].iov_len = datagram.size;
+            std::memset(&msgs[i], 0, sizeof(msgs[i]));
+            msgs[i].msg_hdr.msg_name = &datagram.peer;
+            msgs[i].msg_hdr.msg_namelen = sizeof(datagram.peer);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // Only the very first datagram is waited for
+        int flags = total == 0 ? MSG_WAITFORONE : MSG_DONTWAIT;
+        SyscallCounter::add();
+        int received = ::recvmmsg(sockfd_, msgs, n, flags, nullptr);
+        if (received < 0) {
+            if (total > 0) {
+                break;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Utils::log("Error: recvmmsg() failed: " + std::string(strerror(errno)));
+                op.fail();
+            } else {
+                op.retry();
+            }
+            return -1;
+        }
+
+        for (int i = 0; i < received; ++i) {
+            datagrams[total + i].length = msgs[i].msg_len;
+            op.complete(msgs[i].msg_len);
+        }
+        total += received;
+        if (received < n) {
+            break;
+        }
+    }
+
+    return total;
+}
+
+bool UDPSocket::sendSegmented(const char* data, size_t size, uint16_t segment_size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    if (segment_size == 0 || segment_size > kMaxUdpPayload) {
+        Utils::log("Error: invalid UDP segment size: " + std::to_string(segment_size));
+        errno = EINVAL;
+        return false;
+    }
+
+    // Segments must not interleave with datagrams still queued on io_uring
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return false;
+    }
+
+    // Largest whole number of segments a single GSO send can carry
+    size_t max_chunk = std::min(kGsoMaxSegments, kMaxUdpPayload / segment_size) * segment_size;
+    char control[CMSG_SPACE(sizeof(uint16_t))];
+    size_t offset = 0;
+    // Covers the GSO sends; the sendmmsg() fallback records its own
+    SocketOp op(stats_.get(), SocketOp::Send);
+
+    while (offset < size && gso_supported_) {
+        size_t chunk = std::min(size - offset, max_chunk);
+        iovec iov{const_cast<char*>(data + offset), chunk};
+
+        msghdr msg{};
+        msg.msg_name = &server_addr_;
+        msg.msg_namelen = sizeof(server_addr_);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_UDP;
+        cmsg->cmsg_type = UDP_SEGMENT;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(uint16_t));
+        std::memcpy(CMSG_DATA(cmsg), &segment_size, sizeof(segment_size));
+
+        SyscallCounter::add();
+        if (::sendmsg(sockfd_, &msg, MSG_NOSIGNAL) < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // Socket buffer full, try again
+                op.retry();
+                continue;
+            }
+            if (errno == EIO || errno == EINVAL || errno == ENOPROTOOPT || errno == EOPNOTSUPP) {
+                Utils::log("UDP GSO unavailable, falling back to sendmmsg().");
+                gso_supported_ = false;
+                break;
+            }
+            Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return false;
+        }
+        op.complete(chunk, (chunk + segment_size - 1) / segment_size);
+        offset += chunk;
+    }
+
+    // Fallback: one datagram per segment, still batched per syscall
+    UDPDatagram datagrams[kMaxBatch];
+    while (offset < size) {
+        int count = 0;
+        while (count < kMaxBatch && offset < size) {
+            size_t length = std::min<size_t>(size - offset, segment_size);
+            datagrams[count++] = UDPDatagram{const_cast<char*>(data + offset), length, 0, {}};
+            offset += length;
+        }
+        if (sendBatch(datagrams, count) != count) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool UDPSocket::setGroEnabled(bool enable) {
+    int value = enable ? 1 : 0;
+    if (!setSocketOption(SOL_UDP, UDP_GRO, &value, sizeof(value))) {
+        return false;
+    }
+    gro_enabled_ = enable;
+    return true;
+}
+
+bool UDPSocket::isGroEnabled() const {
+    return gro_enabled_;
+}
+
+int UDPSocket::receiveSegments(char* buffer, size_t size, UDPDatagram* datagrams, int max_datagrams) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    // Leftover bytes of a receiveUntil() come back as one datagram first
+    if (!read_buffer_.empty() && max_datagrams > 0) {
+        size_t n = read_buffer_.read(buffer, size);
+        datagrams[0] = UDPDatagram{buffer, n, n, server_addr_};
+        return 1;
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return -1;
+    }
+
+    sockaddr_in peer{};
+    iovec iov{buffer, size};
+    char control[CMSG_SPACE(sizeof(int))];
+
+    msghdr msg{};
+    msg.msg_name = &peer;
+    msg.msg_namelen = sizeof(peer);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, 0);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+        } else {
+            op.retry();
+        }
+        return -1;
+    }
+
+    if (msg.msg_flags & MSG_TRUNC) {
+        Utils::log("Error: receive buffer too small, datagrams truncated.");
+    }
+
+    // Without a UDP_GRO control message the read holds a single datagram
+    size_t segment_size = static_cast<size_t>(n);
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+            int gso_size = 0;
+            std::memcpy(&gso_size, CMSG_DATA(cmsg), sizeof(gso_size));
+            if (gso_size > 0) {
+                segment_size = static_cast<size_t>(gso_size);
+            }
+        }
+    }
+
+    if (n == 0 && max_datagrams > 0) {
+        datagrams[0] = UDPDatagram{buffer, 0, 0, peer};
+        return 1;
+    }
+
+    int count = 0;
+    size_t offset = 0;
+    while (offset < static_cast<size_t>(n) && count < max_datagrams) {
+        size_t length = std::min(segment_size, static_cast<size_t>(n) - offset);
+        datagrams[count++] = UDPDatagram{buffer + offset, length, length, peer};
+        offset += length;
+    }
+    op.complete(offset, count);
+
+    if (offset < static_cast<size_t>(n)) {
+        Utils::log("Error: receiveSegments() dropped " + std::to_string(n - offset) +
+                   " bytes, not enough datagram slots.");
+    }
+
+    return count;
 }
 
 std::string UDPSocket::receiveWithTimeout(int timeout_seconds, size_t max_size) {
+    return receiveWithTimeout(std::chrono::seconds(timeout_seconds), max_size);
+}
+
+std::string UDPSocket::receiveWithTimeout(std::chrono::microseconds timeout, size_t max_size) {
     if (sockfd_ < 0) {
         Utils::log("Error: socket is not open.");
         return "";
     }
 
-    fd_set read_fds;
-    FD_ZERO(&read_fds);
-    FD_SET(sockfd_, &read_fds);
+    if (!read_buffer_.empty()) {
+        return receive(max_size);
+    }
 
-    struct timeval timeout;
-    timeout.tv_sec = timeout_seconds;
-    timeout.tv_usec = 0;
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return "";
+    }
 
-    int activity = select(sockfd_ + 1, &read_fds, nullptr, nullptr, &timeout);
-    
-    if (activity < 0) {
-        Utils::log("Error: select() failed: " + std::string(strerror(errno)));
+    int ready = SocketSet::waitFd(sockfd_, SocketSet::Read, timeout);
+    if (ready < 0) {
         return "";
     }
     
-    if (activity == 0) {
+    if (ready == 0) {
         Utils::log("Receive timeout.");
         return "";
     }
 
-    if (FD_ISSET(sockfd_, &read_fds)) {
-        return receive(max_size);
-    }
-
-    return "";
+    return receive(max_size);
 }
 
 std::string UDPSocket::receiveUntil(const std::string& delimiter, size_t max_size) {
@@ -150,33 +624,76 @@ std::string UDPSocket::receiveUntil(const std::string& delimiter, size_t max_siz
         return "";
     }
 
-    std::string result;
-    char buffer[1024];
-    sockaddr_in sender_addr;
-    socklen_t addr_len = sizeof(sender_addr);
+    if (delimiter.empty()) {
+        Utils::log("Error: empty delimiter.");
+        return "";
+    }
+
+    // Queued io_uring sends must be on the wire before waiting for a reply
+    if (uring_ && uring_->hasPending() && !flush()) {
+        return "";
+    }
+
+    // Room for the largest possible datagram, so none is truncated
+    const size_t kReadChunk = 65536;
+    size_t scanned = 0;
+
+    while (true) {
+        // Only bytes not scanned yet are searched, plus the delimiter's
+        // length - 1 bytes before them in case a match straddles two datagrams
+        size_t pos = DelimiterSearch::find(read_buffer_.data() + scanned, read_buffer_.size() - scanned,
+                                           delimiter.data(), delimiter.size());
+        if (pos != DelimiterSearch::npos) {
+            // Return data up to and including delimiter; the rest stays buffered
+            return read_buffer_.take(scanned + pos + delimiter.size());
+        }
+        if (read_buffer_.size() >= delimiter.size()) {
+            scanned = read_buffer_.size() - delimiter.size() + 1;
+        }
+
+        if (read_buffer_.size() >= max_size) {
+            return read_buffer_.take(max_size);
+        }
+
+        // Fill all the space the buffer already has, not just one chunk
+        char* space = read_buffer_.prepare(kReadChunk);
+        ssize_t n = readSocket(space, read_buffer_.writable());
 
-    while (result.size() < max_size) {
-        ssize_t n = ::recvfrom(sockfd_, buffer, sizeof(buffer), 0, (sockaddr*)&sender_addr, &addr_len);
-        
         if (n < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
-                continue;
+                // Keep the partial message for the next call
+                Utils::log("Receive timeout.");
+                return "";
             }
-            Utils::log("Error: recvfrom() failed: " + std::string(strerror(errno)));
             break;
         }
-        
-        result.append(buffer, n);
-        
-        // Check if delimiter is found
-        size_t pos = result.find(delimiter);
-        if (pos != std::string::npos) {
-            // Return data up to and including delimiter
-            return result.substr(0, pos + delimiter.length());
-        }
+
+        read_buffer_.commit(n);
     }
-    
-    return result;
+
+    // Receive failed: hand out whatever arrived
+    return read_buffer_.take(read_buffer_.size());
+}
+
+bool UDPSocket::setStatsEnabled(bool enable) {
+#if NETWORK_SOCKET_STATS
+    if (!enable) {
+        stats_.reset();
+    } else if (!stats_) {
+        stats_ = std::make_unique<SocketStats>();
+    }
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+const SocketStats* UDPSocket::getStats() const {
+    return stats_.get();
+}
+
+size_t UDPSocket::getBufferedSize() const {
+    return read_buffer_.size();
 }
 
 int UDPSocket::getSocketFd() const {
@@ -201,7 +718,12 @@ bool UDPSocket::setReceiveTimeout(int seconds) {
     struct timeval timeout;
     timeout.tv_sec = seconds;
     timeout.tv_usec = 0;
-    return setSocketOption(SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    if (!setSocketOption(SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout))) {
+        return false;
+    }
+    // The io_uring path does not honour SO_RCVTIMEO, so keep it for a linked timeout
+    receive_timeout_ms_ = seconds * 1000;
+    return true;
 }
 
 bool UDPSocket::setSendTimeout(int seconds) {
@@ -211,10 +733,151 @@ bool UDPSocket::setSendTimeout(int seconds) {
     return setSocketOption(SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
 }
 
+bool UDPSocket::setIoEngine(IoEngine engine) {
+    if (engine == IoEngine::Syscall) {
+        if (uring_ && uring_->hasPending()) {
+            flush();
+        }
+        uring_.reset();
+        return true;
+    }
+
+    if (uring_) {
+        return true;
+    }
+
+    auto channel = std::make_unique<IoUringChannel>();
+    if (!channel->init()) {
+        Utils::log("io_uring unavailable, falling back to syscall I/O.");
+        return false;
+    }
+    uring_ = std::move(channel);
+    return true;
+}
+
+IoEngine UDPSocket::getIoEngine() const {
+    return uring_ ? IoEngine::IoUring : IoEngine::Syscall;
+}
+
+bool UDPSocket::flush() {
+    if (!uring_ || !uring_->hasPending()) {
+        return true;
+    }
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    if (!uring_->flush(sockfd_)) {
+        Utils::log("Error: sendto() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
 std::string UDPSocket::getAddress() const {
     return address_;
 }
 
 int UDPSocket::getPort() const {
     return port_;
-}
\ No newline at end of file
+}
+
+bool UDPSocket::attachContext(IoContext& io) {
+    if (io_context_ == &io) {
+        return true;
+    }
+    if (io_context_ != nullptr) {
+        Utils::log("Error: socket is driven by another IoContext.");
+        return false;
+    }
+    if (uring_) {
+        setIoEngine(IoEngine::Syscall);
+    }
+    // Registration also makes the fd non-blocking
+    if (!io.watch(sockfd_)) {
+        return false;
+    }
+    io_context_ = &io;
+    return true;
+}
+
+void UDPSocket::detachContext(int fd) {
+    if (io_context_ != nullptr) {
+        IoContext* io = io_context_;
+        io_context_ = nullptr;
+        io->forget(fd);
+    }
+}
+
+Task<bool> UDPSocket::asyncSend(IoContext& io, const char* data, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        co_return false;
+    }
+    if (!attachContext(io)) {
+        co_return false;
+    }
+
+    while (true) {
+        {
+            // Scoped so a wait below is not timed as part of the send
+            SocketOp op(stats_.get(), SocketOp::Send);
+            SyscallCounter::add();
+            ssize_t sent = ::sendto(sockfd_, data, size, MSG_NOSIGNAL, (sockaddr*)&server_addr_, sizeof(server_addr_));
+            if (sent >= 0) {
+                op.complete(sent);
+                co_return true;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                Utils::log("Error: sendto() failed: " + std::string(strerror(errno)));
+                op.fail();
+                co_return false;
+            }
+            op.retry();
+        }
+        bool ready = co_await io.writable(sockfd_);
+        if (!ready || sockfd_ < 0) {
+            co_return false;
+        }
+    }
+}
+
+Task<bool> UDPSocket::asyncSend(IoContext& io, std::string data) {
+    co_return co_await asyncSend(io, data.data(), data.size());
+}
+
+Task<ssize_t> UDPSocket::asyncReceive(IoContext& io, char* buffer, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        co_return -1;
+    }
+    if (!read_buffer_.empty()) {
+        co_return static_cast<ssize_t>(read_buffer_.read(buffer, size));
+    }
+    if (!attachContext(io)) {
+        co_return -1;
+    }
+
+    while (true) {
+        ssize_t n = readSocket(buffer, size);
+        if (n >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+            co_return n;
+        }
+        bool ready = co_await io.readable(sockfd_);
+        if (!ready || sockfd_ < 0) {
+            errno = ECANCELED;
+            co_return -1;
+        }
+    }
+}
+
+Task<std::string> UDPSocket::asyncReceive(IoContext& io, size_t max_size) {
+    std::string result(max_size, '\0');
+    ssize_t n = co_await asyncReceive(io, &result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    co_return result;
+}
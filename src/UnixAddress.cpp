@@ -0,0 +1,44 @@
+#include "../headers/network/UnixAddress.h"
+#include "../needed_files/Utils.h"
+
+#include <cstddef>
+#include <cstring>
+
+
+
+bool UnixAddress::fill(const std::string& path, sockaddr_un& address, socklen_t& length) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    // Abstract names are not NUL-terminated: the length says where they end
+    bool abstract = isAbstract(path);
+    size_t needed = abstract ? path.size() : path.size() + 1;
+    if (path.empty() || (abstract && path.size() == 1) || needed > sizeof(address.sun_path)) {
+        Utils::log("Error: invalid Unix socket path: " + path);
+        return false;
+    }
+
+    if (abstract) {
+        std::memcpy(address.sun_path + 1, path.data() + 1, path.size() - 1);
+    } else {
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    }
+    length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + needed);
+    return true;
+}
+
+std::string UnixAddress::toPath(const sockaddr_un& address, socklen_t length) {
+    size_t offset = offsetof(sockaddr_un, sun_path);
+    if (length <= offset) {
+        return "";
+    }
+    size_t size = length - offset;
+    if (address.sun_path[0] == '\0') {
+        return "@" + std::string(address.sun_path + 1, size - 1);
+    }
+    return std::string(address.sun_path, strnlen(address.sun_path, size));
+}
+
+bool UnixAddress::isAbstract(const std::string& path) {
+    return !path.empty() && path[0] == '@';
+}
@@ -0,0 +1,234 @@
+#include "../headers/network/UnixDatagramSocket.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../headers/network/UnixAddress.h"
+#include "../needed_files/Utils.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <unistd.h>
+
+
+
+UnixDatagramSocket::UnixDatagramSocket(const std::string& path)
+    : path_(path), sockfd_(-1), owns_file_(false) {}
+
+UnixDatagramSocket::~UnixDatagramSocket() {
+    close();
+}
+
+bool UnixDatagramSocket::open() {
+    sockaddr_un peer;
+    socklen_t peer_length;
+    if (!UnixAddress::fill(path_, peer, peer_length)) {
+        return false;
+    }
+
+    sockfd_ = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    // Binding only the family makes the kernel pick a free abstract name
+    sockaddr_un local{};
+    local.sun_family = AF_UNIX;
+    socklen_t local_length = sizeof(sa_family_t);
+    if (!local_path_.empty() && !UnixAddress::fill(local_path_, local, local_length)) {
+        ::close(sockfd_);
+        sockfd_ = -1;
+        return false;
+    }
+    if (bind(sockfd_, (sockaddr*)&local, local_length) < 0) {
+        Utils::log("Error: bind() failed: " + std::string(strerror(errno)));
+        ::close(sockfd_);
+        sockfd_ = -1;
+        return false;
+    }
+    owns_file_ = !local_path_.empty() && !UnixAddress::isAbstract(local_path_);
+
+    SyscallCounter::add();
+    if (connect(sockfd_, (sockaddr*)&peer, peer_length) < 0) {
+        Utils::log("Error: connect() failed: " + std::string(strerror(errno)));
+        close();
+        return false;
+    }
+
+    Utils::log("Unix datagram socket connected to " + path_);
+    return true;
+}
+
+void UnixDatagramSocket::close() {
+    if (sockfd_ != -1) {
+        ::close(sockfd_);
+        sockfd_ = -1;
+        if (owns_file_) {
+            ::unlink(local_path_.c_str());
+            owns_file_ = false;
+        }
+        Utils::log("Unix datagram socket closed.");
+    }
+}
+
+bool UnixDatagramSocket::send(const std::string& data) {
+    return send(data.data(), data.size());
+}
+
+bool UnixDatagramSocket::send(const char* data, size_t size) {
+    iovec iov{const_cast<char*>(data), size};
+    return sendv(&iov, 1);
+}
+
+std::string UnixDatagramSocket::receive() {
+    return receive(4096); // Default buffer size
+}
+
+std::string UnixDatagramSocket::receive(size_t max_size) {
+    std::string result(max_size, '\0');
+    ssize_t n = receive(&result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return result;
+}
+
+ssize_t UnixDatagramSocket::receive(char* buffer, size_t size) {
+    iovec iov{buffer, size};
+    return receivev(&iov, 1);
+}
+
+bool UnixDatagramSocket::sendv(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    // The buffers go out as one datagram, whole or not at all
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+    ssize_t sent;
+    do {
+        SyscallCounter::add();
+        sent = ::sendmsg(sockfd_, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    if (sent < 0) {
+        Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+        op.fail();
+        return false;
+    }
+
+    op.complete(total);
+    return true;
+}
+
+ssize_t UnixDatagramSocket::receivev(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, 0);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+        } else {
+            op.retry();
+        }
+        return -1;
+    }
+
+    if (msg.msg_flags & MSG_TRUNC) {
+        Utils::log("Error: datagram truncated to " + std::to_string(n) + " bytes.");
+    }
+    op.complete(n);
+    return n;
+}
+
+int UnixDatagramSocket::getSocketFd() const {
+    return sockfd_;
+}
+
+size_t UnixDatagramSocket::getBufferedSize() const {
+    return 0;
+}
+
+bool UnixDatagramSocket::isConnected() const {
+    return sockfd_ != -1;
+}
+
+void UnixDatagramSocket::setLocalPath(const std::string& path) {
+    local_path_ = path;
+}
+
+std::string UnixDatagramSocket::getLocalPath() const {
+    if (sockfd_ < 0) {
+        return local_path_;
+    }
+    sockaddr_un local{};
+    socklen_t length = sizeof(local);
+    if (getsockname(sockfd_, (sockaddr*)&local, &length) < 0) {
+        Utils::log("Error: getsockname() failed: " + std::string(strerror(errno)));
+        return "";
+    }
+    return UnixAddress::toPath(local, length);
+}
+
+bool UnixDatagramSocket::setReceiveTimeout(int seconds) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    timeval timeout{seconds, 0};
+    if (setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        Utils::log("Error: setsockopt(SO_RCVTIMEO) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool UnixDatagramSocket::setSendTimeout(int seconds) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    timeval timeout{seconds, 0};
+    if (setsockopt(sockfd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+        Utils::log("Error: setsockopt(SO_SNDTIMEO) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool UnixDatagramSocket::setStatsEnabled(bool enable) {
+#if NETWORK_SOCKET_STATS
+    if (!enable) {
+        stats_.reset();
+    } else if (!stats_) {
+        stats_ = std::make_unique<SocketStats>();
+    }
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+const SocketStats* UnixDatagramSocket::getStats() const {
+    return stats_.get();
+}
+
+const std::string& UnixDatagramSocket::getPath() const {
+    return path_;
+}
@@ -0,0 +1,362 @@
+#include "../headers/network/UnixStreamSocket.h"
+#include "../headers/network/SyscallCounter.h"
+#include "../headers/network/UnixAddress.h"
+#include "../needed_files/Utils.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+
+UnixStreamSocket::UnixStreamSocket(const std::string& path) : path_(path), sockfd_(-1) {}
+
+UnixStreamSocket::~UnixStreamSocket() {
+    close();
+}
+
+bool UnixStreamSocket::open() {
+    sockaddr_un address;
+    socklen_t length;
+    if (!UnixAddress::fill(path_, address, length)) {
+        return false;
+    }
+
+    sockfd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+
+    SyscallCounter::add();
+    if (connect(sockfd_, (sockaddr*)&address, length) < 0) {
+        Utils::log("Error: connect() failed: " + std::string(strerror(errno)));
+        ::close(sockfd_);
+        sockfd_ = -1;
+        return false;
+    }
+
+    Utils::log("Unix stream connection established to " + path_);
+    return true;
+}
+
+void UnixStreamSocket::close() {
+    if (sockfd_ != -1) {
+        ::close(sockfd_);
+        sockfd_ = -1;
+        Utils::log("Unix stream socket closed.");
+    }
+}
+
+bool UnixStreamSocket::adopt(int fd) {
+    close();
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) < 0) {
+        Utils::log("Error: fcntl(~O_NONBLOCK) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    sockfd_ = fd;
+    return true;
+}
+
+bool UnixStreamSocket::send(const std::string& data) {
+    return send(data.data(), data.size());
+}
+
+bool UnixStreamSocket::send(const char* data, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    size_t total_sent = 0;
+    while (total_sent < size) {
+        SyscallCounter::add();
+        ssize_t sent = ::send(sockfd_, data + total_sent, size - total_sent, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Utils::log("Error: send() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return false;
+        }
+        total_sent += sent;
+    }
+
+    op.complete(size);
+    return true;
+}
+
+std::string UnixStreamSocket::receive() {
+    return receive(4096); // Default buffer size
+}
+
+std::string UnixStreamSocket::receive(size_t max_size) {
+    std::string result(max_size, '\0');
+    ssize_t n = receive(&result[0], max_size);
+    result.resize(n > 0 ? static_cast<size_t>(n) : 0);
+    return result;
+}
+
+ssize_t UnixStreamSocket::receive(char* buffer, size_t size) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    SyscallCounter::add();
+    ssize_t n = ::recv(sockfd_, buffer, size, 0);
+    if (n < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            op.retry();
+            return -1;
+        }
+        Utils::log("Error: recv() failed: " + std::string(strerror(errno)));
+        op.fail();
+        return -1;
+    }
+
+    if (n == 0) {
+        Utils::log("Connection closed by peer.");
+    } else {
+        op.complete(n);
+    }
+    return n;
+}
+
+bool UnixStreamSocket::sendv(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Send);
+    size_t total = 0;
+    for (int i = 0; i < count; ++i) {
+        total += iov[i].iov_len;
+    }
+
+    // Same windowed partial-write handling as TCPSocket::sendv()
+    const int kWindow = 64;
+    iovec window[kWindow];
+    int index = 0;
+    size_t offset = 0;
+
+    while (index < count) {
+        if (iov[index].iov_len == offset) {
+            ++index;
+            offset = 0;
+            continue;
+        }
+
+        int n = std::min(count - index, kWindow);
+        std::copy(iov + index, iov + index + n, window);
+        window[0].iov_base = static_cast<char*>(window[0].iov_base) + offset;
+        window[0].iov_len -= offset;
+
+        msghdr msg{};
+        msg.msg_iov = window;
+        msg.msg_iovlen = n;
+        SyscallCounter::add();
+        ssize_t sent = ::sendmsg(sockfd_, &msg, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+            return false;
+        }
+
+        size_t remaining = static_cast<size_t>(sent);
+        while (index < count && remaining >= iov[index].iov_len - offset) {
+            remaining -= iov[index].iov_len - offset;
+            ++index;
+            offset = 0;
+        }
+        offset += remaining;
+    }
+
+    op.complete(total);
+    return true;
+}
+
+ssize_t UnixStreamSocket::receivev(const iovec* iov, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    SocketOp op(stats_.get(), SocketOp::Receive);
+    msghdr msg{};
+    msg.msg_iov = const_cast<iovec*>(iov);
+    msg.msg_iovlen = count;
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, 0);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+            op.fail();
+        } else {
+            op.retry();
+        }
+        return -1;
+    }
+
+    if (n == 0) {
+        Utils::log("Connection closed by peer.");
+    } else {
+        op.complete(n);
+    }
+    return n;
+}
+
+bool UnixStreamSocket::sendFds(const char* data, size_t size, const int* fds, int count) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    if (size == 0 || count < 0 || count > kMaxFds) {
+        Utils::log("Error: sendFds() needs data and at most " + std::to_string(kMaxFds) + " descriptors.");
+        return false;
+    }
+
+    // The descriptors travel with the first byte; the rest is plain data
+    iovec iov{const_cast<char*>(data), size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (count > 0) {
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * count);
+        cmsghdr* header = CMSG_FIRSTHDR(&msg);
+        header->cmsg_level = SOL_SOCKET;
+        header->cmsg_type = SCM_RIGHTS;
+        header->cmsg_len = CMSG_LEN(sizeof(int) * count);
+        std::memcpy(CMSG_DATA(header), fds, sizeof(int) * count);
+    }
+
+    ssize_t sent;
+    do {
+        SyscallCounter::add();
+        sent = ::sendmsg(sockfd_, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0) {
+        Utils::log("Error: sendmsg() failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return static_cast<size_t>(sent) == size || send(data + sent, size - sent);
+}
+
+ssize_t UnixStreamSocket::receiveFds(char* buffer, size_t size, int* fds, int max_fds, int& fd_count) {
+    fd_count = 0;
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        errno = EBADF;
+        return -1;
+    }
+
+    iovec iov{buffer, size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * kMaxFds)];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    SyscallCounter::add();
+    ssize_t n = ::recvmsg(sockfd_, &msg, MSG_CMSG_CLOEXEC);
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            Utils::log("Error: recvmsg() failed: " + std::string(strerror(errno)));
+        }
+        return -1;
+    }
+
+    for (cmsghdr* header = CMSG_FIRSTHDR(&msg); header != nullptr; header = CMSG_NXTHDR(&msg, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        int received = static_cast<int>((header->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        const unsigned char* data = CMSG_DATA(header);
+        for (int i = 0; i < received; ++i) {
+            int fd;
+            std::memcpy(&fd, data + i * sizeof(int), sizeof(int));
+            if (fd_count < max_fds) {
+                fds[fd_count++] = fd;
+            } else {
+                ::close(fd);
+            }
+        }
+    }
+    if (msg.msg_flags & MSG_CTRUNC) {
+        Utils::log("Error: descriptors dropped, more than " + std::to_string(kMaxFds) + " were sent.");
+    }
+    return n;
+}
+
+int UnixStreamSocket::getSocketFd() const {
+    return sockfd_;
+}
+
+size_t UnixStreamSocket::getBufferedSize() const {
+    return 0;
+}
+
+bool UnixStreamSocket::isConnected() const {
+    return sockfd_ != -1;
+}
+
+bool UnixStreamSocket::setReceiveTimeout(int seconds) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    timeval timeout{seconds, 0};
+    if (setsockopt(sockfd_, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0) {
+        Utils::log("Error: setsockopt(SO_RCVTIMEO) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool UnixStreamSocket::setSendTimeout(int seconds) {
+    if (sockfd_ < 0) {
+        Utils::log("Error: socket is not open.");
+        return false;
+    }
+    timeval timeout{seconds, 0};
+    if (setsockopt(sockfd_, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0) {
+        Utils::log("Error: setsockopt(SO_SNDTIMEO) failed: " + std::string(strerror(errno)));
+        return false;
+    }
+    return true;
+}
+
+bool UnixStreamSocket::setStatsEnabled(bool enable) {
+#if NETWORK_SOCKET_STATS
+    if (!enable) {
+        stats_.reset();
+    } else if (!stats_) {
+        stats_ = std::make_unique<SocketStats>();
+    }
+    return true;
+#else
+    return !enable;
+#endif
+}
+
+const SocketStats* UnixStreamSocket::getStats() const {
+    return stats_.get();
+}
+
+const std::string& UnixStreamSocket::getPath() const {
+    return path_;
+}
@@ -0,0 +1,169 @@
+#include "../headers/network/WorkStealingPool.h"
+
+
+
+namespace {
+
+    // Lets submit() from inside a job prefer the worker running it
+    thread_local const WorkStealingPool *current_pool = nullptr;
+    thread_local size_t current_worker = 0;
+
+}
+
+WorkStealingPool::WorkStealingPool(size_t threads, size_t queue_capacity)
+    : thread_count_(threads > 0 ? threads : 1), queue_capacity_(queue_capacity > 0 ? queue_capacity : 1),
+      next_worker_(0), running_(false), queued_(0), sleepers_(0), executed_(0), stolen_(0), rejected_(0) {}
+
+WorkStealingPool::~WorkStealingPool() {
+    stop();
+}
+
+bool WorkStealingPool::start() {
+    if (running_) {
+        return true;
+    }
+
+    workers_.clear();
+    for (size_t i = 0; i < thread_count_; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    running_ = true;
+    for (size_t i = 0; i < thread_count_; ++i) {
+        workers_[i]->thread = std::thread(&WorkStealingPool::workerLoop, this, i);
+    }
+    return true;
+}
+
+void WorkStealingPool::stop() {
+    {
+        std::unique_lock<std::shared_mutex> lock(submit_mutex_);
+        if (!running_) {
+            return;
+        }
+        running_ = false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+
+    for (auto &worker : workers_) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+    }
+}
+
+bool WorkStealingPool::submit(Job job, size_t hint) {
+    std::shared_lock<std::shared_mutex> lock(submit_mutex_);
+    if (!running_) {
+        return false;
+    }
+
+    size_t first;
+    if (current_pool == this) {
+        first = current_worker;
+    } else if (hint != kAnyWorker) {
+        first = hint;
+    } else {
+        first = next_worker_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The preferred deque first, then any other with room
+    for (size_t i = 0; i < thread_count_; ++i) {
+        if (!pushTo((first + i) % thread_count_, job)) {
+            continue;
+        }
+        // Pairs with the sleeper registering before it checks queued_: one
+        // of the two sides always sees the other
+        if (sleepers_.load() > 0) {
+            {
+                std::lock_guard<std::mutex> sleep_lock(sleep_mutex_);
+            }
+            wake_.notify_one();
+        }
+        return true;
+    }
+
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+bool WorkStealingPool::pushTo(size_t index, Job &job) {
+    Worker &worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.jobs.size() >= queue_capacity_) {
+        return false;
+    }
+    worker.jobs.push_back(std::move(job));
+    queued_.fetch_add(1);
+    return true;
+}
+
+bool WorkStealingPool::takeOwn(size_t index, Job &job) {
+    Worker &worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.jobs.empty()) {
+        return false;
+    }
+    job = std::move(worker.jobs.front());
+    worker.jobs.pop_front();
+    queued_.fetch_sub(1);
+    return true;
+}
+
+bool WorkStealingPool::steal(size_t thief, Job &job) {
+    // The owner works from the front, so thieves rarely touch the same end
+    for (size_t i = 1; i < thread_count_; ++i) {
+        Worker &victim = *workers_[(thief + i) % thread_count_];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.jobs.empty()) {
+            continue;
+        }
+        job = std::move(victim.jobs.back());
+        victim.jobs.pop_back();
+        queued_.fetch_sub(1);
+        stolen_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::workerLoop(size_t index) {
+    current_pool = this;
+    current_worker = index;
+
+    Job job;
+    while (true) {
+        if (takeOwn(index, job) || steal(index, job)) {
+            job();
+            job = nullptr;
+            executed_.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        sleepers_.fetch_add(1);
+        wake_.wait(lock, [this]() { return queued_.load() > 0 || !running_; });
+        sleepers_.fetch_sub(1);
+        // Stopping still runs everything that was accepted
+        if (!running_ && queued_.load() == 0) {
+            break;
+        }
+    }
+
+    current_pool = nullptr;
+}
+
+size_t WorkStealingPool::getThreadCount() const {
+    return thread_count_;
+}
+
+WorkStealingPool::Stats WorkStealingPool::getStats() const {
+    Stats stats{};
+    stats.executed = executed_.load(std::memory_order_relaxed);
+    stats.stolen = stolen_.load(std::memory_order_relaxed);
+    stats.rejected = rejected_.load(std::memory_order_relaxed);
+    stats.queued = queued_.load(std::memory_order_relaxed);
+    return stats;
+}
@@ -1,5 +1,6 @@
 #include "socketStatusChecker.h"
 #include <unistd.h>
+#include <poll.h>
 #include <sys/socket.h>
 
 namespace Network {
@@ -15,5 +16,21 @@ namespace Network {
         return (result == 0 && error == 0);
     }
 
-}
+    bool SocketStatusChecker::isConnectionReusable(int sockfd) {
+        if (!isPortBusy(sockfd)) return false;
+
+        // An idle connection must have nothing to read: readability means
+        // either EOF from the peer or a stale response nobody consumed
+        pollfd pfd{};
+        pfd.fd = sockfd;
+        pfd.events = POLLIN | POLLRDHUP;
+        int ready = poll(&pfd, 1, 0);
+        if (ready < 0) return false;
+        if (ready == 0) return true;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLRDHUP | POLLNVAL)) return false;
 
+        char byte;
+        return recv(sockfd, &byte, 1, MSG_PEEK | MSG_DONTWAIT) < 0;
+    }
+
+}
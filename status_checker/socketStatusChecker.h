@@ -5,7 +5,10 @@ namespace Network {
     class SocketStatusChecker {
     public:
         static bool isPortBusy(int sockfd);
+        // True when a connected stream socket can carry a new request: no
+        // pending error, the peer has not closed it and no unread bytes are
+        // waiting. Never blocks.
+        static bool isConnectionReusable(int sockfd);
     };
 
 }
-
@@ -1,13 +1,34 @@
 #include "../headers/network/TCPSocket.h"
 #include "../headers/network/UDPSocket.h"
 #include "../server_for_test/SimpleServer.h"
+#include "../server_for_test/CoroutineServer.h"
+#include "../server_for_test/UnixServer.h"
+#include "../server_for_test/SharedMemoryServer.h"
 #include "../headers/network/ISocket.h"
+#include "../headers/network/BufferPool.h"
+#include "../headers/network/ConnectionPool.h"
+#include "../headers/network/DelimiterSearch.h"
+#include "../headers/network/FrameCodec.h"
+#include "../headers/network/IoContext.h"
+#include "../headers/network/SharedMemorySocket.h"
+#include "../headers/network/SocketSet.h"
+#include "../headers/network/SocketStats.h"
+#include "../headers/network/UnixDatagramSocket.h"
+#include "../headers/network/UnixStreamSocket.h"
+#include "../headers/network/WorkStealingPool.h"
+#include "../needed_files/Logger.h"
 #include "../needed_files/Utils.h"
 #include "../status_checker/socketStatusChecker.h"
 
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
 #include <thread>
 #include <memory>
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <vector>
 
 namespace NetworkTest {
     const std::string loopback = "127.0.0.1";
@@ -64,6 +85,30 @@ namespace TCPTest {
         {
             Utils::log("Expected: Failed to connect to non-existent server.");
         }
+
+        // A listener that never accepts drops SYNs once its backlog is full,
+        // like an unreachable host: the connect gives up at the deadline
+        // instead of after the kernel's SYN retries
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t address_len = sizeof(address);
+        bind(listener, (sockaddr *)&address, sizeof(address));
+        listen(listener, 0);
+        getsockname(listener, (sockaddr *)&address, &address_len);
+
+        TCPSocket backlogFiller(loopback, ntohs(address.sin_port));
+        backlogFiller.open(200);
+        TCPSocket stalled(loopback, ntohs(address.sin_port));
+        auto start = std::chrono::steady_clock::now();
+        bool opened = stalled.open(200);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        ::close(listener);
+        if (!opened && elapsed.count() < 1000)
+            Utils::log("Expected: stalled connect gave up after " + std::to_string(elapsed.count()) + " ms.");
+        else
+            Utils::log("Unexpected: connect deadline not honoured!");
     }
 
     void testWithServer()
@@ -113,6 +158,85 @@ namespace TCPTest {
             tcpSocket.close();
         }
 
+        // Test caller-owned buffers
+        Utils::log("\n--- Caller Buffer Usage ---");
+        TCPSocket bufferSocket(loopback, port);
+        if (bufferSocket.open())
+        {
+            const char request[] = "Hello from a caller buffer!";
+            char reply[256];
+            bufferSocket.setReceiveTimeout(3);
+
+            if (bufferSocket.send(request, sizeof(request) - 1))
+            {
+                ssize_t n = bufferSocket.receive(reply, sizeof(reply));
+                if (n > 0)
+                {
+                    Utils::log("Received: " + std::string(reply, n));
+                }
+            }
+
+            bufferSocket.close();
+        }
+
+        // Test scatter-gather I/O: header + body + trailer in one call
+        Utils::log("\n--- Scatter-Gather Usage ---");
+        TCPSocket vectorSocket(loopback, port);
+        if (vectorSocket.open())
+        {
+            std::string header = "[hdr]", body = "Hello in pieces!", trailer = "[end]";
+            iovec parts[] = {{&header[0], header.size()}, {&body[0], body.size()},
+                             {&trailer[0], trailer.size()}};
+            char prefix[6], rest[256];
+            iovec reply[] = {{prefix, sizeof(prefix)}, {rest, sizeof(rest)}};
+            vectorSocket.setReceiveTimeout(3);
+
+            if (vectorSocket.sendv(parts, 3))
+            {
+                ssize_t n = vectorSocket.receivev(reply, 2);
+                if (n > static_cast<ssize_t>(sizeof(prefix)))
+                {
+                    Utils::log("Received: " + std::string(prefix, sizeof(prefix)) +
+                               std::string(rest, n - sizeof(prefix)));
+                }
+            }
+
+            vectorSocket.close();
+        }
+
+        // Test delimited reads: bytes past the delimiter stay buffered
+        Utils::log("\n--- Delimited Receive Usage ---");
+        TCPSocket lineSocket(loopback, port);
+        if (lineSocket.open())
+        {
+            lineSocket.setReceiveTimeout(3);
+            if (lineSocket.send("line one\r\nline two\r\n"))
+            {
+                std::string first = lineSocket.receiveUntil("\r\n");
+                std::string second = lineSocket.receiveUntil("\r\n");
+                Utils::log("Received: " + first.substr(0, first.size() - 2));
+                Utils::log("Then: " + second.substr(0, second.size() - 2));
+            }
+
+            lineSocket.close();
+        }
+
+        // Test exact-length reads
+        Utils::log("\n--- Exact Receive Usage ---");
+        TCPSocket exactSocket(loopback, port);
+        if (exactSocket.open())
+        {
+            exactSocket.setReceiveTimeout(3);
+            if (exactSocket.send("0123456789"))
+            {
+                std::string header = exactSocket.receiveExact(6);
+                std::string body = exactSocket.receiveExact(10);
+                Utils::log("Received: " + header + body);
+            }
+
+            exactSocket.close();
+        }
+
         // Test polymorphic usage
         Utils::log("\n--- Polymorphic Usage ---");
         std::unique_ptr<ISocket> socket = std::make_unique<TCPSocket>(loopback, port);
@@ -129,6 +253,32 @@ namespace TCPTest {
             std::this_thread::sleep_for(std::chrono::milliseconds(200));
         }
 
+        // An idle connection must not block other clients
+        Utils::log("\n--- Concurrent Connections Test ---");
+        TCPSocket idleClient(loopback, port);
+        if (idleClient.open())
+        {
+            TCPSocket client(loopback, port);
+            testSocket(&client, "Message while another client is idle");
+            idleClient.close();
+        }
+
+        // Many connects in flight at once from this thread
+        Utils::log("\n--- Parallel Connect Test ---");
+        std::vector<std::unique_ptr<TCPSocket>> fleet;
+        std::vector<TCPSocket *> targets;
+        for (int i = 0; i < 32; ++i)
+        {
+            fleet.push_back(std::make_unique<TCPSocket>(loopback, port));
+            targets.push_back(fleet.back().get());
+        }
+        size_t opened = TCPSocket::openAll(targets, 1000);
+        Utils::log("Opened " + std::to_string(opened) + " of " + std::to_string(targets.size()) + " connections in parallel.");
+        TCPSocket *last = fleet.back().get();
+        if (last->isConnected() && last->send("Message after parallel connect"))
+            Utils::log("Received: " + last->receiveWithTimeout(3));
+        fleet.clear();
+
         // Give time for last client to finish
         std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
 
@@ -204,6 +354,92 @@ namespace UDPTest {
             udpSocket.close();
         }
 
+        // Test caller-owned buffers
+        Utils::log("\n--- Caller Buffer Usage ---");
+        UDPSocket bufferSocket(loopback, port);
+        if (bufferSocket.open())
+        {
+            const char request[] = "Hello from a caller buffer!";
+            char reply[256];
+            bufferSocket.setReceiveTimeout(3);
+
+            if (bufferSocket.send(request, sizeof(request) - 1))
+            {
+                ssize_t n = bufferSocket.receive(reply, sizeof(reply));
+                if (n > 0)
+                {
+                    Utils::log("Received: " + std::string(reply, n));
+                }
+            }
+
+            // Pooled block: no allocation on the receive path
+            PooledBuffer block;
+            if (bufferSocket.send("Hello into a pooled block!"))
+            {
+                ssize_t n = bufferSocket.receive(block);
+                if (n > 0)
+                {
+                    Utils::log("Received: " + std::string(block.data(), n));
+                }
+            }
+
+            bufferSocket.close();
+        }
+
+        // Test batched I/O: several datagrams per syscall
+        Utils::log("\n--- Batch Usage ---");
+        UDPSocket batchSocket(loopback, port);
+        if (batchSocket.open())
+        {
+            std::string messages[3] = {"Batch #1", "Batch #2", "Batch #3"};
+            char replies[3][256];
+            UDPDatagram out[3], in[3];
+            for (int i = 0; i < 3; ++i)
+            {
+                out[i] = UDPDatagram{&messages[i][0], messages[i].size(), 0, {}};
+                in[i] = UDPDatagram{replies[i], sizeof(replies[i]), 0, {}};
+            }
+            batchSocket.setReceiveTimeout(3);
+
+            if (batchSocket.sendBatch(out, 3) == 3)
+            {
+                int got = 0;
+                int n;
+                while (got < 3 && (n = batchSocket.receiveBatch(in + got, 3 - got)) > 0)
+                    got += n;
+                for (int i = 0; i < got; ++i)
+                    Utils::log("Received: " + std::string(in[i].data, in[i].length));
+            }
+
+            batchSocket.close();
+        }
+
+        // Test segmentation offload: one GSO send becomes three datagrams
+        Utils::log("\n--- Segmentation Offload Usage ---");
+        UDPSocket gsoSocket(loopback, port);
+        if (gsoSocket.open())
+        {
+            const char stream[] = "GSO-1GSO-2GSO-3";
+            char buffer[65536];
+            UDPDatagram segments[64];
+            gsoSocket.setReceiveTimeout(3);
+            gsoSocket.setGroEnabled(true);
+
+            if (gsoSocket.sendSegmented(stream, sizeof(stream) - 1, 5))
+            {
+                int got = 0;
+                int n;
+                while (got < 3 && (n = gsoSocket.receiveSegments(buffer, sizeof(buffer), segments, 64)) > 0)
+                {
+                    for (int i = 0; i < n; ++i)
+                        Utils::log("Received: " + std::string(segments[i].data, segments[i].length));
+                    got += n;
+                }
+            }
+
+            gsoSocket.close();
+        }
+
         // Test polymorphic usage
         Utils::log("\n--- Polymorphic Usage ---");
         std::unique_ptr<ISocket> socket = std::make_unique<UDPSocket>(loopback, port);
@@ -228,4 +464,1200 @@ namespace UDPTest {
         server.stop();
         Utils::log("Server cleanup complete.");
     }
-}
\ No newline at end of file
+}
+
+namespace IoUringTest {
+    using namespace NetworkTest;
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing io_uring engine (falls back to syscalls if unavailable) ===");
+        port++;
+
+        SimpleServer tcpServer(port);
+        tcpServer.setIoEngine(IoEngine::IoUring);
+        SimpleUDPServer udpServer(port);
+        udpServer.setIoEngine(IoEngine::IoUring);
+        if (!tcpServer.start() || !udpServer.start())
+        {
+            Utils::log("Failed to start servers!");
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        Utils::log("\n--- TCP over io_uring ---");
+        for (int i = 1; i <= 3; ++i)
+        {
+            TCPSocket client(loopback, port);
+            if (!client.setIoEngine(IoEngine::IoUring))
+                Utils::log("io_uring unavailable, using syscalls.");
+            // The timeout needs an open socket
+            if (client.open() && client.setReceiveTimeout(3) &&
+                client.send("io_uring TCP message #" + std::to_string(i)))
+                Utils::log("Received: " + client.receive());
+            else
+                Utils::log("io_uring TCP exchange failed!");
+            client.close();
+        }
+
+        Utils::log("\n--- UDP over io_uring ---");
+        for (int i = 1; i <= 3; ++i)
+        {
+            UDPSocket client(loopback, port);
+            if (!client.setIoEngine(IoEngine::IoUring))
+                Utils::log("io_uring unavailable, using syscalls.");
+            // The timeout needs an open socket
+            if (client.open() && client.setReceiveTimeout(3) &&
+                client.send("io_uring UDP message #" + std::to_string(i)))
+                Utils::log("Received: " + client.receive());
+            else
+                Utils::log("io_uring UDP exchange failed!");
+            client.close();
+        }
+
+        Utils::log("\n--- Stopping Servers ---");
+        tcpServer.stop();
+        udpServer.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace ShardedServerTest {
+    using namespace NetworkTest;
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing SO_REUSEPORT sharded server ===");
+        port++;
+
+        SimpleServer server(port);
+        server.setShardCount(4);
+        server.setCpuPinning(true);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        // Connections are spread across the shard listeners by the kernel
+        for (int i = 1; i <= 8; ++i)
+        {
+            TCPSocket client(loopback, port);
+            testSocket(&client, "Sharded message #" + std::to_string(i));
+        }
+
+        Utils::log("\n--- Stopping Server ---");
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace BufferPoolTest {
+    void testPool()
+    {
+        Utils::log("\n=== Testing receive buffer pool ===");
+        BufferPool pool(1024, 4);
+
+        // Blocks are recycled instead of reallocated
+        for (int i = 0; i < 16; ++i)
+        {
+            PooledBuffer block = pool.acquire();
+            std::memset(block.data(), 'x', block.capacity());
+        }
+
+        // A block freed on another thread comes back through the remote list
+        PooledBuffer shared = pool.acquire();
+        std::thread([block = std::move(shared)]() mutable { block.reset(); }).join();
+        PooledBuffer reused = pool.acquire();
+
+        BufferPool::Stats stats = pool.getStats();
+        Utils::log("Pool: " + std::to_string(stats.hits) + " hits, " +
+                   std::to_string(stats.misses) + " misses, " +
+                   std::to_string(stats.remote_frees) + " remote frees, " +
+                   std::to_string(stats.blocks_in_use) + " in use");
+        if (stats.misses == 1 && stats.remote_frees == 1 && stats.blocks_in_use == 1 && reused)
+            Utils::log("Pool reuse works as expected.");
+        else
+            Utils::log("Unexpected pool statistics!");
+
+        // A thread-local pool outlives its thread while a block is out; the
+        // block still counts as in use once the owner has gone
+        PooledBuffer orphan;
+        BufferPool *orphan_pool = nullptr;
+        std::thread([&]()
+        {
+            orphan_pool = &BufferPool::local();
+            orphan = orphan_pool->acquire();
+        }).join();
+        if (orphan_pool->getStats().blocks_in_use == 1)
+            Utils::log("Block outliving its thread's pool counted as in use.");
+        else
+            Utils::log("Unexpected in-use count after the owner exited!");
+        orphan.reset();
+    }
+}
+
+namespace LoggerTest {
+    void testLogger()
+    {
+        Utils::log("\n=== Testing asynchronous logger ===");
+        Logger &logger = Logger::instance();
+
+        // Records below the runtime level are skipped before formatting
+        LogLevel previous = logger.getLevel();
+        logger.setLevel(LogLevel::Warn);
+        NET_LOG_INFO("This line must not appear");
+        NET_LOG_WARN("Warn records pass the filter");
+        logger.setLevel(previous);
+
+        // Several threads logging at once; each has its own ring.
+        // The trace records go to /dev/null to keep the output readable.
+        int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+        logger.flush();
+        logger.setSink(null_fd);
+        logger.setLevel(LogLevel::Trace);
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([t]() {
+                for (int i = 0; i < 2000; ++i)
+                    NET_LOG_TRACE("thread " + std::to_string(t) + " record " + std::to_string(i));
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+
+        logger.setLevel(previous);
+        logger.setSink(STDOUT_FILENO);
+        ::close(null_fd);
+        Utils::log("Logger flushed, producer stalls: " + std::to_string(logger.getStalls()));
+    }
+}
+
+namespace DelimiterSearchTest {
+    // Every available kernel must agree with std::string::find
+    void testKernels()
+    {
+        Utils::log("\n=== Testing delimiter search kernels ===");
+        const DelimiterSearch::Kernel kernels[] = {DelimiterSearch::Kernel::Scalar,
+                                                   DelimiterSearch::Kernel::SSE2,
+                                                   DelimiterSearch::Kernel::AVX2};
+        const std::string delimiters[] = {"\n", "\r\n", "\r\n\r\n", "--boundary--"};
+
+        unsigned seed = 12345;
+        auto next = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) & 0x7fff;
+        };
+
+        for (auto kernel : kernels)
+        {
+            if (!DelimiterSearch::isSupported(kernel))
+            {
+                Utils::log(std::string(DelimiterSearch::kernelName(kernel)) + ": not supported, skipped");
+                continue;
+            }
+
+            int mismatches = 0;
+            for (int round = 0; round < 2000; ++round)
+            {
+                // Small alphabet so partial matches are frequent
+                std::string data(next() % 300, 'a');
+                for (auto &c : data)
+                    c = "ab\r\n-y"[next() % 6];
+                const std::string &delimiter = delimiters[round % 4];
+                size_t start = data.empty() ? 0 : next() % data.size();
+
+                size_t expected = data.find(delimiter, start);
+                size_t found = DelimiterSearch::find(kernel, data.data() + start, data.size() - start,
+                                                     delimiter.data(), delimiter.size());
+                if (found != DelimiterSearch::npos)
+                    found += start;
+                if ((expected == std::string::npos ? DelimiterSearch::npos : expected) != found)
+                    ++mismatches;
+            }
+
+            Utils::log(std::string(DelimiterSearch::kernelName(kernel)) + ": " +
+                       (mismatches == 0 ? "all results match" : std::to_string(mismatches) + " mismatches!"));
+        }
+    }
+}
+
+namespace FrameCodecTest {
+    // Frames encoded in one batch must come back intact however the byte
+    // stream is split up
+    void testCodec()
+    {
+        Utils::log("\n=== Testing frame codec ===");
+        const FramePrefix prefixes[] = {FramePrefix::Varint, FramePrefix::Fixed16, FramePrefix::Fixed32};
+        const char *names[] = {"varint", "fixed16", "fixed32"};
+
+        unsigned seed = 777;
+        auto next = [&seed]() {
+            seed = seed * 1103515245 + 12345;
+            return (seed >> 16) & 0x7fff;
+        };
+
+        for (int p = 0; p < 3; ++p)
+        {
+            std::vector<std::string> frames;
+            FrameEncoder encoder(prefixes[p]);
+            for (int i = 0; i < 500; ++i)
+            {
+                // Sizes around the 1- and 2-byte varint boundaries
+                size_t size = i % 50 == 0 ? 20000 : next() % 300;
+                frames.push_back(std::string(size, static_cast<char>('a' + i % 26)));
+                encoder.add(frames.back());
+            }
+
+            FrameParser parser(prefixes[p]);
+            const std::string &stream = encoder.buffer();
+            size_t offset = 0;
+            size_t matched = 0;
+            bool ok = true;
+            while (offset < stream.size())
+            {
+                size_t chunk = std::min<size_t>(stream.size() - offset, 1 + next() % 4000);
+                parser.feed(stream.data() + offset, chunk);
+                offset += chunk;
+
+                FrameView frame;
+                while (parser.next(frame))
+                {
+                    ok = ok && matched < frames.size() &&
+                         frames[matched].compare(0, std::string::npos, frame.data, frame.size) == 0;
+                    ++matched;
+                }
+            }
+
+            Utils::log(std::string(names[p]) + ": " + std::to_string(matched) + "/" +
+                       std::to_string(frames.size()) + " frames" +
+                       (ok && matched == frames.size() && !parser.hasError() ? ", all intact" : ", MISMATCH!"));
+        }
+
+        // A corrupt length must be reported, not waited on forever
+        FrameParser limited(FramePrefix::Fixed32, 1024);
+        limited.feed("\x7f\xff\xff\xff", 4);
+        FrameView frame;
+        if (!limited.next(frame) && limited.hasError())
+            Utils::log("Oversized frame rejected as expected.");
+
+        // A 10th varint byte above 1 would wrap the length to 0
+        FrameParser overflow(FramePrefix::Varint, 1024);
+        overflow.feed("\x80\x80\x80\x80\x80\x80\x80\x80\x80\x02", 10);
+        if (!overflow.next(frame) && overflow.hasError())
+            Utils::log("Overflowing varint prefix rejected as expected.");
+    }
+}
+
+namespace ConnectionPoolTest {
+    using namespace NetworkTest;
+
+    void logStats(const ConnectionPool::Stats &stats)
+    {
+        Utils::log("Pool: " + std::to_string(stats.hits) + " hits, " +
+                   std::to_string(stats.misses) + " misses, " +
+                   std::to_string(stats.evictions) + " evictions, " +
+                   std::to_string(stats.timeouts) + " timeouts, hit rate " +
+                   std::to_string(stats.hitRate()));
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing TCP connection pool ===");
+        port++;
+
+        SimpleServer server(port);
+        server.setPersistentConnections(true);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        ConnectionPool::Options options;
+        options.max_per_destination = 2;
+        options.idle_timeout_ms = 200;
+        options.eviction_interval_ms = 50;
+        options.acquire_timeout_ms = 100;
+        ConnectionPool pool(options);
+
+        // Sequential requests share one connection
+        for (int i = 1; i <= 5; ++i)
+        {
+            PooledConnection conn = pool.acquire(loopback, port);
+            if (!conn)
+            {
+                Utils::log("Failed to acquire a connection.");
+                continue;
+            }
+            conn->setReceiveTimeout(3);
+            if (conn->send("Pooled message #" + std::to_string(i)))
+                Utils::log("Received: " + conn->receive());
+        }
+
+        // The cap holds further callers until a lease comes back
+        {
+            PooledConnection first = pool.acquire(loopback, port);
+            PooledConnection second = pool.acquire(loopback, port);
+            PooledConnection third = pool.acquire(loopback, port);
+            if (first && second && !third)
+                Utils::log("Expected: third connection refused at the per-destination cap.");
+            else
+                Utils::log("Unexpected: per-destination cap not enforced!");
+        }
+
+        // Idle connections are closed by the eviction timer
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.idle_timeout_ms + 2 * options.eviction_interval_ms));
+        ConnectionPool::Stats stats = pool.getStats();
+        logStats(stats);
+        if (stats.hits == 5 && stats.misses == 2 && stats.evictions == 2 && stats.idle == 0)
+            Utils::log("Connection reuse and eviction work as expected.");
+        else
+            Utils::log("Unexpected pool statistics!");
+
+        // A connection the server dropped fails the health check
+        {
+            PooledConnection conn = pool.acquire(loopback, port);
+        }
+        server.stop();
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        PooledConnection stale = pool.acquire(loopback, port);
+        if (!stale && pool.getStats().failed_checks == 1)
+            Utils::log("Expected: closed connection detected and not reused.");
+        else
+            Utils::log("Unexpected: closed connection handed out!");
+
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace SocketSetTest {
+    using namespace NetworkTest;
+
+    void testBackend(SocketSet::Backend backend, const std::string &name)
+    {
+        Utils::log("\n--- " + name + " backend ---");
+        std::vector<std::unique_ptr<UDPSocket>> clients;
+        SocketSet set(backend);
+        for (int i = 0; i < 3; ++i)
+        {
+            clients.push_back(std::make_unique<UDPSocket>(loopback, port));
+            if (!clients.back()->open() || !set.add(clients.back().get()))
+            {
+                Utils::log("Failed to open UDP client!");
+                return;
+            }
+        }
+
+        // Only the client that sent gets an echo back
+        clients[1]->send("SocketSet message");
+        int ready = set.wait(std::chrono::seconds(3));
+        if (ready == 1 && set.ready()[0].socket == clients[1].get())
+            Utils::log("Received: " + clients[1]->receive());
+        else
+            Utils::log("Unexpected ready set of " + std::to_string(ready) + " sockets!");
+
+        // Sub-millisecond deadline with nothing to read
+        auto start = SocketSet::Clock::now();
+        ready = set.wait(std::chrono::microseconds(1500));
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(SocketSet::Clock::now() - start);
+        if (ready == 0 && elapsed.count() >= 1500 && elapsed.count() < 50000)
+            Utils::log("Expected: timed out after " + std::to_string(elapsed.count()) + " us.");
+        else
+            Utils::log("Unexpected: wait returned " + std::to_string(ready) + " after " +
+                       std::to_string(elapsed.count()) + " us!");
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing multi-socket readiness wait ===");
+        port++;
+
+        SimpleUDPServer server(port);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        testBackend(SocketSet::Backend::Poll, "poll");
+        testBackend(SocketSet::Backend::Epoll, "epoll");
+
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace SocketStatsTest {
+    using namespace NetworkTest;
+
+    void testHistogram()
+    {
+        StatsHistogram histogram;
+        for (uint64_t value = 1; value <= 10000; ++value)
+            histogram.record(value);
+
+        StatsHistogram::Snapshot snapshot = histogram.snapshot();
+        uint64_t p50 = snapshot.percentile(0.50);
+        uint64_t p99 = snapshot.percentile(0.99);
+        Utils::log("Histogram: count " + std::to_string(snapshot.count) + ", p50 " + std::to_string(p50) +
+                   ", p99 " + std::to_string(p99) + ", max " + std::to_string(snapshot.max));
+        // Buckets are 1/16 of a power of two wide
+        if (snapshot.count == 10000 && p50 >= 5000 && p50 <= 5000 + 5000 / 16 + 256 && p99 >= 9900 &&
+            snapshot.max == 10000)
+            Utils::log("Histogram percentiles within bucket precision.");
+        else
+            Utils::log("Unexpected histogram percentiles!");
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing socket instrumentation ===");
+        testHistogram();
+        port++;
+
+        SimpleServer server(port);
+        server.setPersistentConnections(true);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        TCPSocket client(loopback, port);
+        if (!client.setStatsEnabled(true))
+        {
+            Utils::log("Socket stats compiled out (NETWORK_SOCKET_STATS=OFF).");
+            server.stop();
+            return;
+        }
+        SocketStats::global().reset();
+        SocketStats::setGlobalEnabled(true);
+
+        const std::string message = "Instrumented message";
+        const size_t reply_size = message.size() + 6;
+        int replies = 0;
+        if (client.open())
+        {
+            client.setReceiveTimeout(3);
+            for (int i = 0; i < 10; ++i)
+            {
+                if (client.send(message) && client.receiveExact(reply_size).size() == reply_size)
+                    ++replies;
+            }
+            client.close();
+        }
+        SocketStats::setGlobalEnabled(false);
+
+        SocketStats::Snapshot local = client.getStats()->snapshot();
+        SocketStats::Snapshot global = SocketStats::global().snapshot();
+        Utils::log("Stats: " + local.toJson().substr(0, 160) + "...");
+        if (replies == 10 && local.counters.messages_sent == 10 &&
+            local.counters.bytes_sent == 10 * message.size() &&
+            local.counters.bytes_received == 10 * reply_size &&
+            local.counters.syscalls >= 20 && local.send_latency_ns.count == 10 &&
+            local.send_size.percentile(0.5) == message.size() &&
+            global.counters.bytes_sent == local.counters.bytes_sent)
+            Utils::log("Socket counters match the traffic.");
+        else
+            Utils::log("Unexpected socket counters!");
+
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace FileTransferTest {
+    using namespace NetworkTest;
+
+    // Ephemeral-port listener and a connected pair through it
+    int listenLoopback(int &listen_port)
+    {
+        int listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t address_len = sizeof(address);
+        bind(listener, (sockaddr *)&address, sizeof(address));
+        listen(listener, 4);
+        getsockname(listener, (sockaddr *)&address, &address_len);
+        listen_port = ntohs(address.sin_port);
+        return listener;
+    }
+
+    std::string readAll(int fd, size_t size)
+    {
+        std::string data;
+        char buffer[65536];
+        while (data.size() < size)
+        {
+            ssize_t n = ::recv(fd, buffer, std::min(sizeof(buffer), size - data.size()), 0);
+            if (n <= 0)
+                break;
+            data.append(buffer, n);
+        }
+        return data;
+    }
+
+    void testWithoutServer()
+    {
+        Utils::log("\n=== Testing zero-copy file transfer ===");
+
+        std::string content;
+        for (size_t i = 0; content.size() < 1024 * 1024; ++i)
+            content += "block " + std::to_string(i) + "\n";
+
+        char path[] = "/tmp/network_sendfile_XXXXXX";
+        int file_fd = mkstemp(path);
+        if (file_fd < 0 || ::write(file_fd, content.data(), content.size()) != (ssize_t)content.size())
+        {
+            Utils::log("Failed to create test file!");
+            return;
+        }
+        unlink(path);
+
+        int listen_port = 0;
+        int listener = listenLoopback(listen_port);
+        TCPSocket client(loopback, listen_port);
+        TCPSocket relayOut(loopback, listen_port);
+        if (!client.open() || !relayOut.open())
+        {
+            Utils::log("Failed to open TCP sockets!");
+            ::close(listener);
+            ::close(file_fd);
+            return;
+        }
+        int peer = accept(listener, nullptr, nullptr);
+        int relayPeer = accept(listener, nullptr, nullptr);
+        ::close(listener);
+
+        // sendfile() from an offset, larger than the socket buffers
+        const off_t offset = 1000;
+        const size_t length = content.size() - offset;
+        bool sent = false;
+        std::thread sender([&]() { sent = client.sendFile(file_fd, offset, length); });
+        std::string received = readAll(peer, length);
+        sender.join();
+        if (sent && received == content.substr(offset))
+            Utils::log("sendFile delivered " + std::to_string(received.size()) + " bytes intact.");
+        else
+            Utils::log("sendFile mismatch: " + std::to_string(received.size()) + " bytes!");
+
+        // Proxy: bytes arriving on `client` are spliced out on `relayOut`
+        client.setReceiveTimeout(3);
+        std::thread writer([&]() {
+            size_t done = 0;
+            while (done < content.size())
+            {
+                ssize_t n = ::send(peer, content.data() + done, content.size() - done, MSG_NOSIGNAL);
+                if (n <= 0)
+                    break;
+                done += n;
+            }
+        });
+        ssize_t relayed = 0;
+        std::thread relay([&]() { relayed = client.spliceTo(relayOut, content.size()); });
+        std::string proxied = readAll(relayPeer, content.size());
+        writer.join();
+        relay.join();
+        if (relayed == (ssize_t)content.size() && proxied == content)
+            Utils::log("spliceTo relayed " + std::to_string(relayed) + " bytes intact.");
+        else
+            Utils::log("spliceTo mismatch: " + std::to_string(relayed) + " bytes!");
+
+        // End of stream stops a relay early; a send to a closed peer fails
+        // without SIGPIPE
+        ::send(peer, "tail", 4, MSG_NOSIGNAL);
+        ::close(peer);
+        relayed = client.spliceTo(relayOut, content.size());
+        Utils::log("spliceTo after peer close moved " + std::to_string(relayed) + " bytes.");
+        ::close(relayPeer);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        bool failed = !relayOut.sendFile(file_fd, 0, content.size()) || !relayOut.sendFile(file_fd, 0, content.size());
+        Utils::log(failed ? "Expected: sendFile to a closed peer failed." : "Unexpected: sendFile succeeded!");
+
+        client.close();
+        relayOut.close();
+        ::close(file_fd);
+    }
+}
+
+namespace ZeroCopyTest {
+    using namespace NetworkTest;
+
+    void testWithoutServer()
+    {
+        Utils::log("\n=== Testing MSG_ZEROCOPY sends ===");
+
+        int listen_port = 0;
+        int listener = FileTransferTest::listenLoopback(listen_port);
+        TCPSocket client(loopback, listen_port);
+        if (!client.setZeroCopy(true) || !client.open())
+        {
+            Utils::log("Zero copy unavailable, skipping.");
+            ::close(listener);
+            return;
+        }
+        int peer = accept(listener, nullptr, nullptr);
+        ::close(listener);
+
+        // The socket keeps the payload alive after the caller lets go
+        auto large = std::make_shared<std::string>(512 * 1024, 'z');
+        std::weak_ptr<std::string> watch = large;
+        auto small = std::make_shared<const std::string>("below threshold");
+        bool sent = false;
+        std::thread sender([&]() {
+            sent = client.sendZeroCopy(std::move(large)) && client.sendZeroCopy(small);
+        });
+        std::string received = FileTransferTest::readAll(peer, 512 * 1024 + small->size());
+        sender.join();
+        if (sent && received == std::string(512 * 1024, 'z') + *small)
+            Utils::log("Zero-copy payload delivered intact.");
+        else
+            Utils::log("Zero-copy payload mismatch: " + std::to_string(received.size()) + " bytes!");
+
+        bool drained = client.waitZeroCopy(2000);
+        TCPSocket::ZeroCopyStats stats = client.getZeroCopyStats();
+        Utils::log("Zero copy: sends " + std::to_string(stats.zerocopy_sends) + ", copied " +
+                   std::to_string(stats.copied_sends) + ", completions " + std::to_string(stats.completions) +
+                   ", deferred copies " + std::to_string(stats.deferred_copies));
+        if (drained && watch.expired() && client.getZeroCopyPending() == 0 && stats.zerocopy_sends == 1 &&
+            stats.copied_sends == 1 && stats.completions >= 1)
+            Utils::log("Payload released after its completion.");
+        else
+            Utils::log("Unexpected zero-copy bookkeeping!");
+
+        client.close();
+        ::close(peer);
+    }
+}
+
+namespace SocketTuningTest {
+    using namespace NetworkTest;
+
+    int getOption(int fd, int level, int name)
+    {
+        int value = -1;
+        socklen_t length = sizeof(value);
+        getsockopt(fd, level, name, &value, &length);
+        return value;
+    }
+
+    void testProfile(const std::string &name, const SocketTuning &tuning)
+    {
+        Utils::log("\n--- " + name + ": " + tuning.describe() + " ---");
+        TCPSocket client(loopback, port);
+        client.setTuning(tuning);
+        if (!client.open())
+        {
+            Utils::log("Failed to open TCP socket!");
+            return;
+        }
+
+        int fd = client.getSocketFd();
+        bool applied = getOption(fd, IPPROTO_TCP, TCP_NODELAY) == (tuning.no_delay > 0 ? 1 : 0) &&
+                       getOption(fd, SOL_SOCKET, SO_KEEPALIVE) == tuning.keepalive &&
+                       getOption(fd, IPPROTO_TCP, TCP_KEEPIDLE) == tuning.keepalive_idle_s &&
+                       getOption(fd, SOL_SOCKET, SO_PRIORITY) == tuning.priority &&
+                       (tuning.not_sent_lowat < 0 ||
+                        getOption(fd, IPPROTO_TCP, TCP_NOTSENT_LOWAT) == tuning.not_sent_lowat) &&
+                       (tuning.send_buffer < 0 || getOption(fd, SOL_SOCKET, SO_SNDBUF) >= tuning.send_buffer);
+        Utils::log(applied ? "Options applied at open." : "Unexpected socket options!");
+
+        client.setReceiveTimeout(3);
+        if (client.send(name))
+            Utils::log("Received: " + client.receive());
+        client.close();
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing socket tuning profiles ===");
+        port++;
+
+        SimpleServer server(port);
+        server.setTuning(SocketTuning::bulkThroughput());
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        testProfile("low-latency", SocketTuning::lowLatency());
+        testProfile("bulk-throughput", SocketTuning::bulkThroughput());
+
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace CoroutineTest {
+    using namespace NetworkTest;
+
+    // Straight-line client session: connect, then `rounds` echoes
+    Task<void> echoSession(IoContext &io, int id, int rounds, int &completed)
+    {
+        TCPSocket client(loopback, port);
+        bool opened = co_await client.asyncOpen(io);
+        if (!opened)
+            co_return;
+        for (int i = 0; i < rounds; ++i)
+        {
+            std::string request = "session " + std::to_string(id) + " round " + std::to_string(i) + "\n";
+            bool sent = co_await client.asyncSend(io, request);
+            if (!sent)
+                co_return;
+            std::string reply = co_await client.asyncReceiveUntil(io, "\n");
+            if (reply != "Echo: " + request)
+                co_return;
+        }
+        ++completed;
+    }
+
+    Task<void> udpSession(IoContext &io, int udp_port, std::string &reply)
+    {
+        UDPSocket client(loopback, udp_port);
+        if (!client.open())
+            co_return;
+        bool sent = co_await client.asyncSend(io, std::string("Coroutine UDP message"));
+        if (sent)
+            reply = co_await client.asyncReceive(io);
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing coroutine socket API ===");
+        port++;
+
+        CoroutineEchoServer server(port);
+        server.setPersistentConnections(true);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        // Many concurrent sessions on this one thread
+        const int sessions = 200;
+        int completed = 0;
+        IoContext io;
+        io.init();
+        for (int i = 0; i < sessions; ++i)
+            io.spawn(echoSession(io, i, 5, completed));
+        io.runUntilIdle();
+        if (completed == sessions)
+            Utils::log("All " + std::to_string(sessions) + " coroutine sessions completed.");
+        else
+            Utils::log("Only " + std::to_string(completed) + " of " + std::to_string(sessions) +
+                       " coroutine sessions completed!");
+        server.stop();
+
+        // Blocking clients work against the coroutine servers too
+        port++;
+        CoroutineEchoServer oneShot(port);
+        if (oneShot.start())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+            TCPSocket tcpClient(loopback, port);
+            testSocket(&tcpClient, "Blocking client to coroutine server");
+            oneShot.stop();
+        }
+
+        port++;
+        CoroutineUDPEchoServer udpServer(port);
+        if (udpServer.start())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+            std::string reply;
+            IoContext udpIo;
+            udpIo.init();
+            udpIo.spawn(udpSession(udpIo, port, reply));
+            udpIo.runUntilIdle();
+            Utils::log(reply.empty() ? "No UDP response received." : "Received: " + reply);
+            udpServer.stop();
+        }
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace WorkerPoolTest {
+    using namespace NetworkTest;
+
+    void testPool()
+    {
+        Utils::log("\n=== Testing work-stealing pool ===");
+
+        // Every job is queued on worker 0; the others only get work by stealing
+        std::atomic<int> done{0};
+        {
+            WorkStealingPool pool(4, 256);
+            pool.start();
+            for (int i = 0; i < 200; ++i)
+            {
+                pool.submit([&done]() {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    done++;
+                }, 0);
+            }
+            pool.stop();
+
+            WorkStealingPool::Stats stats = pool.getStats();
+            Utils::log("Pool: " + std::to_string(stats.executed) + " executed, " +
+                       std::to_string(stats.stolen) + " stolen");
+            if (done == 200 && stats.executed == 200 && stats.stolen > 0)
+                Utils::log("Idle workers stole queued jobs.");
+            else
+                Utils::log("Unexpected pool statistics!");
+        }
+
+        // A full pool refuses work instead of queueing it
+        WorkStealingPool bounded(1, 1);
+        bounded.start();
+        std::atomic<bool> release{false};
+        std::atomic<bool> started{false};
+        bounded.submit([&]() {
+            started = true;
+            while (!release)
+                std::this_thread::yield();
+        });
+        while (!started)
+            std::this_thread::yield();
+        bool queued = bounded.submit([]() {});
+        bool refused = !bounded.submit([]() {});
+        release = true;
+        bounded.stop();
+        if (queued && refused && bounded.getStats().rejected == 1)
+            Utils::log("Full pool rejected the extra job.");
+        else
+            Utils::log("Full pool accepted too much!");
+
+        // Jobs accepted while stop() runs still execute
+        WorkStealingPool racing(2, 100000);
+        racing.start();
+        std::atomic<int> accepted{0};
+        std::atomic<int> ran{0};
+        std::thread submitter([&]() {
+            for (int i = 0; i < 100000; ++i)
+            {
+                if (!racing.submit([&ran]() { ran++; }))
+                    break;
+                accepted++;
+            }
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        racing.stop();
+        submitter.join();
+        if (accepted == ran)
+            Utils::log("Every job accepted around stop() ran (" + std::to_string(ran.load()) + ").");
+        else
+            Utils::log("Accepted jobs lost at stop: " + std::to_string(accepted - ran) + "!");
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing server with worker threads ===");
+        port++;
+
+        SimpleServer server(port);
+        server.setShardCount(2);
+        server.setWorkerThreads(3, 4);
+        server.setPersistentConnections(true);
+        server.setRequestHandler([](std::string_view request) {
+            return "Worker: " + std::string(request);
+        });
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        TCPSocket client(loopback, port);
+        testSocket(&client, "Request answered by a worker");
+
+        // More concurrent requests than the workers can queue: some
+        // connections wait for room, none is dropped
+        std::atomic<int> answered{0};
+        std::vector<std::thread> clients;
+        for (int i = 0; i < 32; ++i)
+        {
+            clients.emplace_back([&answered, i]() {
+                TCPSocket socket(loopback, port);
+                if (!socket.open())
+                    return;
+                for (int r = 0; r < 10; ++r)
+                {
+                    std::string request = "client " + std::to_string(i) + " request " + std::to_string(r);
+                    if (!socket.send(request) || socket.receive() != "Worker: " + request)
+                        return;
+                }
+                answered++;
+            });
+        }
+        for (auto &thread : clients)
+            thread.join();
+
+        WorkStealingPool::Stats stats = server.getWorkerStats();
+        Utils::log("Workers: " + std::to_string(stats.executed) + " executed, " +
+                   std::to_string(stats.stolen) + " stolen, " + std::to_string(stats.rejected) + " refused");
+        if (answered == 32 && stats.executed >= 321)
+            Utils::log("All concurrent clients were answered by the workers.");
+        else
+            Utils::log("Only " + std::to_string(answered.load()) + " of 32 clients were answered!");
+
+        Utils::log("\n--- Stopping Server ---");
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace PipelineTest {
+    using namespace NetworkTest;
+
+    // Sends `count` frames in one write and checks the echoes come back in
+    // order; one of them (`large` bytes) is far above the unframed
+    // 1023-byte limit
+    bool exchangePipelined(TCPSocket &client, int count, size_t large = 100000)
+    {
+        std::vector<std::string> requests;
+        FrameEncoder encoder;
+        for (int i = 0; i < count; ++i)
+        {
+            requests.push_back(i == count / 2 ? std::string(large, 'L') : "pipelined request " + std::to_string(i));
+            encoder.add(requests.back());
+        }
+        if (!encoder.flush(client))
+            return false;
+
+        FrameParser parser;
+        int matched = 0;
+        while (matched < count)
+        {
+            if (parser.readFrom(client) <= 0)
+                return false;
+            FrameView frame;
+            while (parser.next(frame))
+            {
+                if (std::string(frame.data, frame.size) != "Echo: " + requests[matched])
+                    return false;
+                ++matched;
+            }
+        }
+        return true;
+    }
+
+    void testServer(const std::string &name, int workers)
+    {
+        port++;
+        SimpleServer server(port);
+        server.setShardCount(2);
+        server.setFraming(FramePrefix::Varint);
+        server.setIdleTimeout(300);
+        server.setWorkerThreads(workers);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(TIME));
+
+        TCPSocket client(loopback, port);
+        if (client.open())
+        {
+            // Two batches over the same connection
+            if (exchangePipelined(client, 50) && exchangePipelined(client, 50))
+                Utils::log(name + ": all pipelined replies received in order on one connection.");
+            else
+                Utils::log(name + ": pipelined replies missing or out of order!");
+
+            // A single frame bigger than the server's 256 KB read batch
+            client.setReceiveTimeout(5);
+            if (exchangePipelined(client, 3, 300000))
+                Utils::log(name + ": frame larger than a read batch answered.");
+            else
+                Utils::log(name + ": frame larger than a read batch not answered!");
+
+            // Left alone, the connection is closed by the server
+            std::this_thread::sleep_for(std::chrono::milliseconds(700));
+            FrameParser parser;
+            if (parser.readFrom(client) == 0)
+                Utils::log(name + ": idle connection was closed by the server.");
+            else
+                Utils::log(name + ": idle connection is still open!");
+            client.close();
+        }
+
+        Utils::log("\n--- Stopping Server ---");
+        server.stop();
+        Utils::log("Server cleanup complete.");
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing persistent pipelined connections ===");
+        testServer("inline", 0);
+        testServer("workers", 2);
+    }
+}
+
+namespace UnixSocketTest {
+    using namespace NetworkTest;
+
+    // Unique per run so parallel test runs do not collide
+    std::string socketName(const std::string &kind)
+    {
+        return "network_test_" + kind + "_" + std::to_string(getpid());
+    }
+
+    void testWithoutServer()
+    {
+        Utils::log("\n=== Testing Unix domain sockets without server ===");
+
+        UnixStreamSocket missing("@" + socketName("missing"));
+        if (!missing.open())
+            Utils::log("Expected: connecting to an unbound name failed.");
+
+        UnixStreamSocket tooLong(std::string(200, 'x'));
+        if (!tooLong.open())
+            Utils::log("Expected: over-long path rejected.");
+    }
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing Unix domain sockets with server ===");
+
+        // Abstract and filesystem names behave the same once bound
+        const std::string streamPaths[] = {"@" + socketName("stream"), "/tmp/" + socketName("stream") + ".sock"};
+        for (const std::string &path : streamPaths)
+        {
+            SimpleUnixServer server(path);
+            if (!server.start())
+            {
+                Utils::log("Failed to start server!");
+                continue;
+            }
+            UnixStreamSocket client(path);
+            testSocket(&client, "Hello over " + std::string(path[0] == '@' ? "abstract" : "filesystem") + " Unix stream");
+            server.stop();
+            if (path[0] != '@' && access(path.c_str(), F_OK) != 0)
+                Utils::log("Socket file removed on stop.");
+        }
+
+        SimpleUnixDatagramServer datagramServer("@" + socketName("dgram"));
+        if (datagramServer.start())
+        {
+            UnixDatagramSocket client("@" + socketName("dgram"));
+            if (client.open())
+            {
+                Utils::log(client.getLocalPath().size() > 1 && client.getLocalPath()[0] == '@'
+                               ? "Client autobound to an abstract name."
+                               : "Client has no name to reply to!");
+                client.close();
+            }
+            testSocket(&client, "Hello over Unix datagram");
+            datagramServer.stop();
+        }
+        Utils::log("Server cleanup complete.");
+    }
+}
+
+namespace SharedMemoryTest {
+    using namespace NetworkTest;
+
+    void testWithServer()
+    {
+        Utils::log("\n=== Testing shared memory sockets with server ===");
+
+        const std::string path = "@" + UnixSocketTest::socketName("shm");
+        SimpleSharedMemoryServer server(path);
+        if (!server.start())
+        {
+            Utils::log("Failed to start server!");
+            return;
+        }
+
+        SharedMemorySocket futexClient(path);
+        testSocket(&futexClient, "Hello over shared memory (futex)");
+
+        SharedMemorySocket eventClient(path);
+        eventClient.setWakeup(ShmWakeup::EventFd);
+        testSocket(&eventClient, "Hello over shared memory (eventfd)");
+
+        // A client that never reads: the echoes fill its 4 KB ring and the
+        // server's send has to give up for stop() to return
+        SharedMemorySocket stalledClient(path);
+        stalledClient.setRingSize(4096);
+        if (stalledClient.open())
+        {
+            std::string request(1000, 'x');
+            for (int i = 0; i < 8; ++i)
+                stalledClient.send(request);
+        }
+
+        auto stop_start = std::chrono::steady_clock::now();
+        server.stop();
+        auto stop_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - stop_start);
+        Utils::log("Server stopped in " + std::to_string(stop_ms.count()) + " ms with a client not reading.");
+        stalledClient.close();
+        Utils::log("Server cleanup complete.");
+    }
+
+    void testLargeTransfer()
+    {
+        Utils::log("\n=== Testing shared memory transfer larger than the ring ===");
+
+        const std::string path = "@" + UnixSocketTest::socketName("shm_bulk");
+        SharedMemoryAcceptor acceptor(path);
+        if (!acceptor.listen())
+        {
+            Utils::log("Failed to listen!");
+            return;
+        }
+
+        // 1 MB through a 4 KB ring: the sender has to sleep until the
+        // receiver makes room, many times over
+        std::string payload(1024 * 1024, '\0');
+        for (size_t i = 0; i < payload.size(); ++i)
+            payload[i] = static_cast<char>('a' + i % 26);
+
+        std::string received;
+        ssize_t after_close = -1;
+        std::thread receiver([&]()
+        {
+            std::unique_ptr<SharedMemorySocket> peer = acceptor.accept(TIME * 10);
+            if (!peer)
+                return;
+            std::vector<char> buffer(10000);
+            ssize_t n;
+            while ((n = peer->receive(buffer.data(), buffer.size())) > 0)
+                received.append(buffer.data(), n);
+            after_close = n;
+        });
+
+        SharedMemorySocket sender(path);
+        sender.setRingSize(4096);
+        if (sender.open())
+        {
+            Utils::log("Ring size: " + std::to_string(sender.getRingSize()) + " bytes");
+            if (sender.send(payload))
+                Utils::log("Data sent successfully.");
+            sender.close();
+        }
+        receiver.join();
+
+        Utils::log(received == payload ? "Received all " + std::to_string(received.size()) + " bytes in order."
+                                       : "Payload mismatch: " + std::to_string(received.size()) + " bytes received!");
+        if (after_close == 0)
+            Utils::log("Peer close seen as end of stream.");
+    }
+}
@@ -1,3 +1,4 @@
+#include "../needed_files/Logger.h"
 #include "../needed_files/Utils.h"
 #include "NetworkTest.h"
 
@@ -9,6 +10,9 @@
 
 int main()
 {
+    // Include the per-message server lines in the test output
+    Logger::instance().setLevel(LogLevel::Debug);
+
     Utils::log("TCP Socket Test Application");
     Utils::log("============================");
 
@@ -24,5 +28,76 @@ int main()
     Utils::log("============================");
 
     Utils::log("\n=== Test For UDP Socket Complete ===");
+
+    IoUringTest::testWithServer();
+
+    Utils::log("\n=== Test For io_uring Engine Complete ===");
+
+    ShardedServerTest::testWithServer();
+
+    Utils::log("\n=== Test For Sharded Server Complete ===");
+
+    BufferPoolTest::testPool();
+
+    Utils::log("\n=== Test For Buffer Pool Complete ===");
+
+    LoggerTest::testLogger();
+
+    Utils::log("\n=== Test For Logger Complete ===");
+
+    DelimiterSearchTest::testKernels();
+
+    Utils::log("\n=== Test For Delimiter Search Complete ===");
+
+    FrameCodecTest::testCodec();
+
+    Utils::log("\n=== Test For Frame Codec Complete ===");
+
+    ConnectionPoolTest::testWithServer();
+
+    Utils::log("\n=== Test For Connection Pool Complete ===");
+
+    SocketSetTest::testWithServer();
+
+    Utils::log("\n=== Test For Socket Set Complete ===");
+
+    SocketStatsTest::testWithServer();
+
+    Utils::log("\n=== Test For Socket Stats Complete ===");
+
+    FileTransferTest::testWithoutServer();
+
+    Utils::log("\n=== Test For File Transfer Complete ===");
+
+    ZeroCopyTest::testWithoutServer();
+
+    Utils::log("\n=== Test For Zero Copy Complete ===");
+
+    SocketTuningTest::testWithServer();
+
+    Utils::log("\n=== Test For Socket Tuning Complete ===");
+
+    CoroutineTest::testWithServer();
+
+    Utils::log("\n=== Test For Coroutines Complete ===");
+
+    WorkerPoolTest::testPool();
+    WorkerPoolTest::testWithServer();
+
+    Utils::log("\n=== Test For Worker Pool Complete ===");
+
+    PipelineTest::testWithServer();
+
+    Utils::log("\n=== Test For Pipelined Connections Complete ===");
+
+    UnixSocketTest::testWithoutServer();
+    UnixSocketTest::testWithServer();
+
+    Utils::log("\n=== Test For Unix Domain Sockets Complete ===");
+
+    SharedMemoryTest::testWithServer();
+    SharedMemoryTest::testLargeTransfer();
+
+    Utils::log("\n=== Test For Shared Memory Sockets Complete ===");
     return 0;
 }